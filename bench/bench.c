@@ -0,0 +1,60 @@
+#include "benchHarness.h"
+
+// bench.c
+
+/**
+ * @note usage: bench_nnc [--reps N] [--max-nodes N] [--filter substring] [--json path] [--csv path]
+ * @dev --max-nodes bounds the synthetic graph sizes of the Backward benchmarks (default 10^5, up to 10^7). Larger 
+ * graphs are slow to sort since the visited HashTable has a fixed number of buckets.
+ * @dev --json/--csv additionally write the results in machine readable form for tools/benchCompare.c
+*/
+int main(int argc, char** argv){
+
+    BenchConfig config;
+    config.reps = 11;
+    config.maxNodes = 100000;
+    config.filter = NULL;
+
+    const char* jsonPath = NULL;
+    const char* csvPath = NULL;
+
+    for (int i=1; i<argc; i++){
+
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc){
+            config.reps = atoi(argv[++i]);
+        }else if (strcmp(argv[i], "--max-nodes") == 0 && i + 1 < argc){
+            config.maxNodes = atoll(argv[++i]);
+        }else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc){
+            config.filter = argv[++i];
+        }else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc){
+            jsonPath = argv[++i];
+        }else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc){
+            csvPath = argv[++i];
+        }else{
+            printf("usage: %s [--reps N] [--max-nodes N] [--filter substring] [--json path] [--csv path]\n", argv[0]);
+            return 1;
+        }
+    }
+    assert(config.reps > 0);
+
+    printBenchHeader();
+
+    benchAutoGrad(&config);
+    benchHashTable(&config);
+    benchBackward(&config);
+    benchForward(&config);
+    benchCsv(&config);
+    benchDataset(&config);
+    benchModelFile(&config);
+    benchInference(&config);
+    benchBatchQueue(&config);
+
+    if (jsonPath != NULL){
+        writeBenchResults(jsonPath, BENCH_FORMAT_JSON);
+    }
+    if (csvPath != NULL){
+        writeBenchResults(csvPath, BENCH_FORMAT_CSV);
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "benchHarness.h"
+
+// benchAutoGrad.c
+
+#define NODES_PER_REP 100000
+
+// ---------------------------------------------------------------------------------------------------------------------- Value Allocation
+
+/**
+ * @bench newValue()/freeValue() round trip for leaf Values
+*/
+long long bench_newFreeValue(void* ctx){
+    (void)ctx;
+
+    Value** values = malloc(sizeof(Value*) * NODES_PER_REP);
+    assert(values != NULL);
+
+    long long start = benchNow();
+
+    for (int i=0; i<NODES_PER_REP; i++){
+        values[i] = newValue(i, NULL, NO_ANCESTORS, "bench");
+    }
+    for (int i=0; i<NODES_PER_REP; i++){
+        freeValue(&values[i]);
+    }
+
+    long long elapsed = benchNow() - start;
+
+    free(values);
+    return elapsed;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Node Creation
+
+/**
+ * @note OpBenchCtx selects the operation benchmarked by bench_nodeCreation()
+*/
+typedef struct {
+    int op;
+} OpBenchCtx;
+
+#define OP_ADD 0
+#define OP_MUL 1
+#define OP_RELU 2
+
+/**
+ * @bench node creation rate of Add()/Mul()/ReLU(), including the push to the graph stack
+*/
+long long bench_nodeCreation(void* ctx){
+
+    OpBenchCtx* opCtx = (OpBenchCtx*)ctx;
+
+    GraphStack* graphStack = newGraphStack();
+    Value* a = newValue(1.5, NULL, NO_ANCESTORS, "a");
+    Value* b = newValue(-0.5, NULL, NO_ANCESTORS, "b");
+
+    long long start = benchNow();
+
+    for (int i=0; i<NODES_PER_REP; i++){
+
+        if (opCtx->op == OP_ADD){
+            Add(a, b, graphStack);
+        }else if (opCtx->op == OP_MUL){
+            Mul(a, b, graphStack);
+        }else{
+            ReLU(a, graphStack);
+        }
+    }
+
+    long long elapsed = benchNow() - start;
+
+    releaseGraph(graphStack);
+    graphPreservingStackRelease(&graphStack);
+    freeValue(&a);
+    freeValue(&b);
+
+    return elapsed;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- GraphStack
+
+/**
+ * @bench pushGraphStack() of existing Values
+*/
+long long bench_pushGraphStack(void* ctx){
+    (void)ctx;
+
+    Value* a = newValue(1, NULL, NO_ANCESTORS, "a");
+    GraphStack* graphStack = newGraphStack();
+
+    long long start = benchNow();
+
+    for (int i=0; i<NODES_PER_REP; i++){
+        pushGraphStack(graphStack, a);
+    }
+
+    long long elapsed = benchNow() - start;
+
+    graphPreservingStackRelease(&graphStack);
+    freeValue(&a);
+
+    return elapsed;
+}
+
+/**
+ * @bench releaseGraph() of a graph of Add() nodes
+*/
+long long bench_releaseGraph(void* ctx){
+    (void)ctx;
+
+    GraphStack* graphStack = newGraphStack();
+    Value* a = newValue(1, NULL, NO_ANCESTORS, "a");
+
+    for (int i=0; i<NODES_PER_REP; i++){
+        Add(a, a, graphStack);
+    }
+
+    long long start = benchNow();
+    releaseGraph(graphStack);
+    long long elapsed = benchNow() - start;
+
+    graphPreservingStackRelease(&graphStack);
+    freeValue(&a);
+
+    return elapsed;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Suite
+
+/**
+ * @note benchAutoGrad() runs the Value allocation, node creation and GraphStack benchmarks
+*/
+void benchAutoGrad(BenchConfig* config){
+
+    runBench(config, "newValue/freeValue", bench_newFreeValue, NULL, NODES_PER_REP);
+
+    OpBenchCtx add = {OP_ADD}, mul = {OP_MUL}, relu = {OP_RELU};
+    runBench(config, "Add node creation", bench_nodeCreation, &add, NODES_PER_REP);
+    runBench(config, "Mul node creation", bench_nodeCreation, &mul, NODES_PER_REP);
+    runBench(config, "ReLU node creation", bench_nodeCreation, &relu, NODES_PER_REP);
+
+    runBench(config, "pushGraphStack", bench_pushGraphStack, NULL, NODES_PER_REP);
+    runBench(config, "releaseGraph", bench_releaseGraph, NULL, NODES_PER_REP);
+}
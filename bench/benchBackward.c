@@ -0,0 +1,113 @@
+#include "benchHarness.h"
+
+// benchBackward.c
+
+/**
+ * @note buildSyntheticGraph() builds a graph of about numNodes nodes by reducing numNodes/2 leaves pairwise with 
+ * alternating Add() and Mul() until a single output remains
+ * @dev a balanced reduction keeps the graph depth at log2(numNodes), so the recursive depth first search in 
+ * reverseTopologicalSort() stays shallow even for very large graphs
+ * @param numNodes approximate number of nodes in the graph
+ * @param graphStack the graph stack all nodes (including leaves) are pushed to
+ * @return the output Value of the graph
+*/
+Value* buildSyntheticGraph(long long numNodes, GraphStack* graphStack){
+
+    long long width = numNodes / 2 > 1 ? numNodes / 2 : 2;
+
+    Value** level = malloc(sizeof(Value*) * width);
+    assert(level != NULL);
+
+    for (long long i=0; i<width; i++){
+        level[i] = newValue(1.0, NULL, NO_ANCESTORS, "leaf");
+        pushGraphStack(graphStack, level[i]);
+    }
+
+    // reduce pairwise, carrying an odd element over to the next level
+    while (width > 1){
+
+        long long next = 0;
+        for (long long i=0; i + 1 < width; i += 2){
+            level[next] = (next % 2 == 0) ? Add(level[i], level[i + 1], graphStack) : Mul(level[i], level[i + 1], graphStack);
+            next++;
+        }
+        if (width % 2 == 1){
+            level[next++] = level[width - 1];
+        }
+
+        width = next;
+    }
+
+    Value* output = level[0];
+    free(level);
+
+    return output;
+}
+
+/**
+ * @note GraphBenchCtx holds the size of the synthetic graph benchmarked
+*/
+typedef struct {
+    long long numNodes;
+} GraphBenchCtx;
+
+/**
+ * @bench reverseTopologicalSort() of a synthetic graph
+*/
+long long bench_reverseTopologicalSort(void* ctx){
+
+    GraphBenchCtx* graphCtx = (GraphBenchCtx*)ctx;
+
+    GraphStack* graphStack = newGraphStack();
+    Value* output = buildSyntheticGraph(graphCtx->numNodes, graphStack);
+    GraphStack* sortStack = newGraphStack();
+
+    long long start = benchNow();
+    reverseTopologicalSort(output, &sortStack);
+    long long elapsed = benchNow() - start;
+
+    graphPreservingStackRelease(&sortStack);
+    releaseGraph(graphStack);
+    graphPreservingStackRelease(&graphStack);
+
+    return elapsed;
+}
+
+/**
+ * @bench Backward() (sort and gradient sweep) of a synthetic graph
+*/
+long long bench_Backward(void* ctx){
+
+    GraphBenchCtx* graphCtx = (GraphBenchCtx*)ctx;
+
+    GraphStack* graphStack = newGraphStack();
+    Value* output = buildSyntheticGraph(graphCtx->numNodes, graphStack);
+
+    long long start = benchNow();
+    Backward(output, NULL, NULL);
+    long long elapsed = benchNow() - start;
+
+    releaseGraph(graphStack);
+    graphPreservingStackRelease(&graphStack);
+
+    return elapsed;
+}
+
+/**
+ * @note benchBackward() runs the sort and Backward() benchmarks on graphs of 10^3 nodes up to config->maxNodes
+ * @dev timings are per graph node
+*/
+void benchBackward(BenchConfig* config){
+
+    for (long long numNodes = 1000; numNodes <= config->maxNodes; numNodes *= 10){
+
+        GraphBenchCtx ctx = {numNodes};
+        char name[96];
+
+        snprintf(name, sizeof(name), "reverseTopologicalSort n=%lld", numNodes);
+        runBench(config, name, bench_reverseTopologicalSort, &ctx, numNodes);
+
+        snprintf(name, sizeof(name), "Backward n=%lld", numNodes);
+        runBench(config, name, bench_Backward, &ctx, numNodes);
+    }
+}
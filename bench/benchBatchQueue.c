@@ -0,0 +1,130 @@
+#include "benchHarness.h"
+
+// benchBatchQueue.c
+
+#define QUEUE_BENCH_CLIENTS 32
+#define QUEUE_BENCH_REQUESTS 200
+#define QUEUE_BENCH_FEATURES 32
+
+/**
+ * @note QueueBenchCtx is a load generator: closed loop clients each submitting QUEUE_BENCH_REQUESTS rows one at a 
+ * time to a BatchQueue, and the latency of every request of the last repetition
+*/
+typedef struct {
+    BatchQueue* queue;
+    float* features;
+    double* latencies;
+    pthread_barrier_t barrier;
+} QueueBenchCtx;
+
+/**
+ * @note QueueBenchClient is the argument of one load generator thread
+*/
+typedef struct {
+    QueueBenchCtx* ctx;
+    int client;
+} QueueBenchClient;
+
+/**
+ * @note queueBenchClient() waits for every client to be started, then submits its rows and times each request
+*/
+void* queueBenchClient(void* arg){
+
+    QueueBenchClient* client = (QueueBenchClient*)arg;
+    QueueBenchCtx* ctx = client->ctx;
+
+    pthread_barrier_wait(&ctx->barrier);
+
+    for (int i=0; i<QUEUE_BENCH_REQUESTS; i++){
+
+        int request = client->client * QUEUE_BENCH_REQUESTS + i;
+
+        long long start = benchNow();
+        predictQueued(ctx->queue, ctx->features + (size_t)request * QUEUE_BENCH_FEATURES, NULL);
+        ctx->latencies[request] = (double)(benchNow() - start);
+    }
+
+    return NULL;
+}
+
+/**
+ * @bench QUEUE_BENCH_CLIENTS x QUEUE_BENCH_REQUESTS requests through a BatchQueue, reported per request
+*/
+long long bench_batchQueue(void* ctx){
+
+    QueueBenchCtx* queueCtx = (QueueBenchCtx*)ctx;
+
+    pthread_t threads[QUEUE_BENCH_CLIENTS];
+    QueueBenchClient clients[QUEUE_BENCH_CLIENTS];
+
+    for (int c=0; c<QUEUE_BENCH_CLIENTS; c++){
+
+        clients[c].ctx = queueCtx;
+        clients[c].client = c;
+        int status = pthread_create(&threads[c], NULL, queueBenchClient, &clients[c]);
+        assert(status == 0);
+    }
+
+    pthread_barrier_wait(&queueCtx->barrier);
+    long long start = benchNow();
+
+    for (int c=0; c<QUEUE_BENCH_CLIENTS; c++){
+        pthread_join(threads[c], NULL);
+    }
+
+    return benchNow() - start;
+}
+
+/**
+ * @note benchBatchQueue() drives a BatchQueue over a 32-64-10 mlp with a closed loop load generator for several batch
+ * size and wait settings. For each it reports the throughput per request and the latency distribution of the requests 
+ * of one repetition, ie: the throughput vs p99 latency trade off of the knobs.
+*/
+void benchBatchQueue(BenchConfig* config){
+
+    int layerSizes[] = {64, 10};
+    MLP* mlp = newMLP(QUEUE_BENCH_FEATURES, layerSizes, 2);
+    InferenceModel* model = newInferenceModel(mlp);
+    InferencePool* pool = newInferencePool(0);
+
+    Rng rng;
+    seedRng(&rng, 23);
+
+    int numRequests = QUEUE_BENCH_CLIENTS * QUEUE_BENCH_REQUESTS;
+
+    QueueBenchCtx ctx;
+    ctx.features = malloc(sizeof(float) * numRequests * QUEUE_BENCH_FEATURES);
+    ctx.latencies = malloc(sizeof(double) * numRequests);
+    assert(ctx.features != NULL && ctx.latencies != NULL);
+    pthread_barrier_init(&ctx.barrier, NULL, QUEUE_BENCH_CLIENTS + 1);
+
+    for (int i=0; i<numRequests * QUEUE_BENCH_FEATURES; i++){
+        ctx.features[i] = (float)rngNormal(&rng);
+    }
+
+    // batch size 1 is a dispatcher running one forward pass per request
+    int maxBatchRows[3] = {1, 16, 64};
+    long long maxWaitNs[3] = {0, 50000, 200000};
+
+    for (int k=0; k<3; k++){
+
+        char name[96], latencyName[96];
+        snprintf(name, sizeof(name), "batchQueue batch %d wait %lldus requests", maxBatchRows[k], maxWaitNs[k] / 1000);
+        snprintf(latencyName, sizeof(latencyName), "batchQueue batch %d wait %lldus latency", maxBatchRows[k], maxWaitNs[k] / 1000);
+
+        ctx.queue = newBatchQueue(pool, model, maxBatchRows[k], maxWaitNs[k]);
+
+        if (runBench(config, name, bench_batchQueue, &ctx, numRequests)){
+            recordBenchSamples(latencyName, ctx.latencies, numRequests, 1);
+        }
+
+        freeBatchQueue(&ctx.queue);
+    }
+
+    pthread_barrier_destroy(&ctx.barrier);
+    free(ctx.features);
+    free(ctx.latencies);
+    freeInferencePool(&pool);
+    freeInferenceModel(&model);
+    freeMLP(&mlp);
+}
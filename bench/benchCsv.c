@@ -0,0 +1,85 @@
+#include "benchHarness.h"
+#include <unistd.h>
+
+// benchCsv.c
+
+#define CSV_BENCH_PATH "/tmp/nnc_bench.csv"
+
+/**
+ * @note CsvBenchCtx holds the generated CSV file loaded by the CSV benchmarks
+*/
+typedef struct {
+    const char* path;
+    int numThreads;
+} CsvBenchCtx;
+
+/**
+ * @bench loadCsvDatasetThreads() of the whole generated file, reported per byte so ops/sec is bytes/sec
+*/
+long long bench_loadCsv(void* ctx){
+
+    CsvBenchCtx* csvCtx = (CsvBenchCtx*)ctx;
+
+    long long start = benchNow();
+    DenseDataset* dataset = loadCsvDatasetThreads(csvCtx->path, NULL, csvCtx->numThreads);
+    long long elapsed = benchNow() - start;
+
+    assert(dataset != NULL);
+    freeDenseDataset(&dataset);
+    return elapsed;
+}
+
+/**
+ * @bench nextCsvBatch() of the whole generated file on a single thread
+*/
+long long bench_streamCsv(void* ctx){
+
+    CsvBenchCtx* csvCtx = (CsvBenchCtx*)ctx;
+    float features[256 * 16];
+    int32_t labels[256];
+
+    long long start = benchNow();
+
+    CsvStream* stream = openCsvStream(csvCtx->path, NULL);
+    while (nextCsvBatch(stream, features, labels, 256) > 0);
+    closeCsvStream(&stream);
+
+    return benchNow() - start;
+}
+
+/**
+ * @note benchCsv() writes a 200000 x 16 CSV file and measures streaming and multithreaded parsing of it
+*/
+void benchCsv(BenchConfig* config){
+
+    // 16 features with 6 significant digits, string labels
+    FILE* file = fopen(CSV_BENCH_PATH, "w");
+    assert(file != NULL);
+
+    Rng rng;
+    seedRng(&rng, 7);
+    for (int row=0; row<200000; row++){
+        for (int feature=0; feature<16; feature++){
+            fprintf(file, "%.6g,", rngNormal(&rng) * 10);
+        }
+        fprintf(file, "class%d\n", row % 10);
+    }
+
+    long long numBytes = ftello(file);
+    fclose(file);
+
+    CsvBenchCtx ctx;
+    ctx.path = CSV_BENCH_PATH;
+
+    runBench(config, "nextCsvBatch bytes", bench_streamCsv, &ctx, numBytes);
+
+    int numCpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    for (ctx.numThreads = 1; ctx.numThreads <= numCpus; ctx.numThreads *= 2){
+
+        char name[96];
+        snprintf(name, sizeof(name), "loadCsvDatasetThreads t=%d bytes", ctx.numThreads);
+        runBench(config, name, bench_loadCsv, &ctx, numBytes);
+    }
+
+    remove(CSV_BENCH_PATH);
+}
@@ -0,0 +1,110 @@
+#include "benchHarness.h"
+
+// benchDataset.c
+
+#define DATASET_BENCH_PATH "/tmp/nnc_bench_dataset.bin"
+#define DATASET_BENCH_ROWS 100000
+#define DATASET_BENCH_FEATURES 64
+#define DATASET_BENCH_BATCH 256
+
+/**
+ * @note DatasetBenchCtx holds a mapped dataset, a random row order and the batch buffers gathered into
+*/
+typedef struct {
+    DenseDataset* dataset;
+    uint64_t* order;
+    float* features;
+    int32_t* labels;
+} DatasetBenchCtx;
+
+/**
+ * @bench gatherBatch() of one epoch in random order, reported per row
+*/
+long long bench_gatherEpoch(void* ctx){
+
+    DatasetBenchCtx* datasetCtx = (DatasetBenchCtx*)ctx;
+
+    long long start = benchNow();
+
+    for (uint64_t row=0; row<DATASET_BENCH_ROWS; row+=DATASET_BENCH_BATCH){
+
+        int batchSize = DATASET_BENCH_ROWS - row < DATASET_BENCH_BATCH ? (int)(DATASET_BENCH_ROWS - row) : DATASET_BENCH_BATCH;
+        gatherBatch(datasetCtx->dataset, datasetCtx->order + row, batchSize, datasetCtx->features, datasetCtx->labels);
+    }
+
+    return benchNow() - start;
+}
+
+/**
+ * @note benchDataset() writes the same 100000 x 64 dataset as float32, uint8 and int16 and measures gathering shuffled
+ * batches out of each mapping, ie: the loader's per epoch cost with the dequantization kernel
+*/
+void benchDataset(BenchConfig* config){
+
+    Rng rng;
+    seedRng(&rng, 11);
+
+    float* features = malloc(sizeof(float) * DATASET_BENCH_ROWS * DATASET_BENCH_FEATURES);
+    int32_t* labels = malloc(sizeof(int32_t) * DATASET_BENCH_ROWS);
+    uint64_t* order = malloc(sizeof(uint64_t) * DATASET_BENCH_ROWS);
+    assert(features != NULL && labels != NULL && order != NULL);
+
+    for (int i=0; i<DATASET_BENCH_ROWS * DATASET_BENCH_FEATURES; i++){
+        features[i] = (float)rngNormal(&rng);
+    }
+    for (uint64_t row=0; row<DATASET_BENCH_ROWS; row++){
+        labels[row] = row % 10;
+        order[row] = row;
+    }
+    for (uint64_t i=DATASET_BENCH_ROWS; i-- > 1; ){
+
+        uint64_t j = rngBelow(&rng, i + 1);
+        uint64_t temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
+
+    float scale[DATASET_BENCH_FEATURES], offset[DATASET_BENCH_FEATURES];
+
+    DatasetBenchCtx ctx;
+    ctx.order = order;
+    ctx.features = malloc(sizeof(float) * DATASET_BENCH_BATCH * DATASET_BENCH_FEATURES);
+    ctx.labels = malloc(sizeof(int32_t) * DATASET_BENCH_BATCH);
+    assert(ctx.features != NULL && ctx.labels != NULL);
+
+    int dtypes[3] = {DTYPE_FLOAT32, DTYPE_UINT8, DTYPE_INT16};
+    const char* names[3] = {"gatherBatch f32 64 rows", "gatherBatch u8 64 rows", "gatherBatch i16 64 rows"};
+
+    for (int d=0; d<3; d++){
+
+        if (dtypes[d] != DTYPE_FLOAT32){
+            computeQuantParams(features, DATASET_BENCH_ROWS, DATASET_BENCH_FEATURES, dtypes[d], scale, offset);
+        }
+
+        DatasetWriter* writer = newQuantizedDatasetWriter(
+            DATASET_BENCH_PATH,
+            DATASET_BENCH_ROWS,
+            DATASET_BENCH_FEATURES,
+            10,
+            dtypes[d],
+            dtypes[d] != DTYPE_FLOAT32 ? scale : NULL,
+            dtypes[d] != DTYPE_FLOAT32 ? offset : NULL
+        );
+        writeDatasetRows(writer, features, labels, DATASET_BENCH_ROWS);
+        closeDatasetWriter(&writer);
+
+        ctx.dataset = openDenseDataset(DATASET_BENCH_PATH);
+        assert(ctx.dataset != NULL);
+
+        runBench(config, names[d], bench_gatherEpoch, &ctx, DATASET_BENCH_ROWS);
+
+        freeDenseDataset(&ctx.dataset);
+    }
+
+    remove(DATASET_BENCH_PATH);
+    free(features);
+    free(labels);
+    free(order);
+    free(ctx.features);
+    free(ctx.labels);
+}
@@ -0,0 +1,270 @@
+#include "benchHarness.h"
+#include "loadData.h"
+
+// benchForward.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Layer Forward
+
+/**
+ * @note LayerBenchCtx holds the layer and input vector benchmarked by bench_ForwardLayer()
+*/
+typedef struct {
+    Layer* layer;
+    Value** input;
+} LayerBenchCtx;
+
+/**
+ * @bench ForwardLayer() for a single layer shape, the graph is released outside of the timed region
+*/
+long long bench_ForwardLayer(void* ctx){
+
+    LayerBenchCtx* layerCtx = (LayerBenchCtx*)ctx;
+    GraphStack* graphStack = newGraphStack();
+
+    long long start = benchNow();
+    Value** output = ForwardLayer(layerCtx->layer, layerCtx->input, graphStack);
+    long long elapsed = benchNow() - start;
+
+    free(output);
+    releaseGraph(graphStack);
+    graphPreservingStackRelease(&graphStack);
+
+    return elapsed;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Sparse Input
+
+/**
+ * @note SparseBenchCtx holds the mlp and a batch of sparse rows benchmarked by bench_sparseTrainStep()
+*/
+typedef struct {
+    MLP* mlp;
+    SparseBatch* batch;
+    float* dense;
+    int sparsePath;
+} SparseBenchCtx;
+
+/**
+ * @bench forward, backward, step and zero grad on each row of a sparse batch, through either the sparse first layer 
+ * or the dense ForwardRow() path
+*/
+long long bench_sparseTrainStep(void* ctx){
+
+    SparseBenchCtx* sparseCtx = (SparseBenchCtx*)ctx;
+    MLP* mlp = sparseCtx->mlp;
+    SparseBatch* batch = sparseCtx->batch;
+    int outputSize = mlp->outputLayer->outputSize;
+
+    long long start = benchNow();
+
+    for (int row=0; row<batch->numRows; row++){
+
+        const int32_t* cols = batch->colIdx + batch->rowPtr[row];
+        int nnz = rowNonzeros(batch, row);
+
+        Value** output = sparseCtx->sparsePath ? 
+            ForwardSparseRow(mlp, batch, row) : 
+            ForwardRow(mlp, sparseCtx->dense + (size_t)row * batch->numCols);
+
+        double* softmax = Softmax(output, outputSize);
+        Value* loss = sparseCategoricalCrossEntropy(output, 0, softmax, outputSize, mlp->graphStack);
+        BackwardSparse(loss, softmax, 0);
+
+        if (sparseCtx->sparsePath){
+            StepSparse(mlp, 0.001, cols, nnz);
+            ZeroGradSparse(mlp, cols, nnz);
+        }else{
+            Step(mlp, 0.001);
+            ZeroGrad(mlp);
+        }
+    }
+
+    return benchNow() - start;
+}
+
+/**
+ * @note benchSparse() compares the sparse and dense first layer on 256 dimensional rows with 1% nonzeros
+*/
+void benchSparse(BenchConfig* config){
+
+    int inputSize = 256, numRows = 4, nnzPerRow = 3;
+    int layerSizes[] = {32, 10};
+
+    SparseBenchCtx ctx;
+    ctx.mlp = newMLP(inputSize, layerSizes, 2);
+    ctx.dense = calloc((size_t)numRows * inputSize, sizeof(float));
+    assert(ctx.dense != NULL);
+
+    Rng rng;
+    seedRng(&rng, 11);
+    for (int i=0; i<numRows * nnzPerRow; i++){
+        ctx.dense[(size_t)(i / nnzPerRow) * inputSize + rngBelow(&rng, inputSize)] = (float)rngNormal(&rng);
+    }
+
+    ctx.batch = newSparseBatch(numRows, inputSize, numRows * nnzPerRow);
+    denseToSparse(ctx.batch, ctx.dense, numRows);
+
+    ctx.sparsePath = 1;
+    runBench(config, "train step sparse 256x32 1% nnz", bench_sparseTrainStep, &ctx, numRows);
+    ctx.sparsePath = 0;
+    runBench(config, "train step dense 256x32 1% nnz", bench_sparseTrainStep, &ctx, numRows);
+
+    freeSparseBatch(&ctx.batch);
+    free(ctx.dense);
+    freeMLP(&ctx.mlp);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Iris Epoch
+
+/**
+ * @note EpochBenchCtx holds the mlp and dataset of the Iris epoch benchmark
+*/
+typedef struct {
+    MLP* mlp;
+    DenseDataset* dataset;
+} EpochBenchCtx;
+
+/**
+ * @bench one training epoch over the Iris dataset, mirroring example/nnExample.c
+*/
+long long bench_irisEpoch(void* ctx){
+
+    EpochBenchCtx* epochCtx = (EpochBenchCtx*)ctx;
+    MLP* mlp = epochCtx->mlp;
+    int outputSize = mlp->outputLayer->outputSize;
+
+    long long start = benchNow();
+
+    for (int example=0; example<NUM_EXAMPLES; example++){
+
+        int label = epochCtx->dataset->labels[example];
+
+        Value** output = ForwardRow(mlp, getFeatureRow(epochCtx->dataset, example));
+        double* softmax = Softmax(output, outputSize);
+        Value* loss = sparseCategoricalCrossEntropy(output, label, softmax, outputSize, mlp->graphStack);
+
+        BackwardSparse(loss, softmax, label);
+        Step(mlp, 0.001);
+        ZeroGrad(mlp);
+    }
+
+    return benchNow() - start;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Weight Init
+
+#define INIT_BENCH_VALUES (1 << 24)
+
+/**
+ * @note InitBenchCtx holds the array filled by bench_initWeights() and the threads filling it
+*/
+typedef struct {
+    double* values;
+    int scheme;
+    int numThreads;
+} InitBenchCtx;
+
+/**
+ * @bench initWeights() of INIT_BENCH_VALUES values, reported per value
+*/
+long long bench_initWeights(void* ctx){
+
+    InitBenchCtx* initCtx = (InitBenchCtx*)ctx;
+
+    long long start = benchNow();
+    initWeights(initCtx->values, INIT_BENCH_VALUES, initCtx->scheme, 1024, 1024, 1, 0, initCtx->numThreads);
+    return benchNow() - start;
+}
+
+/**
+ * @bench the rand() per value that newLayer() used to initialize with, reported per value
+*/
+long long bench_randInit(void* ctx){
+
+    InitBenchCtx* initCtx = (InitBenchCtx*)ctx;
+
+    long long start = benchNow();
+    for (int i=0; i<INIT_BENCH_VALUES; i++){
+        initCtx->values[i] = (double)rand() / (RAND_MAX + 1u) * 2.0f - 1.0f;
+    }
+    return benchNow() - start;
+}
+
+/**
+ * @note benchInit() measures initWeights() on one thread and on every core against the rand() per value it replaced
+*/
+void benchInit(BenchConfig* config){
+
+    InitBenchCtx ctx;
+    ctx.values = (double*)malloc(sizeof(double) * INIT_BENCH_VALUES);
+    assert(ctx.values != NULL);
+
+    runBench(config, "rand() init (per value)", bench_randInit, &ctx, INIT_BENCH_VALUES);
+
+    const char* schemeNames[] = {"uniform", "Xavier", "He"};
+    int schemes[] = {INIT_UNIFORM, INIT_XAVIER, INIT_HE};
+
+    for (int i=0; i<3; i++){
+
+        char name[96];
+        ctx.scheme = schemes[i];
+
+        ctx.numThreads = 1;
+        snprintf(name, sizeof(name), "initWeights %s 1 thread (per value)", schemeNames[i]);
+        runBench(config, name, bench_initWeights, &ctx, INIT_BENCH_VALUES);
+
+        ctx.numThreads = INIT_AUTO_THREADS;
+        snprintf(name, sizeof(name), "initWeights %s all cores (per value)", schemeNames[i]);
+        runBench(config, name, bench_initWeights, &ctx, INIT_BENCH_VALUES);
+    }
+
+    free(ctx.values);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Suite
+
+/**
+ * @note benchForward() runs ForwardLayer() for a few layer shapes, the sparse input comparison, weight initialization 
+ * and a full Iris training epoch
+*/
+void benchForward(BenchConfig* config){
+
+    int shapes[][2] = {{4, 16}, {64, 64}, {256, 256}, {784, 128}};
+    int numShapes = sizeof(shapes) / sizeof(shapes[0]);
+
+    for (int i=0; i<numShapes; i++){
+
+        LayerBenchCtx ctx;
+        ctx.layer = newLayer(shapes[i][0], shapes[i][1]);
+        ctx.input = newOutputVector(shapes[i][0]);
+
+        char name[96];
+        snprintf(name, sizeof(name), "ForwardLayer %dx%d", shapes[i][0], shapes[i][1]);
+        runBench(config, name, bench_ForwardLayer, &ctx, 1);
+
+        for (int j=0; j<shapes[i][0]; j++){
+            freeValue(&ctx.input[j]);
+        }
+        free(ctx.input);
+        freeLayer(&ctx.layer);
+    }
+
+    benchSparse(config);
+    benchInit(config);
+
+    // skip loading the dataset when the epoch benchmark is filtered out
+    const char* epochName = "Iris epoch (per example)";
+    if (config->filter != NULL && strstr(epochName, config->filter) == NULL){
+        return;
+    }
+
+    int layerSizes[] = {16, 8, 4, NUM_CLASSES};
+    EpochBenchCtx ctx;
+    ctx.dataset = loadData();
+    ctx.mlp = newMLP(NUM_FEATURES, layerSizes, 4);
+
+    runBench(config, epochName, bench_irisEpoch, &ctx, NUM_EXAMPLES);
+
+    freeMLP(&ctx.mlp);
+    freeDenseDataset(&ctx.dataset);
+}
@@ -0,0 +1,218 @@
+#include "benchHarness.h"
+
+// benchHarness.c
+
+// build metadata, passed in by the Makefile
+#ifndef NNC_GIT_COMMIT
+#define NNC_GIT_COMMIT "unknown"
+#endif
+#ifndef NNC_BENCH_CFLAGS
+#define NNC_BENCH_CFLAGS "unknown"
+#endif
+
+// results of every benchmark run so far, written out by writeBenchResults()
+BenchResult benchResults[MAX_BENCH_RESULTS];
+int numBenchResults = 0;
+
+// ---------------------------------------------------------------------------------------------------------------------- Timing
+
+/**
+ * @note benchNow() returns the monotonic clock in nanoseconds
+*/
+long long benchNow(void){
+    return profileNow();
+}
+
+/**
+ * @note compareDoubles() is the qsort comparator for ascending doubles
+*/
+int compareDoubles(const void* a, const void* b){
+
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @note percentile() returns the nearest rank percentile of an ascending sorted array
+ * @param sorted ascending array of samples
+ * @param len length of the array
+ * @param p percentile in [0, 100]
+*/
+double percentile(double* sorted, int len, double p){
+
+    int rank = (int)ceil(p / 100.0 * len);
+    if (rank < 1){
+        rank = 1;
+    }
+
+    return sorted[rank - 1];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Runner
+
+/**
+ * @note printBenchHeader() prints the column header for the rows printed by runBench()
+*/
+void printBenchHeader(void){
+    printf("%-44s %6s %12s %12s %12s %12s\n", "benchmark", "reps", "median ns/op", "p90 ns/op", "p99 ns/op", "ops/sec");
+}
+
+/**
+ * @note recordBenchSamples() prints and records the median and tail percentiles of a set of timings per operation
+ * @dev runBench() records one sample per repetition. Benchmarks that time every operation themselves, such as the 
+ * request latencies of a load generator, record their samples directly.
+ * @param name name of the result
+ * @param samples the timings in ns per operation, sorted in place
+ * @param len number of samples, recorded as the reps of the result
+ * @param opsPerRep number of operations each sample was normalized by
+*/
+void recordBenchSamples(const char* name, double* samples, int len, long long opsPerRep){
+    assert(name != NULL && samples != NULL && len > 0);
+
+    qsort(samples, len, sizeof(double), compareDoubles);
+
+    BenchResult result;
+    snprintf(result.name, sizeof(result.name), "%s", name);
+    result.reps = len;
+    result.opsPerRep = opsPerRep;
+    result.median = percentile(samples, len, 50);
+    result.p90 = percentile(samples, len, 90);
+    result.p99 = percentile(samples, len, 99);
+    result.min = samples[0];
+    result.max = samples[len - 1];
+
+    printf("%-44s %6d %12.1lf %12.1lf %12.1lf %12.0lf\n", 
+        result.name, result.reps, result.median, result.p90, result.p99, 
+        result.median > 0 ? 1e9 / result.median : 0);
+    fflush(stdout);
+
+    assert(numBenchResults < MAX_BENCH_RESULTS);
+    benchResults[numBenchResults++] = result;
+}
+
+/**
+ * @note runBench() runs a benchmark body config->reps times (after one warmup repetition) and prints the median and 
+ * tail percentiles of the time per operation
+ * @param config shared benchmark options
+ * @param name name of the benchmark, skipped if it does not match config->filter
+ * @param func the benchmark body
+ * @param ctx passed through to func
+ * @param opsPerRep number of operations performed by one repetition, used to normalize timings per operation
+ * @return 1 if the benchmark ran, 0 if it was filtered out
+*/
+int runBench(BenchConfig* config, const char* name, pBenchFunc func, void* ctx, long long opsPerRep){
+    assert(config != NULL && name != NULL && func != NULL);
+    assert(opsPerRep > 0);
+
+    if (config->filter != NULL && strstr(name, config->filter) == NULL){
+        return 0;
+    }
+
+    double* samples = malloc(sizeof(double) * config->reps);
+    assert(samples != NULL);
+
+    // warmup
+    func(ctx);
+
+    for (int rep=0; rep<config->reps; rep++){
+        samples[rep] = (double)func(ctx) / opsPerRep;
+    }
+
+    recordBenchSamples(name, samples, config->reps, opsPerRep);
+
+    free(samples);
+
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Result Output
+
+/**
+ * @note readCpuModel() reads the cpu model name from /proc/cpuinfo, or "unknown" where it is not available
+ * @param cpuModel buffer to write the model name to
+ * @param len length of the buffer
+*/
+void readCpuModel(char* cpuModel, int len){
+
+    snprintf(cpuModel, len, "unknown");
+
+    FILE* file = fopen("/proc/cpuinfo", "r");
+    if (file == NULL){
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL){
+
+        if (strncmp(line, "model name", 10) == 0){
+
+            char* model = strchr(line, ':');
+            if (model != NULL){
+
+                // skip ": " and drop the newline
+                model += 2;
+                model[strcspn(model, "\n")] = '\0';
+                snprintf(cpuModel, len, "%s", model);
+            }
+            break;
+        }
+    }
+
+    fclose(file);
+}
+
+/**
+ * @note writeBenchResults() writes every result recorded by runBench() to a file as JSON or CSV, tagged with the git 
+ * commit, compiler flags, compiler version and cpu model of the run
+ * @dev JSON is written with one result object per line and CSV with the metadata as leading "# key: value" comment 
+ * lines, the format read back by tools/benchCompare.c
+ * @param path the file to write
+ * @param format BENCH_FORMAT_JSON or BENCH_FORMAT_CSV
+*/
+void writeBenchResults(const char* path, int format){
+
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+
+    char cpuModel[128];
+    readCpuModel(cpuModel, sizeof(cpuModel));
+
+    if (format == BENCH_FORMAT_JSON){
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"git_commit\": \"%s\",\n", NNC_GIT_COMMIT);
+        fprintf(file, "  \"cflags\": \"%s\",\n", NNC_BENCH_CFLAGS);
+        fprintf(file, "  \"compiler\": \"%s\",\n", __VERSION__);
+        fprintf(file, "  \"cpu\": \"%s\",\n", cpuModel);
+        fprintf(file, "  \"results\": [\n");
+
+        for (int i=0; i<numBenchResults; i++){
+
+            BenchResult* r = &benchResults[i];
+            fprintf(file, 
+                "    {\"name\": \"%s\", \"reps\": %d, \"ops_per_rep\": %lld, \"median_ns\": %.3lf, "
+                "\"p90_ns\": %.3lf, \"p99_ns\": %.3lf, \"min_ns\": %.3lf, \"max_ns\": %.3lf}%s\n",
+                r->name, r->reps, r->opsPerRep, r->median, r->p90, r->p99, r->min, r->max, 
+                i + 1 < numBenchResults ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+
+    }else{
+
+        fprintf(file, "# git_commit: %s\n", NNC_GIT_COMMIT);
+        fprintf(file, "# cflags: %s\n", NNC_BENCH_CFLAGS);
+        fprintf(file, "# compiler: %s\n", __VERSION__);
+        fprintf(file, "# cpu: %s\n", cpuModel);
+        fprintf(file, "name,reps,ops_per_rep,median_ns,p90_ns,p99_ns,min_ns,max_ns\n");
+
+        for (int i=0; i<numBenchResults; i++){
+
+            BenchResult* r = &benchResults[i];
+            fprintf(file, "%s,%d,%lld,%.3lf,%.3lf,%.3lf,%.3lf,%.3lf\n", 
+                r->name, r->reps, r->opsPerRep, r->median, r->p90, r->p99, r->min, r->max);
+        }
+    }
+
+    fclose(file);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "lib.h"
+
+// benchHarness.h
+
+/**
+ * @note pBenchFunc is a benchmark body. It performs one repetition of the benchmark and returns the elapsed time in 
+ * nanoseconds of the part being measured, so setup/teardown that should not be timed can live in the same function.
+ * @param void* the ctx ptr passed to runBench()
+*/
+typedef long long (*pBenchFunc)(void*);
+
+/**
+ * @note BenchConfig holds command line options shared by all benchmark suites
+ * @param reps repetitions per benchmark
+ * @param maxNodes the largest synthetic graph size to benchmark
+ * @param filter only run benchmarks whose name contains this string (NULL for all)
+*/
+typedef struct {
+    int reps;
+    long long maxNodes;
+    const char* filter;
+} BenchConfig;
+
+#define MAX_BENCH_RESULTS 256
+
+#define BENCH_FORMAT_JSON 0
+#define BENCH_FORMAT_CSV 1
+
+/**
+ * @note BenchResult holds the per operation timing statistics of a benchmark in nanoseconds
+*/
+typedef struct {
+    char name[96];
+    int reps;
+    long long opsPerRep;
+    double median;
+    double p90;
+    double p99;
+    double min;
+    double max;
+} BenchResult;
+
+// harness functions
+long long benchNow(void);
+int runBench(BenchConfig* config, const char* name, pBenchFunc func, void* ctx, long long opsPerRep);
+void recordBenchSamples(const char* name, double* samples, int len, long long opsPerRep);
+void printBenchHeader(void);
+void readCpuModel(char* cpuModel, int len);
+void writeBenchResults(const char* path, int format);
+
+// benchmark suites
+void benchAutoGrad(BenchConfig* config);
+void benchHashTable(BenchConfig* config);
+void benchBackward(BenchConfig* config);
+void benchForward(BenchConfig* config);
+void benchCsv(BenchConfig* config);
+void benchDataset(BenchConfig* config);
+void benchModelFile(BenchConfig* config);
+void benchInference(BenchConfig* config);
+void benchBatchQueue(BenchConfig* config);
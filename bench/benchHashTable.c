@@ -0,0 +1,87 @@
+#include "benchHarness.h"
+
+// benchHashTable.c
+
+/**
+ * @note HashBenchCtx holds the Values inserted/looked up by the HashTable benchmarks
+*/
+typedef struct {
+    Value** values;
+    int numValues;
+} HashBenchCtx;
+
+/**
+ * @bench insertHashTable() of distinct Value ptrs into a table of HASHTABLE_SIZE buckets
+*/
+long long bench_insertHashTable(void* ctx){
+
+    HashBenchCtx* hashCtx = (HashBenchCtx*)ctx;
+    HashTable* table = newHashTable(HASHTABLE_SIZE);
+
+    long long start = benchNow();
+
+    for (int i=0; i<hashCtx->numValues; i++){
+        insertHashTable(table, hashCtx->values[i]);
+    }
+
+    long long elapsed = benchNow() - start;
+
+    freeHashTable(&table);
+    return elapsed;
+}
+
+/**
+ * @bench isInHashTable() hits on a table holding every Value
+*/
+long long bench_lookupHashTable(void* ctx){
+
+    HashBenchCtx* hashCtx = (HashBenchCtx*)ctx;
+    HashTable* table = newHashTable(HASHTABLE_SIZE);
+
+    for (int i=0; i<hashCtx->numValues; i++){
+        insertHashTable(table, hashCtx->values[i]);
+    }
+
+    long long start = benchNow();
+
+    int found = 0;
+    for (int i=0; i<hashCtx->numValues; i++){
+        found += isInHashTable(table, hashCtx->values[i]);
+    }
+
+    long long elapsed = benchNow() - start;
+    assert(found == hashCtx->numValues);
+
+    freeHashTable(&table);
+    return elapsed;
+}
+
+/**
+ * @note benchHashTable() runs the insert/lookup benchmarks for 10^3 and 10^4 entries
+*/
+void benchHashTable(BenchConfig* config){
+
+    for (int numValues = 1000; numValues <= 10000 && numValues <= config->maxNodes; numValues *= 10){
+
+        HashBenchCtx ctx;
+        ctx.numValues = numValues;
+        ctx.values = malloc(sizeof(Value*) * numValues);
+        assert(ctx.values != NULL);
+
+        for (int i=0; i<numValues; i++){
+            ctx.values[i] = newValue(i, NULL, NO_ANCESTORS, "key");
+        }
+
+        char name[96];
+        snprintf(name, sizeof(name), "insertHashTable n=%d", numValues);
+        runBench(config, name, bench_insertHashTable, &ctx, numValues);
+
+        snprintf(name, sizeof(name), "isInHashTable n=%d", numValues);
+        runBench(config, name, bench_lookupHashTable, &ctx, numValues);
+
+        for (int i=0; i<numValues; i++){
+            freeValue(&ctx.values[i]);
+        }
+        free(ctx.values);
+    }
+}
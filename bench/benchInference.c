@@ -0,0 +1,123 @@
+#include "benchHarness.h"
+
+// benchInference.c
+
+#define INFERENCE_BENCH_ROWS 65536
+#define INFERENCE_BENCH_FEATURES 64
+#define SERVING_BENCH_ACQUIRES 1000000
+#define LATENCY_BENCH_VALUES 1000000
+
+/**
+ * @note InferenceBenchCtx holds a model snapshot, a batch of rows and the pool predicting them
+*/
+typedef struct {
+    InferencePool* pool;
+    InferenceModel* model;
+    float* features;
+    int32_t* labels;
+} InferenceBenchCtx;
+
+/**
+ * @bench predictBatch() of INFERENCE_BENCH_ROWS rows, reported per row
+*/
+long long bench_predictBatch(void* ctx){
+
+    InferenceBenchCtx* inferenceCtx = (InferenceBenchCtx*)ctx;
+
+    long long start = benchNow();
+    predictBatch(inferenceCtx->pool, inferenceCtx->model, inferenceCtx->features, INFERENCE_BENCH_ROWS, inferenceCtx->labels, NULL);
+    return benchNow() - start;
+}
+
+/**
+ * @bench acquireSnapshot() and releaseSnapshot() of a ServingModel, the reader side of a hot swap, reported per pair
+*/
+long long bench_acquireSnapshot(void* ctx){
+
+    ServingModel* serving = (ServingModel*)ctx;
+    int reader = 0;
+    uint64_t versions = 0;
+
+    long long start = benchNow();
+
+    for (int i=0; i<SERVING_BENCH_ACQUIRES; i++){
+
+        versions += acquireSnapshot(serving, reader)->version;
+        releaseSnapshot(serving, reader);
+    }
+
+    long long elapsed = benchNow() - start;
+    assert(versions == SERVING_BENCH_ACQUIRES);
+
+    return elapsed;
+}
+
+/**
+ * @bench recordLatency() of values spread over 6 orders of magnitude, reported per value
+*/
+long long bench_recordLatency(void* ctx){
+
+    LatencyHistogram* histogram = (LatencyHistogram*)ctx;
+    uint64_t ns = 1;
+
+    long long start = benchNow();
+
+    for (int i=0; i<LATENCY_BENCH_VALUES; i++){
+
+        recordLatency(histogram, ns);
+        ns = ns < 1000000 ? ns * 3 + 1 : 1;
+    }
+
+    return benchNow() - start;
+}
+
+/**
+ * @note benchInference() measures batched prediction of a 64-256-128-10 mlp on one thread and on every core, the 
+ * ratio of the two being the scaling of the pool, and the per call overhead of reading it through a ServingModel and of 
+ * recording its latency
+*/
+void benchInference(BenchConfig* config){
+
+    int layerSizes[] = {256, 128, 10};
+    MLP* mlp = newMLP(INFERENCE_BENCH_FEATURES, layerSizes, 3);
+
+    Rng rng;
+    seedRng(&rng, 17);
+
+    InferenceBenchCtx ctx;
+    ctx.model = newInferenceModel(mlp);
+    ctx.features = malloc(sizeof(float) * INFERENCE_BENCH_ROWS * INFERENCE_BENCH_FEATURES);
+    ctx.labels = malloc(sizeof(int32_t) * INFERENCE_BENCH_ROWS);
+    assert(ctx.features != NULL && ctx.labels != NULL);
+
+    for (int i=0; i<INFERENCE_BENCH_ROWS * INFERENCE_BENCH_FEATURES; i++){
+        ctx.features[i] = (float)rngNormal(&rng);
+    }
+
+    int numThreads[2] = {1, 0};
+    const char* names[2] = {"predictBatch 1 thread rows", "predictBatch all cores rows"};
+
+    for (int p=0; p<2; p++){
+
+        ctx.pool = newInferencePool(numThreads[p]);
+        runBench(config, names[p], bench_predictBatch, &ctx, INFERENCE_BENCH_ROWS);
+        freeInferencePool(&ctx.pool);
+    }
+
+    ServingModel* serving = newServingModel(mlp);
+    int reader = registerServingReader(serving);
+    assert(reader == 0);
+    runBench(config, "acquireSnapshot+releaseSnapshot", bench_acquireSnapshot, serving, SERVING_BENCH_ACQUIRES);
+    freeServingModel(&serving);
+
+    LatencyHistogram* histogram = malloc(sizeof(LatencyHistogram));
+    assert(histogram != NULL);
+    resetLatencyHistogram(histogram);
+    runBench(config, "recordLatency", bench_recordLatency, histogram, LATENCY_BENCH_VALUES);
+    free(histogram);
+
+    free(ctx.features);
+    free(ctx.labels);
+    freeInferenceModel(&ctx.model);
+    freeMLP(&mlp);
+}
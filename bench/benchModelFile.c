@@ -0,0 +1,78 @@
+#include "benchHarness.h"
+
+// benchModelFile.c
+
+#define MODEL_BENCH_PATH "/tmp/nnc_bench_model.bin"
+
+/**
+ * @bench saveMLP() of a 1024-1024-1024 mlp, reported per byte so ops/sec is bytes/sec
+*/
+long long bench_saveMLP(void* ctx){
+
+    long long start = benchNow();
+    int saved = saveMLP((MLP*)ctx, MODEL_BENCH_PATH);
+    long long elapsed = benchNow() - start;
+
+    assert(saved == 1);
+    return elapsed;
+}
+
+/**
+ * @bench loadMLP() of the file written by bench_saveMLP(), including building the mlp's Values
+*/
+long long bench_loadMLP(void* ctx){
+    (void)ctx;
+
+    long long start = benchNow();
+    MLP* mlp = loadMLP(MODEL_BENCH_PATH);
+    long long elapsed = benchNow() - start;
+
+    assert(mlp != NULL);
+    freeMLP(&mlp);
+    return elapsed;
+}
+
+/**
+ * @bench time to first prediction of a mapped model: openInferenceModel(), one forwardInference() and unmapping
+*/
+long long bench_firstPrediction(void* ctx){
+    (void)ctx;
+
+    float row[1024] = {0};
+    double output[1024];
+
+    long long start = benchNow();
+
+    InferenceModel* model = openInferenceModel(MODEL_BENCH_PATH);
+    assert(model != NULL);
+
+    double* scratch = (double*)malloc(sizeof(double) * 2 * model->maxWidth);
+    forwardInference(model, row, scratch, output);
+    free(scratch);
+    freeInferenceModel(&model);
+
+    return benchNow() - start;
+}
+
+/**
+ * @note benchModelFile() measures the save and load throughput of model files of a 2.1M parameter mlp, and the time to 
+ * the first prediction when the same file is mapped for inference instead
+*/
+void benchModelFile(BenchConfig* config){
+
+    int layerSizes[] = {1024, 1024};
+    MLP* mlp = newMLP(1024, layerSizes, 2);
+
+    long long numBytes = (1024LL * 1024 + 1024) * 2 * sizeof(double);
+
+    // the load benchmarks read this file whether or not the save benchmark is filtered out
+    int saved = saveMLP(mlp, MODEL_BENCH_PATH);
+    assert(saved == 1);
+
+    runBench(config, "saveMLP bytes", bench_saveMLP, mlp, numBytes);
+    runBench(config, "loadMLP bytes", bench_loadMLP, NULL, numBytes);
+    runBench(config, "openInferenceModel first prediction", bench_firstPrediction, NULL, 1);
+
+    remove(MODEL_BENCH_PATH);
+    freeMLP(&mlp);
+}
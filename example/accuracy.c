@@ -2,30 +2,27 @@
 #include "loadData.h"
 
 /**
- * @note correctPrediction() determines whether the highest probability within the output of softmax 
- * is accurate to the one hot encoded target vector array of Value struct ptrs
+ * @note datasetAccuracy() predicts every example of a dataset with a snapshot of the mlp and returns the fraction whose
+ * argmax matches its class label
+ * @param pool the InferencePool predicting the examples
+ * @param mlp the mlp to evaluate
+ * @param dataset the examples, in memory
 */
-double correctPrediction(double* softmaxOutputs, Value** target){
+double datasetAccuracy(InferencePool* pool, MLP* mlp, DenseDataset* dataset){
 
-    int indexTargetClass = -1;
-    int indexHighestProbability = -2;
+    InferenceModel* model = newInferenceModel(mlp);
+    int32_t* predictions = malloc(sizeof(int32_t) * dataset->numRows);
+    assert(predictions != NULL);
 
-    // perform an argmax on both arrays
-    for(int idx = 0; idx<NUM_CLASSES; idx++){
-        
-        if (target[idx]->value == 1){
-            indexTargetClass = idx;
-        }
+    predictBatch(pool, model, dataset->features, dataset->numRows, predictions, NULL);
 
-        if (softmaxOutputs[idx] > indexHighestProbability){
-            indexHighestProbability = idx;
-        }
+    uint64_t numCorrect = 0;
+    for (uint64_t row=0; row<dataset->numRows; row++){
+        numCorrect += predictions[row] == dataset->labels[row];
     }
 
-    // compare argmaxes
-    if (indexTargetClass == indexHighestProbability){
-        return 1;
-    }
+    free(predictions);
+    freeInferenceModel(&model);
 
-    return 0;
-}
\ No newline at end of file
+    return (double)numCorrect / dataset->numRows;
+}
@@ -2,4 +2,4 @@
 
 #include "lib.h"
 
-double correctPrediction(double* softmaxOutputs, Value** target);
\ No newline at end of file
+double datasetAccuracy(InferencePool* pool, MLP* mlp, DenseDataset* dataset);
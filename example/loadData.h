@@ -5,11 +5,4 @@
 #define NUM_FEATURES 4
 #define NUM_CLASSES 3
 
-// struct to hold dataset
-typedef struct {
-    Value*** features;
-    Value*** targets;
-}Dataset;
-
-Dataset* loadData(void);
-void freeDataset(Dataset** dataset);
\ No newline at end of file
+DenseDataset* loadData(void);
\ No newline at end of file
@@ -5,7 +5,7 @@
 int main(void){
 
     // load data
-    Dataset* dataset = loadData();
+    DenseDataset* dataset = loadData();
 
     // mlp specs
     int inputSize = 4, outputSize = 3;
@@ -18,55 +18,84 @@ int main(void){
     // training parameters
     double lr = 0.001;
     int epochs = 5;
+    int batchSize = 16;
+
+    // shuffle and batch the data on a background thread
+    DataLoader* loader = newDataLoader(dataset, batchSize, epochs, LOADER_SHUFFLE, 0);
+
+    // evaluate on every core
+    InferencePool* pool = newInferencePool(0);
 
     // run training loop
     for (int epoch=0; epoch<epochs; epoch++){
 
         // loss accumulator 
-        double epochLoss = 0, epochAccuracy = 0;
+        double epochLoss = 0;
+
+        // measure the largest graph built during the epoch
+        resetMemPeaks();
+
+        // forward pass on all examples, in the shuffled batches prepared by the loader thread
+        Batch* batch;
+        while ((batch = nextBatch(loader)) != NULL){
+
+            for (int example=0; example<batch->numRows; example++){
 
-        // forward pass on all examples
-        for(int example=0; example<NUM_EXAMPLES; example++){
+                int32_t label = batch->labels[example];
 
-            // run forward pass on example
-            Value** output = Forward(mlp, dataset->features[example]);
+                // run forward pass on example
+                Value** output = ForwardRow(mlp, batch->features + example * NUM_FEATURES);
 
-            // get softmax results array
-            double* softmax = Softmax(output, outputSize);
+                // get softmax results array
+                double* softmax = Softmax(output, outputSize);
 
-            // compute loss
-            Value* loss = categoricalCrossEntropy(
-                output, 
-                dataset->targets[example], 
-                softmax, 
-                outputSize, 
-                mlp->graphStack
-                );
-            
+                // compute loss
+                Value* loss = sparseCategoricalCrossEntropy(
+                    output, 
+                    label, 
+                    softmax, 
+                    outputSize, 
+                    mlp->graphStack
+                    );
+                
 
-            // accumulate loss and accuracy
-            epochLoss += loss->value;
-            epochAccuracy += correctPrediction(softmax, dataset->targets[example]);
+                PROFILE_EXAMPLES(1);
 
-            // backpropagate gradient
-            Backward(loss, softmax, dataset->targets[example]);    
+                // accumulate loss
+                epochLoss += loss->value;
 
-            // zpply gradient descent
-            Step(mlp, lr);
+                // backpropagate gradient
+                BackwardSparse(loss, softmax, label);    
 
-            // zero gradient and free computational graph
-            ZeroGrad(mlp);
+                // zpply gradient descent
+                Step(mlp, lr);
+
+                // zero gradient and free computational graph
+                ZeroGrad(mlp);
+            }
+
+            // hand the batch buffer back to the loader
+            releaseBatch(loader);
         }
 
-        // average loss, acc accumulation across epoch
-        epochLoss /= NUM_EXAMPLES, epochAccuracy /= NUM_EXAMPLES;
+        // average loss across epoch, accuracy of the weights at the end of it
+        epochLoss /= NUM_EXAMPLES;
+        double epochAccuracy = datasetAccuracy(pool, mlp, dataset);
+
+        MemStats memStats;
+        getMemStats(&memStats);
+
+        printf("\nEpoch %d --- Loss: %lf --- Accuracy %lf --- Peak Memory %lld bytes", 
+            epoch, epochLoss, epochAccuracy, memStats.peakTotalBytes);
 
-        printf("\nEpoch %d --- Loss: %lf --- Accuracy %lf", epoch, epochLoss, epochAccuracy);
+        PROFILE_EPOCH_REPORT(epoch);
     }
 
     // cleanup memory
     freeMLP(&mlp);
-    freeDataset(&dataset);
+    freeDataLoader(&loader);
+    freeInferencePool(&pool);
+    freeDenseDataset(&dataset);
     
     return 0;
 }
\ No newline at end of file
@@ -8,7 +8,9 @@
 
 // Value Constructor/Destructor
 Value* newValue(double value, Value* ancestors[], int ancestorArrLen, char opString[]);
+Value* newConstant(double value, char opString[]);
 void freeValue(Value** v);
+size_t valueBytes(Value* v);
 
 // Value Operations
 void addBackward(Value* v);
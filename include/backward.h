@@ -8,4 +8,8 @@
 // Backpropagation functions
 void depthFirstSearch(Value* value, HashTable* visitedHashTable, GraphStack* sortedStack);
 void reverseTopologicalSort(Value* start, GraphStack** sortedStack);
-void Backward(Value* value, double* softmaxOutput, Value** targetsArr);
\ No newline at end of file
+void backpropagateSorted(GraphStack* sortStack, double* softmaxOutput, Value** targetsArr, int label);
+void Backward(Value* value, double* softmaxOutput, Value** targetsArr);
+void BackwardSparse(Value* value, double* softmaxOutput, int label);
+void backpropagateLoss(Value* value, double* softmaxOutput, Value** targetsArr, int label);
+void backwardFromSeeds(Value** outputs, int numOutputs);
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+#include <stdint.h>
+#include <pthread.h>
+#include "inference.h"
+#include "inferencePool.h"
+#include "latencyHistogram.h"
+
+// batchQueue.h
+
+/**
+ * @note batchQueue.h contains a dynamic batching front end for online inference. Client threads submit single rows and
+ * block on a PredictFuture. A dispatcher thread collects the rows into a batch until it holds maxBatchRows rows or its
+ * oldest row has waited maxWaitNs, predicts the whole batch with one predictBatch() call and completes the futures.
+ * @dev the queue double buffers its batches: clients fill one while the dispatcher predicts the other, so submitting 
+ * only blocks when the filling batch is full. A batch that filled up while the previous one was being predicted is 
+ * dispatched as soon as the dispatcher is free, so batches grow with load and latency stays bounded by maxWaitNs plus 
+ * the time of one batch.
+*/
+
+/**
+ * @note PredictFuture is the result of one submitted row, owned by the client that submitted it
+ * @param label argmax class of the row, valid once done
+ * @param probs outputSize doubles to write the softmax probabilities to, or NULL
+*/
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int done;
+    int32_t label;
+    double* probs;
+} PredictFuture;
+
+/**
+ * @note QueueBatch is one of the two batch buffers of a BatchQueue
+ * @param features row major maxBatchRows x inputSize matrix the submitted rows are copied into
+ * @param futures the future of every row
+ * @param submitNs profileNow() when each row was submitted
+ * @param wantProbs set if any row asked for probabilities
+*/
+typedef struct {
+    float* features;
+    int32_t* labels;
+    double* probs;
+    PredictFuture** futures;
+    long long* submitNs;
+    int numRows;
+    int wantProbs;
+} QueueBatch;
+
+/**
+ * @note BatchQueue is the dispatcher thread and the batches it collects
+ * @dev batches[filling] is filled by clients under lock, the other batch belongs to the dispatcher while it predicts.
+ * Clients signal ready when a batch gets its first row or fills up, the dispatcher signals space when it takes a batch.
+ * @param pool predicts the batches, used only by the dispatcher
+ * @param numBatches/numRequests dispatched so far, numRequests / numBatches is the mean batch size
+ * @param latencies time from submitting each request to its future being completed, written by the dispatcher under 
+ * lock, read with getQueueLatencies()
+*/
+typedef struct {
+    InferencePool* pool;
+    InferenceModel* model;
+    int maxBatchRows;
+    long long maxWaitNs;
+
+    pthread_t dispatcher;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t space;
+
+    QueueBatch batches[2];
+    int filling;
+    int stop;
+
+    uint64_t numBatches;
+    uint64_t numRequests;
+    LatencyHistogram latencies;
+} BatchQueue;
+
+// batch queue functions
+BatchQueue* newBatchQueue(InferencePool* pool, InferenceModel* model, int maxBatchRows, long long maxWaitNs);
+void freeBatchQueue(BatchQueue** queue);
+void submitPrediction(BatchQueue* queue, const float* row, double* probs, PredictFuture* future);
+int32_t waitPrediction(PredictFuture* future);
+int32_t predictQueued(BatchQueue* queue, const float* row, double* probs);
+void getQueueLatencies(BatchQueue* queue, LatencyHistogram* latencies);
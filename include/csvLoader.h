@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include "dataset.h"
+
+// csvLoader.h
+
+/**
+ * @note csvLoader.h contains a streaming loader for numeric CSV classification data. Column types are inferred from 
+ * a sample of rows, string class labels are mapped to integer ids on the fly, and rows are delivered in batches into 
+ * caller owned buffers, so memory use is bounded by the read chunk no matter how large the file is. Files that fit in 
+ * memory can instead be mapped and parsed by multiple threads into one contiguous DenseDataset.
+*/
+
+#define CSV_CHUNK_BYTES (1 << 20)
+#define CSV_SCHEMA_SAMPLE_ROWS 100
+
+// parallel loading
+#define CSV_AUTO_THREADS 0
+#define CSV_MIN_THREAD_BYTES (1 << 16)
+
+// CsvOptions values
+#define CSV_LAST_COLUMN -1
+#define CSV_NO_COLUMN -1
+#define CSV_DETECT -1
+#define CSV_BAD_ROW -1
+
+// column kinds
+#define CSV_NUMERIC 0
+#define CSV_STRING 1
+#define CSV_IGNORED 2
+
+/**
+ * @note CsvOptions configures how a CSV file is interpreted
+ * @param labelColumn index of the class label column, or CSV_LAST_COLUMN
+ * @param ignoreColumn index of a column to skip (ie: a row id), or CSV_NO_COLUMN
+ * @param hasHeader 1 if the first line is a header, 0 if not, CSV_DETECT to infer it
+*/
+typedef struct {
+    int labelColumn;
+    int ignoreColumn;
+    int hasHeader;
+} CsvOptions;
+
+/**
+ * @note LabelDictionary maps class label strings to dense integer ids in order of first appearance
+ * @dev open addressing hash table of string -> id, with the strings also kept in id order for labelName()
+*/
+typedef struct {
+    char** names;
+    int numLabels;
+    int* slots;
+    int numSlots;
+} LabelDictionary;
+
+/**
+ * @note CsvStream is an open CSV file being read in chunks
+ * @param buffer chunk buffer holding [pos, len) unread bytes
+ * @param columnKinds inferred CSV_NUMERIC/CSV_STRING/CSV_IGNORED kind of each column
+ * @param labelColumn resolved index of the label column
+ * @param labelsAreNumeric 1 if labels are integers used directly as class ids, 0 if mapped through labels
+ * @param numFeatures number of numeric feature columns
+ * @param numClasses number of classes seen so far
+ * @param lineNumber number of lines read so far, header included, so the line number of the last line read
+ * @param badRow 1 once a malformed row has been read
+*/
+typedef struct {
+    FILE* file;
+    char* buffer;
+    size_t capacity;
+    size_t len;
+    size_t pos;
+    int eof;
+
+    CsvOptions options;
+    int numColumns;
+    int* columnKinds;
+    int labelColumn;
+    int labelsAreNumeric;
+    int numFeatures;
+    int numClasses;
+
+    LabelDictionary labels;
+    long long rowsRead;
+    long long lineNumber;
+    int badRow;
+} CsvStream;
+
+/**
+ * @note CsvParseTask is the chunk of a mapped CSV file parsed by one thread of loadCsvDatasetThreads()
+ * @param schema stream holding the inferred schema, shared read only by all tasks
+ * @param start first byte of the chunk, always the start of a line
+ * @param end one past the last byte of the chunk, always after a '\n' or the end of the file
+ * @param numRows number of non blank lines in the chunk
+ * @param numLines number of lines in the chunk, blank ones included
+ * @param firstRow index of the first row of the chunk in the stitched feature matrix
+ * @param localLabels label dictionary of the chunk, merged after parsing
+ * @param badLine index within the chunk of the first malformed line, or -1
+ * @param error what is wrong with that line
+*/
+typedef struct {
+    CsvStream* schema;
+    const char* start;
+    const char* end;
+    uint64_t numRows;
+    uint64_t numLines;
+    uint64_t firstRow;
+    float* features;
+    int32_t* labels;
+    LabelDictionary localLabels;
+    int64_t badLine;
+    const char* error;
+} CsvParseTask;
+
+// field parsing
+double parseDecimal(const char* start, const char* end, const char** next);
+
+// csv stream functions
+void defaultCsvOptions(CsvOptions* options);
+CsvStream* openCsvStream(const char* path, CsvOptions* options);
+int nextCsvBatch(CsvStream* stream, float* features, int32_t* labels, int maxRows);
+void rewindCsvStream(CsvStream* stream);
+void closeCsvStream(CsvStream** stream);
+const char* labelName(CsvStream* stream, int label);
+DenseDataset* loadCsvDatasetThreads(const char* path, CsvOptions* options, int numThreads);
+DenseDataset* loadCsvDataset(const char* path, CsvOptions* options);
@@ -0,0 +1,111 @@
+#pragma once
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "dataset.h"
+#include "csvLoader.h"
+#include "rng.h"
+
+// dataLoader.h
+
+/**
+ * @note dataLoader.h contains a background data loader. A producer thread shuffles the rows of each epoch, gathers them
+ * into mini-batches and hands the batches to the training thread through a lock free single producer/single consumer
+ * ring, so data preparation overlaps with compute.
+ * @dev in memory datasets are fully shuffled with a Fisher-Yates permutation each epoch. Streamed CSV data can not be
+ * permuted without reading it all, so rows pass through a bounded shuffle buffer and are drawn from it at random.
+ * @dev the shuffle of each epoch draws from its own Rng stream derived from (seed, epoch), so a loader can be restarted 
+ * at any LoaderPosition and deliver exactly the batches the original loader would have
+*/
+
+#define LOADER_RING_SLOTS 4
+#define LOADER_NO_SHUFFLE 0
+#define LOADER_SHUFFLE 1
+
+// getLoaderStatus() values, why the last nextBatch() call returned what it did
+#define LOADER_OK 0
+#define LOADER_END_OF_EPOCH 1
+#define LOADER_DONE 2
+#define LOADER_BAD_ROW 3
+
+/**
+ * @note Batch is one mini-batch in a ring slot of a DataLoader
+ * @param features row major numRows x numFeatures matrix, allocated once and aligned to DATASET_ALIGNMENT
+ * @param labels numRows class labels
+ * @param numRows rows in this batch, the last batch of an epoch can be short. 0 marks the end of an epoch
+ * @param epoch epoch the batch belongs to
+*/
+typedef struct {
+    float* features;
+    int32_t* labels;
+    int numRows;
+    int epoch;
+} Batch;
+
+/**
+ * @note LoaderPosition is a position in the sequence of batches delivered by a DataLoader
+ * @param epoch epoch of the next batch to deliver
+ * @param batch number of batches of that epoch already delivered
+*/
+typedef struct {
+    int epoch;
+    int64_t batch;
+} LoaderPosition;
+
+/**
+ * @note DataLoader is a producer thread filling a ring of batch buffers and the state it shuffles with
+ * @dev head counts batches published by the producer and tail counts batches released by the consumer. Slot i %
+ * LOADER_RING_SLOTS is owned by the producer while head - tail < LOADER_RING_SLOTS, so the consumer works on one batch
+ * while the producer fills the next (double buffering) without any lock.
+ * @param dataset in memory source, or NULL
+ * @param stream streamed source, or NULL
+ * @param order permutation of the rows of dataset for the current epoch
+ * @param bufferFeatures/bufferLabels shuffle buffer of streamed rows holding bufferCount of bufferRows rows
+ * @param start position the producer starts at
+ * @param position position of the consumer, advanced by releaseBatch() and at epoch ends
+ * @param status LOADER_* result of the last nextBatch(), owned by the consumer
+ * @param badRow set by the producer when a malformed streamed row stops it, with badLine the line of that row. Both 
+ * are written before finished is released, so the consumer reads them after seeing finished.
+*/
+typedef struct {
+    DenseDataset* dataset;
+    CsvStream* stream;
+    int numFeatures;
+    int batchSize;
+    int numEpochs;
+    int shuffle;
+    uint64_t seed;
+    Rng rng;
+
+    uint64_t* order;
+
+    float* bufferFeatures;
+    int32_t* bufferLabels;
+    int bufferRows;
+    int bufferCount;
+
+    LoaderPosition start;
+    LoaderPosition position;
+    int status;
+
+    _Atomic int badRow;
+    long long badLine;
+
+    Batch ring[LOADER_RING_SLOTS];
+    _Atomic uint64_t head;
+    _Atomic uint64_t tail;
+    _Atomic int stop;
+    _Atomic int finished;
+    pthread_t thread;
+} DataLoader;
+
+// data loader functions
+DataLoader* newDataLoader(DenseDataset* dataset, int batchSize, int numEpochs, int shuffle, uint64_t seed);
+DataLoader* newStreamLoader(CsvStream* stream, int batchSize, int shuffleBufferRows, int numEpochs, uint64_t seed);
+DataLoader* newDataLoaderAt(DenseDataset* dataset, int batchSize, int numEpochs, int shuffle, uint64_t seed, LoaderPosition start);
+DataLoader* newStreamLoaderAt(CsvStream* stream, int batchSize, int shuffleBufferRows, int numEpochs, uint64_t seed, LoaderPosition start);
+LoaderPosition getLoaderPosition(DataLoader* loader);
+int getLoaderStatus(DataLoader* loader);
+Batch* nextBatch(DataLoader* loader);
+void releaseBatch(DataLoader* loader);
+void freeDataLoader(DataLoader** loader);
@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+// dataset.h
+
+/**
+ * @note dataset.h contains the binary dataset format used for large classification datasets. A file holds a 64 byte 
+ * DatasetHeader, followed by a row major numRows x numFeatures matrix of features, followed by a column of numRows 
+ * int32 class labels. Both blocks start on a 64 byte boundary so they can be used in place once mapped into memory.
+ * @dev features can also be stored quantized to uint8 or int16 to cut the bytes read per epoch by 4x or 2x. A block of
+ * per column scale and offset floats then precedes the features, and x = offset[j] + scale[j] * q as rows are gathered.
+*/
+
+#define DATASET_MAGIC "NNCD"
+#define DATASET_VERSION 1
+#define DATASET_ALIGNMENT 64
+
+// feature storage types
+#define DTYPE_FLOAT32 0
+#define DTYPE_UINT8 1
+#define DTYPE_INT16 2
+
+/**
+ * @note DatasetHeader is the on disk header of a binary dataset file
+ * @param magic DATASET_MAGIC
+ * @param version DATASET_VERSION
+ * @param numRows number of examples
+ * @param numFeatures number of features per example
+ * @param numClasses number of classes, labels are in [0, numClasses)
+ * @param dtype storage type of the features
+ * @param featuresOffset byte offset of the feature matrix
+ * @param labelsOffset byte offset of the label column
+ * @param quantOffset byte offset of the numFeatures scales followed by numFeatures offsets of a quantized dataset, 0
+ * for DTYPE_FLOAT32
+*/
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t numRows;
+    uint32_t numFeatures;
+    uint32_t numClasses;
+    uint32_t dtype;
+    uint32_t reserved0;
+    uint64_t featuresOffset;
+    uint64_t labelsOffset;
+    uint64_t quantOffset;
+    uint8_t reserved[8];
+} DatasetHeader;
+
+/**
+ * @note DatasetWriter streams rows into a binary dataset file whose size is known up front. Features and labels are 
+ * written through two FILE handles positioned at their blocks, so no rows need to be buffered.
+*/
+typedef struct {
+    DatasetHeader header;
+    FILE* featureFile;
+    FILE* labelFile;
+    uint64_t rowsWritten;
+
+    // quantization of DTYPE_UINT8/DTYPE_INT16 datasets
+    float* scale;
+    float* offset;
+    void* quantBuffer;
+    size_t quantBufferBytes;
+} DatasetWriter;
+
+/**
+ * @note DenseDataset is an in memory view of a dataset: a row major numRows x numFeatures float matrix and a column 
+ * of int32 class labels.
+ * @dev when opened with openDenseDataset() both arrays point directly into a read only mapping of the file, so rows 
+ * are read from the page cache and must not be written to. Otherwise mapping is NULL and the arrays are owned, aligned
+ * allocations from newDenseDataset().
+ * @dev a mapped quantized dataset has no float matrix (features is NULL). Its rows are read with gatherBatch(), which 
+ * dequantizes quantFeatures with the per column scale and offset.
+*/
+typedef struct {
+    uint64_t numRows;
+    int numFeatures;
+    int numClasses;
+    float* features;
+    int32_t* labels;
+    void* mapping;
+    size_t mapLen;
+
+    int dtype;
+    const void* quantFeatures;
+    const float* scale;
+    const float* offset;
+} DenseDataset;
+
+// binary dataset functions
+uint64_t alignOffset(uint64_t offset);
+size_t dtypeSize(int dtype);
+void initDatasetHeader(DatasetHeader* header, uint64_t numRows, int numFeatures, int numClasses);
+void initQuantizedDatasetHeader(DatasetHeader* header, uint64_t numRows, int numFeatures, int numClasses, int dtype);
+int validateDatasetHeader(const DatasetHeader* header);
+int validateDatasetLayout(const DatasetHeader* header, uint64_t fileSize);
+int readDatasetHeader(FILE* file, DatasetHeader* header);
+DatasetWriter* newDatasetWriter(const char* path, uint64_t numRows, int numFeatures, int numClasses);
+DatasetWriter* newQuantizedDatasetWriter(const char* path, uint64_t numRows, int numFeatures, int numClasses, int dtype, const float* scale, const float* offset);
+void writeDatasetRows(DatasetWriter* writer, const float* features, const int32_t* labels, int numRows);
+void closeDatasetWriter(DatasetWriter** writer);
+
+// quantization functions
+void computeQuantParams(const float* features, uint64_t numRows, int numFeatures, int dtype, float* scale, float* offset);
+void quantParamsFromRange(float min, float max, int dtype, float* scale, float* offset);
+void quantizeRow(const float* row, int numFeatures, int dtype, const float* scale, const float* offset, void* out);
+void dequantizeRow(const void* row, int numFeatures, int dtype, const float* scale, const float* offset, float* out);
+
+// dense dataset functions
+DenseDataset* newDenseDataset(uint64_t numRows, int numFeatures, int numClasses);
+DenseDataset* openDenseDataset(const char* path);
+int verifyDenseDataset(DenseDataset* dataset);
+void freeDenseDataset(DenseDataset** dataset);
+const float* getFeatureRow(DenseDataset* dataset, uint64_t row);
+void gatherBatch(DenseDataset* dataset, const uint64_t* rows, int batchSize, float* features, int32_t* labels);
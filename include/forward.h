@@ -7,4 +7,6 @@ Value** newOutputVector(int outputSize);
 Value** MultiplyWeights(Layer* layer, Value** input, GraphStack* graphStack);
 Value** AddBias(Layer* layer, Value** input, GraphStack* graphStack);
 Value** ApplyReLU(Layer* layer, Value** input, GraphStack* graphStack);
-Value** Forward(MLP* mlp, Value** input);
\ No newline at end of file
+Value** ForwardLayer(Layer* layer, Value** input, GraphStack* graphStack);
+Value** Forward(MLP* mlp, Value** input);
+Value** ForwardRow(MLP* mlp, const float* row);
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#include "value.h"
+#include "mlp.h"
+
+// gradCheckpoint.h
+
+/**
+ * @note gradient checkpointing trades recomputation for graph memory. The layers of an mlp are split into segments 
+ * of checkpointInterval layers. During the forward pass only the output vector at each segment boundary is kept 
+ * (as detached leaf Values), the graph of every segment but the last is released as soon as it has been computed.
+ * After Backward() has reached the last boundary, CheckpointBackward() recomputes each earlier segment from its 
+ * boundary and backpropagates through it, one segment at a time.
+*/
+
+// gradient checkpointing functions
+int sqrtCheckpointInterval(int numLayers);
+void setCheckpointInterval(MLP* mlp, int interval);
+void releaseCheckpoints(MLP* mlp);
+Value** ForwardCheckpointed(MLP* mlp, Value** input);
+void CheckpointBackward(MLP* mlp);
@@ -1,3 +1,4 @@
 #include "mlp.h"
 
+void StepLayer(Layer* layer, double lr);
 void Step(MLP* mlp, double lr);
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "mlp.h"
+#include "latencyHistogram.h"
+
+// inference.h
+
+/**
+ * @note inference.h contains an inference only model handle. Its parameters are plain contiguous doubles in the layout 
+ * of a model file (modelFile.h) and its forward pass builds no computational graph, so running a row allocates 
+ * nothing and touches each parameter once.
+ * @dev openInferenceModel() maps a model file read only and points every layer directly into the mapping. Nothing is 
+ * copied or parsed beyond the header, pages are faulted in from the page cache on first use and are shared by every 
+ * process serving the same file.
+*/
+
+/**
+ * @note InferenceLayer is one layer of an InferenceModel, out = activation(weights * in + biases)
+ * @param weights row major outputSize x inputSize matrix
+ * @param biases outputSize biases
+*/
+typedef struct {
+    int inputSize;
+    int outputSize;
+    int activation;
+    const double* weights;
+    const double* biases;
+} InferenceLayer;
+
+/**
+ * @note InferenceModel is a read only mlp for inference, either mapped from a model file or snapshotted from an MLP
+ * @param maxWidth the widest of the input and every layer output, scratch buffers hold 2 * maxWidth doubles
+ * @param mapping the mapped model file, or NULL for a snapshot
+ * @param params a snapshot's complete model file image, header included, or NULL when mapped
+ * @param imageBytes size of the model file image, mapped or snapshotted
+ * @param checksum checksum of the parameters from the model file header
+*/
+typedef struct {
+    int numLayers;
+    int inputSize;
+    int outputSize;
+    int maxWidth;
+    InferenceLayer* layers;
+
+    void* mapping;
+    size_t mapLen;
+    void* params;
+    size_t imageBytes;
+    uint64_t checksum;
+} InferenceModel;
+
+/**
+ * @note InferenceContext is the fixed working memory of one thread running a model, allocated once by 
+ * newInferenceContext() so that forwardContext() and predictContext() never touch the heap
+ * @param ping/pong the two activation buffers of model->maxWidth doubles each, contiguous
+ * @param output model->outputSize doubles after pong, where forwardContext() and predictContext() leave the outputs
+ * @param latency latency of every forwardContext() and predictContext() call, NULL unless enabled by 
+ * enableContextLatency(). Written by the context's thread only, so it is in effect a thread local histogram.
+*/
+typedef struct {
+    InferenceModel* model;
+    double* ping;
+    double* pong;
+    double* output;
+    LatencyHistogram* latency;
+} InferenceContext;
+
+// inference model functions
+InferenceModel* openInferenceModel(const char* path);
+InferenceModel* newInferenceModel(MLP* mlp);
+int verifyInferenceModel(InferenceModel* model);
+void freeInferenceModel(InferenceModel** model);
+const double* forwardLayers(InferenceModel* model, const float* row, double* scratch);
+void forwardInference(InferenceModel* model, const float* row, double* scratch, double* output);
+
+// inference context functions
+InferenceContext* newInferenceContext(InferenceModel* model);
+void freeInferenceContext(InferenceContext** context);
+const double* forwardContext(InferenceContext* context, const float* row);
+int32_t predictContext(InferenceContext* context, const float* row, double* probs);
+void enableContextLatency(InferenceContext* context);
+void mergeContextLatencies(InferenceContext** contexts, int numContexts, LatencyHistogram* histogram);
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "inference.h"
+#include "latencyHistogram.h"
+
+// inferencePool.h
+
+/**
+ * @note inferencePool.h contains batched, multithreaded inference. An InferencePool keeps its worker threads alive 
+ * between calls, and predictBatch() splits the rows of a batch across them. Every worker runs forwardInference() into 
+ * its own scratch buffers and writes the argmax and/or the softmax probabilities of its rows.
+ * @dev rows are claimed in chunks of PREDICT_CHUNK_ROWS from a shared atomic counter, so workers that finish early take 
+ * more chunks instead of idling on a static split. The calling thread works too.
+*/
+
+#define PREDICT_CHUNK_ROWS 256
+
+/**
+ * @note PoolWorker is the per thread state of an InferencePool, worker 0 is the thread calling predictBatch()
+ * @param scratch 2 * maxWidth + outputSize doubles, grown when a wider model is used
+*/
+typedef struct {
+    struct _inferencePool* pool;
+    pthread_t thread;
+    int id;
+    double* scratch;
+    size_t scratchLen;
+} PoolWorker;
+
+/**
+ * @note InferencePool is a set of persistent worker threads and the batch they are currently predicting
+ * @dev a batch is published under lock by bumping generation. Workers wake on start, claim chunks through nextRow and 
+ * the last one to finish signals done. Between batches the workers sleep on start.
+ * @param numWorkers workers including the caller, so numWorkers - 1 threads are created
+ * @param active workers still working on the current batch
+ * @param latencies latency of every predictBatch() call by batch size, NULL unless enabled by enablePoolLatencies()
+*/
+typedef struct _inferencePool {
+    int numWorkers;
+    PoolWorker* workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    int active;
+    int stop;
+
+    BatchLatencies* latencies;
+
+    // the current batch
+    InferenceModel* model;
+    const float* features;
+    int64_t numRows;
+    int32_t* labels;
+    double* probs;
+    _Atomic int64_t nextRow;
+} InferencePool;
+
+// inference pool functions
+InferencePool* newInferencePool(int numThreads);
+void freeInferencePool(InferencePool** pool);
+void enablePoolLatencies(InferencePool* pool);
+void predictOutputs(const double* output, int outputSize, int32_t* label, double* probs);
+void predictRow(InferenceModel* model, const float* row, double* scratch, int32_t* label, double* probs);
+void predictBatch(InferencePool* pool, InferenceModel* model, const float* features, int64_t numRows, int32_t* labels, double* probs);
@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+// latencyHistogram.h
+
+/**
+ * @note latencyHistogram.h contains an HDR style latency histogram. Values are bucketed by their power of two and the 
+ * next LATENCY_SUB_BITS bits below it, so every bucket is at most 1/32 (3.1%) wide relative to its values, from 1ns 
+ * up to 2^LATENCY_MAX_EXPONENT ns (68s) in a fixed LATENCY_NUM_BUCKETS counters.
+ * @dev recording is a count leading zeros, a shift and an increment, with no locks or atomics. A histogram has a single
+ * writer: each thread records into its own and histograms are merged for reporting, merging being exact.
+ * @dev BatchLatencies keeps one histogram per power of two batch size, for latency by batch size
+*/
+
+#define LATENCY_SUB_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_EXPONENT 36
+#define LATENCY_NUM_BUCKETS ((LATENCY_MAX_EXPONENT - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+#define LATENCY_BATCH_CLASSES 16
+
+/**
+ * @note LatencyHistogram is a log bucketed histogram of latencies in nanoseconds
+ * @param counts LATENCY_NUM_BUCKETS bucket counts, see latencyBucket()
+ * @param count number of values recorded
+ * @param min/max exact smallest and largest values recorded
+ * @param sum exact sum of the values recorded
+*/
+typedef struct {
+    uint64_t counts[LATENCY_NUM_BUCKETS];
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+} LatencyHistogram;
+
+/**
+ * @note BatchLatencies holds a LatencyHistogram for every batch size class, class c holding batches of [2^c, 2^(c+1)) 
+ * rows and the last class everything larger
+*/
+typedef struct {
+    LatencyHistogram classes[LATENCY_BATCH_CLASSES];
+} BatchLatencies;
+
+// latency histogram functions
+void resetLatencyHistogram(LatencyHistogram* histogram);
+int latencyBucket(uint64_t ns);
+uint64_t bucketLowerBound(int bucket);
+uint64_t bucketUpperBound(int bucket);
+void recordLatency(LatencyHistogram* histogram, uint64_t ns);
+void mergeLatencyHistogram(LatencyHistogram* dst, const LatencyHistogram* src);
+uint64_t latencyPercentile(const LatencyHistogram* histogram, double p);
+double latencyMean(const LatencyHistogram* histogram);
+void writeLatencyHistogram(const LatencyHistogram* histogram, const char* name, FILE* file);
+
+// batch latency functions
+BatchLatencies* newBatchLatencies(void);
+void freeBatchLatencies(BatchLatencies** latencies);
+int batchSizeClass(int64_t numRows);
+void recordBatchLatency(BatchLatencies* latencies, int64_t numRows, uint64_t ns);
+int writeBatchLatencies(const BatchLatencies* latencies, const char* path);
@@ -20,6 +20,22 @@
 #include "forward.h"
 #include "gradientDescent.h"
 #include "loss.h"
+#include "gradCheckpoint.h"
+#include "memStats.h"
+#include "profile.h"
+#include "rng.h"
+#include "dataset.h"
+#include "csvLoader.h"
+#include "dataLoader.h"
+#include "sparse.h"
+#include "modelFile.h"
+#include "inference.h"
+#include "trainCheckpoint.h"
+#include "latencyHistogram.h"
+#include "inferencePool.h"
+#include "batchQueue.h"
+#include "servingModel.h"
+#include "weightInit.h"
 
 // macros
 #define NO_ANCESTORS 0
@@ -27,4 +43,9 @@
 #define UNARY 0
 #define HASHTABLE_SIZE 150
 #define EPSILON 1e-10 
-#define NON_TRAINING_CALL 0
\ No newline at end of file
+#define NON_TRAINING_CALL 0
+#define NO_LABEL -1
+#define NO_CHECKPOINTING 0
+#define REQUIRES_GRAD 1
+#define NO_GRAD 0
+#define CHECKPOINT_SQRT -1
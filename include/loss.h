@@ -6,5 +6,11 @@
 double* Softmax(Value** valueArr, int lenArr);
 void freeSoftmax(double** softmaxArr);
 
-void categoricalCrossEntropyBackward(Value* v, double* softmaxOutput, Value** targetsArr, int lenArr);
-Value* categoricalCrossEntropy(Value** outputArr, Value** targetsArr, double* softmaxOutput, int lenArr, GraphStack* graphStack);
\ No newline at end of file
+Value*** newOneHotTargets(int numClasses);
+void freeOneHotTargets(Value**** targets, int numClasses);
+
+void categoricalCrossEntropyBackward(Value* v, double* softmaxOutput, Value** targetsArr, int label, int lenArr);
+Value* categoricalCrossEntropy(Value** outputArr, Value** targetsArr, double* softmaxOutput, int lenArr, GraphStack* graphStack);
+
+void sparseCategoricalCrossEntropyBackward(Value* v, double* softmaxOutput, Value** targetsArr, int label, int lenArr);
+Value* sparseCategoricalCrossEntropy(Value** outputArr, int label, double* softmaxOutput, int lenArr, GraphStack* graphStack);
\ No newline at end of file
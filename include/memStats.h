@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+
+// memStats.h
+
+/**
+ * @note memStats.h contains library wide memory accounting for the structures that make up the computational graph 
+ * and the parameters of an mlp. Every allocation of a tracked structure reports its object count and bytes here.
+ * @dev counters are plain globals, graph construction is single threaded
+*/
+
+/**
+ * @note MemCategory identifies which kind of structure an allocation belongs to
+ * @dev MEM_VALUES are Value structs in the computational graph (and any other Value not owned by a Layer)
+ * @dev MEM_GRAPH_NODES are GraphNode/GraphStack allocations
+ * @dev MEM_HASH_BUCKETS are HashTable/BucketNode allocations made during the topological sort
+ * @dev MEM_PARAMETERS are Layer structs, their weight/bias arrays and the Value structs they own
+*/
+typedef enum {
+    MEM_VALUES,
+    MEM_GRAPH_NODES,
+    MEM_HASH_BUCKETS,
+    MEM_PARAMETERS,
+    NUM_MEM_CATEGORIES
+} MemCategory;
+
+/**
+ * @note MemCounter holds the live and high water mark object counts and bytes for a single MemCategory
+*/
+typedef struct {
+    long long count;
+    long long bytes;
+    long long peakCount;
+    long long peakBytes;
+} MemCounter;
+
+/**
+ * @note MemStats is a snapshot of all counters
+ * @param categories one MemCounter per MemCategory
+ * @param totalBytes live bytes across all categories
+ * @param peakTotalBytes high water mark of totalBytes
+*/
+typedef struct {
+    MemCounter categories[NUM_MEM_CATEGORIES];
+    long long totalBytes;
+    long long peakTotalBytes;
+} MemStats;
+
+// accounting hooks
+void memTrackAlloc(MemCategory category, long long count, size_t bytes);
+void memTrackFree(MemCategory category, long long count, size_t bytes);
+void memTrackTransfer(MemCategory from, MemCategory to, long long count, size_t bytes);
+
+// queries
+void getMemStats(MemStats* stats);
+void resetMemPeaks(void);
+void printMemStats(void);
@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 #include "value.h"
 #include "graphStack.h"
 
@@ -36,11 +37,22 @@ typedef struct {
 
     // stack of the computational graph build up from applying operations from autoGrad.c
     GraphStack* graphStack;
+
+    // input vector reused by ForwardRow(), its Values are fresh per call and owned by the graph stack
+    Value** inputRow;
+
+    // gradient checkpointing state (see gradCheckpoint.c). Disabled when checkpointInterval is 0
+    int checkpointInterval;
+    int numSegments;
+    Value*** segmentInputs;
+    GraphStack* checkpointStack;
 }MLP;
 
 
 // mlp functions
+Layer* newLayerInit(int inputSize, int outputSize, int scheme, uint64_t seed, uint64_t stream);
 Layer* newLayer(int inputSize, int outputSize);
 void freeLayer(Layer** layer);
+MLP* newMLPInit(int inputSize, int layerSizes[], int numLayers, int scheme, uint64_t seed);
 MLP* newMLP(int inputSize, int layerSizes[], int numLayers);
 void freeMLP(MLP** mlp);
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include "mlp.h"
+
+// modelFile.h
+
+/**
+ * @note modelFile.h contains the binary checkpoint format of MLP parameters. A file is a 64 byte ModelHeader, a table 
+ * with one ModelLayerInfo per layer, then one contiguous blob per layer holding its row major outputSize x inputSize 
+ * weight matrix followed by its outputSize biases. Every blob starts on a 64 byte boundary so it can be used in place 
+ * once the file is mapped into memory.
+ * @dev parameters are stored as float64, the type of Value::value, so a save/load round trip is bit exact
+ * @dev the checksum covers every parameter in file order and is verified by loadMLP()
+*/
+
+#define MODEL_MAGIC "NNCM"
+#define MODEL_VERSION 1
+#define MODEL_ALIGNMENT 64
+
+// parameter storage types
+#define MODEL_DTYPE_FLOAT64 0
+
+// activations applied after a layer's affine map
+#define MODEL_ACTIVATION_RELU 0
+
+// parameters staged per read/write call
+#define MODEL_IO_CHUNK_VALUES (1 << 17)
+
+// initial state of checksumParams(), the FNV-1a 64 bit offset basis
+#define MODEL_CHECKSUM_SEED 0xcbf29ce484222325ULL
+
+/**
+ * @note ModelHeader is the fixed size header at the start of a model file
+ * @param numParams total number of weights and biases
+ * @param layersOffset byte offset of the numLayers ModelLayerInfo entries
+ * @param paramsOffset byte offset of the first layer's blob
+ * @param checksum checksumParams() of every parameter in file order
+*/
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t numLayers;
+    uint32_t inputSize;
+    uint32_t dtype;
+    uint32_t reserved0;
+    uint64_t numParams;
+    uint64_t layersOffset;
+    uint64_t paramsOffset;
+    uint64_t checksum;
+    uint8_t reserved[8];
+} ModelHeader;
+
+/**
+ * @note ModelLayerInfo describes one layer of a model file, its input size is the output size of the previous layer
+ * @param offset byte offset of the layer's weights, its biases follow directly
+*/
+typedef struct {
+    uint32_t outputSize;
+    uint32_t activation;
+    uint64_t offset;
+} ModelLayerInfo;
+
+// model file functions
+void initModelHeader(ModelHeader* header, ModelLayerInfo* layers, int inputSize, const int* layerSizes, int numLayers);
+int validateModelHeader(const ModelHeader* header, uint64_t fileSize);
+int validateModelLayers(const ModelHeader* header, const ModelLayerInfo* layers, uint64_t fileSize);
+uint64_t checksumParams(uint64_t hash, const double* params, size_t count);
+int saveMLP(MLP* mlp, const char* path);
+MLP* loadMLP(const char* path);
+MLP* readMLP(FILE* file, uint64_t base, uint64_t size, const char* path);
@@ -0,0 +1,52 @@
+#pragma once
+
+// profile.h
+
+/**
+ * @note profile.h contains a lightweight timing layer for the phases of a training step. Timings are taken with a 
+ * monotonic clock and accumulated until printProfileReport() is called, typically once per epoch.
+ * @dev the PROFILE_* macros compile to nothing unless the library is built with -DNNC_PROFILE (make PROFILE=1), 
+ * so instrumented call sites cost nothing in normal builds.
+*/
+
+/**
+ * @note ProfilePhase identifies a timed phase of a training step
+*/
+typedef enum {
+    PHASE_FORWARD,
+    PHASE_LOSS,
+    PHASE_SORT,
+    PHASE_SWEEP,
+    PHASE_RECOMPUTE,
+    PHASE_STEP,
+    PHASE_ZERO_GRAD,
+    NUM_PROFILE_PHASES
+} ProfilePhase;
+
+// profiling functions
+long long profileNow(void);
+void profileRecord(ProfilePhase phase, long long elapsedNs);
+void profileOpen(ProfilePhase phase);
+void profileClose(ProfilePhase phase);
+void profileAddExamples(long long numExamples);
+void profileAddNodes(long long numNodes);
+void printProfileReport(int epoch);
+void resetProfile(void);
+
+#ifdef NNC_PROFILE
+#define PROFILE_BEGIN(phase) long long profileStart_##phase = profileNow()
+#define PROFILE_END(phase) profileRecord(phase, profileNow() - profileStart_##phase)
+#define PROFILE_OPEN(phase) profileOpen(phase)
+#define PROFILE_CLOSE(phase) profileClose(phase)
+#define PROFILE_EXAMPLES(n) profileAddExamples(n)
+#define PROFILE_NODES(n) profileAddNodes(n)
+#define PROFILE_EPOCH_REPORT(epoch) do { printProfileReport(epoch); resetProfile(); } while (0)
+#else
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+#define PROFILE_OPEN(phase) ((void)0)
+#define PROFILE_CLOSE(phase) ((void)0)
+#define PROFILE_EXAMPLES(n) ((void)0)
+#define PROFILE_NODES(n) ((void)0)
+#define PROFILE_EPOCH_REPORT(epoch) ((void)0)
+#endif
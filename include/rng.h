@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+// rng.h
+
+/**
+ * @note Rng is the state of a xoshiro256** pseudo random number generator. Unlike rand(), the state is explicit, so 
+ * streams are reproducible from a seed, can be saved/restored and are safe to use from one thread each.
+*/
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+// rng functions
+void seedRng(Rng* rng, uint64_t seed);
+void seedRngStream(Rng* rng, uint64_t seed, uint64_t stream);
+uint64_t rngNext(Rng* rng);
+double rngUniform(Rng* rng);
+uint64_t rngBelow(Rng* rng, uint64_t n);
+double rngNormal(Rng* rng);
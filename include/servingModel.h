@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "mlp.h"
+#include "inference.h"
+
+// servingModel.h
+
+/**
+ * @note servingModel.h contains lock free publishing of model snapshots from a training thread to inference threads. 
+ * Every publish snapshots the MLP into a new immutable, versioned InferenceModel and swaps it in with one atomic 
+ * exchange, so readers never block and never see a partially written model.
+ * @dev old snapshots are reclaimed with epoch based reclamation. A reader announces the global epoch in its own slot 
+ * before loading the current snapshot and clears the slot once done. A snapshot swapped out at epoch e is freed once 
+ * every announced epoch is past e, since readers announcing later can only load a newer snapshot.
+ * @dev at most SERVING_MAX_READERS readers are registered at a time. unregisterServingReader() frees a slot for the 
+ * next registerServingReader(), so threads may come and go for the life of the process.
+*/
+
+#define SERVING_MAX_READERS 64
+
+// reader slot value of a reader holding no snapshot
+#define SERVING_QUIESCENT 0
+
+/**
+ * @note ModelSnapshot is one published version of a model
+ * @param retireEpoch global epoch at which the snapshot was swapped out
+ * @param next next snapshot on the retired list
+*/
+typedef struct _modelSnapshot {
+    InferenceModel* model;
+    uint64_t version;
+    uint64_t retireEpoch;
+    struct _modelSnapshot* next;
+} ModelSnapshot;
+
+/**
+ * @note ReaderSlot is the epoch announced by one reader thread, padded to a cache line so readers do not share lines
+ * @param registered 1 while a reader owns the slot, claimed by registerServingReader()
+*/
+typedef struct {
+    _Atomic uint64_t epoch;
+    _Atomic int registered;
+    char pad[52];
+} ReaderSlot;
+
+/**
+ * @note ServingModel is the currently published snapshot, the reader slots and the snapshots waiting to be reclaimed
+ * @dev readers touch only current, epoch and their own slot. Publishing and reclaiming are serialized by publishLock, 
+ * which readers never take.
+ * @param epoch global epoch, starts at 1 and is advanced by every publish
+ * @param readers SERVING_MAX_READERS slots, handed out by registerServingReader() and freed by unregisterServingReader()
+ * @param numReaders number of registered readers
+ * @param retired snapshots swapped out but possibly still held by a reader, newest first
+*/
+typedef struct {
+    _Atomic(ModelSnapshot*) current;
+    _Atomic uint64_t epoch;
+    ReaderSlot* readers;
+    _Atomic int numReaders;
+
+    pthread_mutex_t publishLock;
+    uint64_t version;
+    ModelSnapshot* retired;
+    int numRetired;
+} ServingModel;
+
+// serving model functions
+ServingModel* newServingModel(MLP* mlp);
+void freeServingModel(ServingModel** serving);
+uint64_t publishModel(ServingModel* serving, MLP* mlp);
+int reclaimSnapshots(ServingModel* serving);
+int registerServingReader(ServingModel* serving);
+void unregisterServingReader(ServingModel* serving, int reader);
+ModelSnapshot* acquireSnapshot(ServingModel* serving, int reader);
+void releaseSnapshot(ServingModel* serving, int reader);
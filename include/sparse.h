@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include "value.h"
+#include "mlp.h"
+
+// sparse.h
+
+/**
+ * @note sparse.h contains sparse input batches in compressed sparse row (CSR) form and the first layer kernels that
+ * consume them. For high dimensional inputs that are mostly zeros, the forward pass of the first layer, its backward
+ * pass and its weight updates then only touch the weight columns of nonzero features.
+*/
+
+/**
+ * @note SparseBatch is a numRows x numCols matrix in CSR form. The nonzeros of row r are colIdx/values at
+ * [rowPtr[r], rowPtr[r + 1]), with column indices ascending within a row.
+ * @param capacity number of nonzeros colIdx and values have room for
+*/
+typedef struct {
+    int numRows;
+    int numCols;
+    int64_t* rowPtr;
+    int32_t* colIdx;
+    float* values;
+    int64_t nnz;
+    int64_t capacity;
+} SparseBatch;
+
+// csr functions
+SparseBatch* newSparseBatch(int numRows, int numCols, int64_t capacity);
+void freeSparseBatch(SparseBatch** batch);
+void denseToSparse(SparseBatch* batch, const float* features, int numRows);
+int rowNonzeros(SparseBatch* batch, int row);
+
+// sparse first layer functions
+Value** MultiplyWeightsSparse(Layer* layer, const int32_t* cols, Value** input, int nnz, GraphStack* graphStack);
+Value** ForwardSparseRow(MLP* mlp, SparseBatch* batch, int row);
+void StepSparse(MLP* mlp, double lr, const int32_t* cols, int nnz);
+void ZeroGradSparse(MLP* mlp, const int32_t* cols, int nnz);
@@ -0,0 +1,89 @@
+#pragma once
+#include <stdint.h>
+#include <pthread.h>
+#include "mlp.h"
+#include "inference.h"
+#include "dataLoader.h"
+
+// trainCheckpoint.h
+
+/**
+ * @note trainCheckpoint.h contains resumable training checkpoints. A checkpoint holds everything a training loop needs 
+ * to continue bit identically after being restarted: the parameters, the step counter, the learning rate and optimizer, 
+ * and the seed and position of the DataLoader, whose per epoch Rng streams are recreated from them.
+ * @dev a file is a 64 byte TrainHeader followed by a complete model file image (modelFile.h), so the parameters are 
+ * read back with the model file code and keep their alignment
+ * @dev checkpoints are written to a temporary file that is synced to disk and renamed over the target once complete, 
+ * so a crash or power loss while writing leaves the previous checkpoint intact
+*/
+
+#define TRAIN_MAGIC "NNCT"
+#define TRAIN_VERSION 1
+
+// optimizers, plain SGD keeps no state beyond the parameters
+#define TRAIN_OPTIMIZER_SGD 0
+
+/**
+ * @note TrainState is the training loop state saved alongside the parameters
+ * @param step number of optimizer steps taken
+ * @param lr the learning rate
+ * @param optimizer TRAIN_OPTIMIZER_SGD
+ * @param loaderSeed the seed the DataLoader was created with
+ * @param position getLoaderPosition() of the DataLoader at the time of the checkpoint
+*/
+typedef struct {
+    uint64_t step;
+    double lr;
+    int optimizer;
+    uint64_t loaderSeed;
+    LoaderPosition position;
+} TrainState;
+
+/**
+ * @note TrainHeader is the fixed size header at the start of a training checkpoint
+ * @param modelOffset byte offset of the model file image
+ * @param modelBytes size of the model file image
+*/
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t step;
+    double lr;
+    uint32_t optimizer;
+    int32_t epoch;
+    int64_t batch;
+    uint64_t loaderSeed;
+    uint64_t modelOffset;
+    uint64_t modelBytes;
+} TrainHeader;
+
+/**
+ * @note CheckpointWriter is a background thread that writes training checkpoints from parameter snapshots, so the 
+ * training loop only pays for copying the parameters
+ * @dev at most one checkpoint is in flight. The snapshot, header and path of a pending request are handed over under 
+ * lock, and done is signaled on cond once it has been written.
+ * @param status 1 if the last checkpoint was written, 0 if writing it failed
+ * @param numWritten number of checkpoints completed, successfully or not
+*/
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    InferenceModel* snapshot;
+    TrainHeader header;
+    char* path;
+
+    int pending;
+    int stop;
+    int status;
+    uint64_t numWritten;
+} CheckpointWriter;
+
+// training checkpoint functions
+int saveTrainCheckpoint(MLP* mlp, const TrainState* state, const char* path);
+MLP* loadTrainCheckpoint(const char* path, TrainState* state);
+CheckpointWriter* newCheckpointWriter(void);
+void saveTrainCheckpointAsync(CheckpointWriter* writer, MLP* mlp, const TrainState* state, const char* path);
+int waitCheckpointWriter(CheckpointWriter* writer);
+void freeCheckpointWriter(CheckpointWriter** writer);
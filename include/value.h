@@ -21,10 +21,11 @@ typedef void (*pBackwardFunc_Singluar)(Value*);
  * are not directly accessible via the loss output's ancestors)
  * @param Value* the output of categoricalCrossEntropy()
  * @param double* an array of softmax probabilities
- * @param Value** array Value struct ptrs of target class labels 
- * @param int length of the above two arrays
+ * @param Value** array Value struct ptrs of target class labels (one hot), NULL for index based losses
+ * @param int index of the target class for index based losses, NO_LABEL otherwise
+ * @param int length of the softmax/target arrays
 */
-typedef void (*pBackwardFunc_Loss)(Value*, double*, Value**, int);
+typedef void (*pBackwardFunc_Loss)(Value*, double*, Value**, int, int);
 
 
 
@@ -39,6 +40,8 @@ typedef void (*pBackwardFunc_Loss)(Value*, double*, Value**, int);
  * @param ancestors arr of ancestor nodes (dynamically allocated) 
  * @param op String indicating the operation that produced the value (debugging)
  * @param ancestorArrLen length of the ancestors array
+ * @param requiresGrad REQUIRES_GRAD for parameters and anything computed from them, NO_GRAD for constants (data inputs,
+ * targets). Backward() neither visits nor accumulates gradient into constants.
 */
 typedef struct _value {
     double value;             
@@ -48,4 +51,5 @@ typedef struct _value {
     Value** ancestors;
     char* opString; 
     int ancestorArrLen;        
+    int requiresGrad;
 } Value;
\ No newline at end of file
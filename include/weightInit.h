@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// weightInit.h
+
+/**
+ * @note weightInit.h contains initializers that fill contiguous arrays of parameters from xoshiro256** streams (rng.h)
+ * instead of calling the global rand() once per value
+ * @dev an array is split into blocks of INIT_BLOCK_VALUES values. Every block draws from INIT_LANES streams of its own
+ * derived from (seed, stream, block) alone, so blocks can be filled by any number of threads in any order and the
+ * array is identical regardless of the thread count.
+ * @dev the lanes of a block are stored structure of arrays and advanced in lockstep, so the generator loop has no
+ * dependency between lanes and the compiler can vectorize it
+*/
+
+#define INIT_UNIFORM 0
+#define INIT_XAVIER 1
+#define INIT_HE 2
+
+// parameters left at zero for the caller to fill, ie: readMLP()
+#define INIT_NONE 3
+
+#define INIT_BLOCK_VALUES 4096
+#define INIT_LANES 4
+#define INIT_AUTO_THREADS 0
+
+/**
+ * @note InitLanes is the state of the INIT_LANES xoshiro256** streams of one block, word j of lane k in s[j][k]
+*/
+typedef struct {
+    uint64_t s[4][INIT_LANES];
+} InitLanes;
+
+/**
+ * @note InitJob is an array being initialized and the next block to hand to a thread
+ * @param arraySeed seed of the array, derived from (seed, stream)
+ * @param scale bound of the uniform schemes or standard deviation of INIT_HE
+*/
+typedef struct {
+    double* values;
+    size_t count;
+    int scheme;
+    double scale;
+    uint64_t arraySeed;
+    _Atomic uint64_t nextBlock;
+    uint64_t numBlocks;
+} InitJob;
+
+// weight init functions
+double initScale(int scheme, int fanIn, int fanOut);
+void initWeights(double* values, size_t count, int scheme, int fanIn, int fanOut, uint64_t seed, uint64_t stream, int numThreads);
@@ -16,7 +16,7 @@ echo
 echo "Running All Tests..."
 
 # Define your test binaries here
-tests=("test_autoGrad" "test_graphStack" "test_hashTable" "test_mlp" "test_forward" "test_gradientDescent" "test_loss")
+tests=("test_autoGrad" "test_graphStack" "test_hashTable" "test_mlp" "test_forward" "test_gradientDescent" "test_loss" "test_gradCheckpoint" "test_memStats" "test_rng" "test_dataset" "test_csvLoader" "test_dataLoader" "test_sparse" "test_modelFile" "test_inference" "test_trainCheckpoint" "test_inferencePool" "test_batchQueue" "test_servingModel" "test_latencyHistogram" "test_weightInit" "test_nncScore")
 
 # Directory where binaries are located
 BIN_DIR="bin"
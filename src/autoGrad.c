@@ -13,6 +13,7 @@
  * @param ancestorsArrLen The integer number of ancestors in the array
  * @param opString A string identifying the operation that created this node
  * @return A ptr to the newly created Value struct.
+ * @dev the Value requires grad, use newConstant() for data that should be excluded from backpropagation
 */
 Value* newValue(double value, Value* ancestors[], int ancestorArrLen, char opString[]){
 
@@ -24,6 +25,7 @@ Value* newValue(double value, Value* ancestors[], int ancestorArrLen, char opStr
     v->value = value;
     v->grad = 0;
     v->ancestorArrLen = ancestorArrLen;
+    v->requiresGrad = REQUIRES_GRAD;
 
     // New Node (not created from an operation)
     if (ancestorArrLen == NO_ANCESTORS && ancestors == NULL){
@@ -56,9 +58,46 @@ Value* newValue(double value, Value* ancestors[], int ancestorArrLen, char opStr
     assert(v->opString != NULL);
     strcpy(v->opString, opString);
 
+    memTrackAlloc(MEM_VALUES, 1, valueBytes(v));
+
+    return v;
+}
+
+/**
+ * @note newConstant() creates a leaf Value that does not require grad, ie: an input feature or a target. Constants are 
+ * skipped by Backward(), and operations whose operands are all constants fold into new constants instead of recording 
+ * graph edges.
+ * @param value double to set the value of the Value struct to
+ * @param opString A string identifying the Value
+*/
+Value* newConstant(double value, char opString[]){
+
+    Value* v = newValue(value, NULL, NO_ANCESTORS, opString);
+    v->requiresGrad = NO_GRAD;
+
     return v;
 }
 
+/**
+ * @note valueBytes() returns the number of heap bytes held by a Value struct, including its ancestors array and 
+ * operation string
+ * @param v ptr to the Value struct
+*/
+size_t valueBytes(Value* v){
+    assert(v != NULL);
+
+    size_t bytes = sizeof(Value);
+
+    if (v->ancestors != NULL){
+        bytes += v->ancestorArrLen * sizeof(Value*);
+    }
+    if (v->opString != NULL){
+        bytes += strlen(v->opString) + 1;
+    }
+
+    return bytes;
+}
+
 //---------------------------------------------------------------------------------------------------------------------- Value Destructor
 
 /**
@@ -70,6 +109,8 @@ void freeValue(Value** v){
    
     assert((*v) != NULL);
 
+    memTrackFree(MEM_VALUES, 1, valueBytes(*v));
+
     // free dynamically allocated members first
     if ((*v)->ancestors != NULL){
 
@@ -105,7 +146,7 @@ void addBackward(Value* v){
     // Propagate the gradient to both ancestors. Since the grad is 0 in both cases, applying 
     // the chain rule backwards just means adding the gradient if v to its ancestors
     for(int i = 0; i<2; i++){
-        if (v->ancestors[i] != NULL){
+        if (v->ancestors[i] != NULL && v->ancestors[i]->requiresGrad){
             v->ancestors[i]->grad += v->grad;
         }
     }
@@ -116,6 +157,7 @@ void addBackward(Value* v){
  * @dev the Backward function ptr of the resulting Value is also set to addBackward()
  * @dev any Value() structs that are created from Add() are considered to be part of the computational graph and are 
  * therefore pushed to a graphStack for later deallocation.
+ * @dev the sum of two constants is a constant with no ancestors
  * @param a A pointer to a Value Struct
  * @param b A pointer to a Value Struct
  * @param graphStack A pointer to a GraphStack struct 
@@ -125,6 +167,14 @@ Value* Add(Value* a, Value* b, GraphStack* graphStack){
     assert(a != NULL && b != NULL);
     assert(graphStack != NULL);
 
+    // constants fold, no edges are recorded
+    if (!a->requiresGrad && !b->requiresGrad){
+
+        Value* sumValue = newConstant(a->value + b->value, "add");
+        pushGraphStack(graphStack, sumValue);
+        return sumValue;
+    }
+
     // Create new Value for the sum
     Value* sumValue = newValue(a->value + b->value, (Value*[]){a, b}, 2, "add");
 
@@ -158,8 +208,14 @@ void mulBackward(Value* v) {
     // Apply the chain rule for multivariate multiplication: dz/dx = y * dz and dz/dy = x * dz
     Value* x = v->ancestors[0];
     Value* y = v->ancestors[1];
-    x->grad += y->value * v->grad; // dz/dx = y
-    y->grad += x->value * v->grad; // dz/dy = x
+
+    // no accumulation into constants, ie: the input features of a dot product
+    if (x->requiresGrad){
+        x->grad += y->value * v->grad; // dz/dx = y
+    }
+    if (y->requiresGrad){
+        y->grad += x->value * v->grad; // dz/dy = x
+    }
 }
 
 /**
@@ -167,6 +223,7 @@ void mulBackward(Value* v) {
  * @dev the Backward function ptr of the resulting Value is also set to mulBackward()
  * @dev any Value() structs that are created from Mul() are considered to be part of the computational graph and are 
  * therefore pushed to a graphStack for later deallocation.
+ * @dev the product of two constants is a constant with no ancestors
  * @param a A pointer to a Value Struct
  * @param b A pointer to a Value Struct
  * @param graphStack A pointer to a GraphStack struct 
@@ -175,6 +232,14 @@ Value* Mul(Value* a, Value* b, GraphStack* graphStack) {
     assert(a != NULL && b != NULL);
     assert(graphStack != NULL);
 
+    // constants fold, no edges are recorded
+    if (!a->requiresGrad && !b->requiresGrad){
+
+        Value* productValue = newConstant(a->value * b->value, "mul");
+        pushGraphStack(graphStack, productValue);
+        return productValue;
+    }
+
     // Create a new Value for the product
     Value* productValue = newValue(a->value * b->value, (Value*[]){a, b}, 2, "mul");
 
@@ -202,7 +267,7 @@ void reluBackward(Value* v){
     assert(v->ancestorArrLen == 1);
     assert(v->ancestors[0] != NULL);
 
-    if (v->ancestors[0]->value > 0){
+    if (v->ancestors[0]->value > 0 && v->ancestors[0]->requiresGrad){
             v->ancestors[0]->grad += v->grad; // dz/dx = 1 case
     }
     // @note dz/dx = 0 case is not handled here because the grad is already 0
@@ -213,6 +278,7 @@ void reluBackward(Value* v){
  * @dev the Backward function ptr of the resulting Value is also set to reluBackward()
  * @dev any Value() structs that are created from ReLU() are considered to be part of the computational graph and are 
  * therefore pushed to a graphStack for later deallocation.
+ * @dev ReLU() of a constant is a constant with no ancestors
  * @param a A pointer to a Value Struct
  * @param graphStack A pointer to a GraphStack struct 
 */
@@ -223,6 +289,15 @@ Value* ReLU(Value* a, GraphStack* graphStack) {
 
     // Create a new Value for the ReLU activation
     double reluResult = a->value > 0 ? a->value : 0; // f(x) = max(0, x)
+
+    // constants fold, no edges are recorded
+    if (!a->requiresGrad){
+
+        Value* reluValue = newConstant(reluResult, "relu");
+        pushGraphStack(graphStack, reluValue);
+        return reluValue;
+    }
+
     Value* reluValue = newValue(reluResult, (Value*[]){a}, 1, "relu");
 
     // push the new value onto the graph stack
@@ -242,6 +317,7 @@ Value* ReLU(Value* a, GraphStack* graphStack) {
  * @dev This algorithm works by recursively traversing the computational graph until the deepest point is reached. At 
  * that point, before the recursive calls return, they push the Value ptr at that point in the graph to a GraphStack 
  * @dev a HashTable is used to ensure that values are only pushed to the graphStack once, even if encountered twice 
+ * @dev constants are not visited, they have no ancestors and receive no gradient
  * @param value is a value ptr somewhere in the computational graph
  * @param visitedHashTable is a HashTable struct ptr created prior to this call
  * @param sortedStack is a GraphStack struct ptr that stores the linear ordering 
@@ -262,7 +338,7 @@ void depthFirstSearch(Value* value, HashTable* visitedHashTable, GraphStack* sor
     // Recursive call to visit all ancestors of current node
     for (int i = 0; i < value->ancestorArrLen; i++){
 
-        if (value->ancestors != NULL && value->ancestors[i] != NULL){
+        if (value->ancestors != NULL && value->ancestors[i] != NULL && value->ancestors[i]->requiresGrad){
             depthFirstSearch(value->ancestors[i], visitedHashTable, sortedStack);
         }
     }
@@ -288,9 +364,44 @@ void reverseTopologicalSort(Value* start, GraphStack** sortedStack){
 
     // kickstart recursive depth first search on graph
     depthFirstSearch(start, visitedHashTable, (*sortedStack));
+
+    freeHashTable(&visitedHashTable);
 }
 
 
+/**
+ * @note backpropagateSorted() sweeps a reverse topologically sorted GraphStack, calling the derivative function of 
+ * each node so that gradients flow from the outputs of the graph back to its leaves.
+ * @dev the grads of the graph outputs must be seeded before calling this function
+ * @param sortStack GraphStack produced by reverseTopologicalSort() or depthFirstSearch()
+ * @param softmaxOutput an array of doubles containing the outputs of softmax before application of loss 
+ * @param targetsArr array of Value struct ptrs containing one hot encoded target class labels
+ * @param label index of the target class for sparseCategoricalCrossEntropy(), NO_LABEL otherwise
+*/
+void backpropagateSorted(GraphStack* sortStack, double* softmaxOutput, Value** targetsArr, int label){
+    assert(sortStack != NULL);
+
+    // get head node
+    GraphNode* graphNode = sortStack->head;
+
+    // compute gradient of graph
+    while (graphNode != NULL && graphNode->pValStruct != NULL){        
+
+        // if loss output, use loss derivative function
+        if (graphNode->pValStruct->BackwardLoss != NULL){
+
+            graphNode->pValStruct->BackwardLoss(graphNode->pValStruct, softmaxOutput, targetsArr, label, graphNode->pValStruct->ancestorArrLen);
+        }
+        else if (graphNode->pValStruct->Backward != NULL){ // use standard derivative function 
+
+            graphNode->pValStruct->Backward(graphNode->pValStruct);
+        }
+
+        // get next
+        graphNode = graphNode->next;
+    }
+}
+
 /**
  * @note Backward() applies backpropagration of the gradient wrt to all ancestors in the computational graph
  * that produced the inputted value.
@@ -302,45 +413,80 @@ void reverseTopologicalSort(Value* start, GraphStack** sortedStack){
  * @param targetsArr array of Value struct ptrs containing one hot encoded target class labels
 */
 void Backward(Value* value, double* softmaxOutput, Value** targetsArr){
+    backpropagateLoss(value, softmaxOutput, targetsArr, NO_LABEL);
+}
+
+/**
+ * @note BackwardSparse() is Backward() for a loss computed by sparseCategoricalCrossEntropy(), which takes the index
+ * of the target class instead of a one hot target vector
+ * @dev softmaxOutput array is freed at the end of BackwardSparse()
+ * @param value is the leading output of the computational graph to backpropogate
+ * @param softmaxOutput an array of doubles containing the outputs of softmax before application of loss 
+ * @param label index of the target class
+*/
+void BackwardSparse(Value* value, double* softmaxOutput, int label){
+    backpropagateLoss(value, softmaxOutput, NULL, label);
+}
+
+/**
+ * @note backpropagateLoss() sorts the graph behind a scalar output, seeds it with a grad of 1 and sweeps it, passing 
+ * the loss targets through to the loss derivative function. Shared by Backward() and BackwardSparse().
+*/
+void backpropagateLoss(Value* value, double* softmaxOutput, Value** targetsArr, int label){
     assert(value != NULL);
 
+    PROFILE_BEGIN(PHASE_SORT);
+
     // create a new GraphStack to store the reverse topologically sorted graph
     GraphStack* sortStack = newGraphStack();
 
     // perform reverse topological sort on graph
     reverseTopologicalSort(value, &sortStack);
 
+    PROFILE_END(PHASE_SORT);
+    PROFILE_BEGIN(PHASE_SWEEP);
+
     // grad must be 1 to kickstart backprop
     value->grad = 1.0;
 
-    // get head node
-    GraphNode* graphNode = sortStack->head;
-
     // compute gradient of graph
-    while (graphNode != NULL && graphNode->pValStruct != NULL){        
+    backpropagateSorted(sortStack, softmaxOutput, targetsArr, label);
+    PROFILE_NODES(sortStack->len - 1);
 
-        // compute partial derivative of next node
-        if (graphNode->pValStruct->Backward != NULL){
-            
-            // if loss output, use loss derivative function
-            if (strcmp(graphNode->pValStruct->opString, "loss") == 0){
+    // free memory
+    graphPreservingStackRelease(&sortStack);
+    freeSoftmax(&softmaxOutput);
 
-                graphNode->pValStruct->BackwardLoss(graphNode->pValStruct, softmaxOutput, targetsArr, graphNode->pValStruct->ancestorArrLen);
-            }
-            else{ // use standard derivative function 
+    PROFILE_END(PHASE_SWEEP);
+}   
 
-                graphNode->pValStruct->Backward(graphNode->pValStruct);
-            }
-        }
+/**
+ * @note backwardFromSeeds() backpropagates from several outputs at once whose grads have already been seeded by the 
+ * caller (as opposed to Backward(), which seeds a single scalar output with a grad of 1).
+ * @dev used by gradient checkpointing to push the grads held by a segment boundary back through a recomputed segment
+ * @dev a single visited HashTable is shared across the depth first searches of every output, so nodes reachable 
+ * from more than one output are only swept once. The combined post order is still a valid reverse topological order.
+ * @param outputs array of Value struct ptrs with seeded grads
+ * @param numOutputs length of the outputs array
+*/
+void backwardFromSeeds(Value** outputs, int numOutputs){
+    assert(outputs != NULL);
 
-        // get next
-        graphNode = graphNode->next;
+    GraphStack* sortStack = newGraphStack();
+    HashTable* visitedHashTable = newHashTable(HASHTABLE_SIZE);
+
+    // sort the union of the graphs behind each output
+    for (int i=0; i<numOutputs; i++){
+        depthFirstSearch(outputs[i], visitedHashTable, sortStack);
     }
 
+    // compute gradient of graph
+    backpropagateSorted(sortStack, NULL, NULL, NO_LABEL);
+
     // free memory
+    freeHashTable(&visitedHashTable);
     graphPreservingStackRelease(&sortStack);
-    freeSoftmax(&softmaxOutput);
-}   
+}
 
 //---------------------------------------------------------------------------------------------------------------------- Zero Gradients
 
@@ -351,6 +497,8 @@ void Backward(Value* value, double* softmaxOutput, Value** targetsArr){
 */
 void ZeroGrad(MLP* mlp){
 
+    PROFILE_BEGIN(PHASE_ZERO_GRAD);
+
     // retrieve first layer
     Layer* layer = mlp->inputLayer;
 
@@ -373,4 +521,9 @@ void ZeroGrad(MLP* mlp){
 
     // release computional graph
     releaseGraph(mlp->graphStack);
+
+    // release segment boundaries kept by gradient checkpointing
+    releaseCheckpoints(mlp);
+
+    PROFILE_END(PHASE_ZERO_GRAD);
 }
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "lib.h"
+
+// batchQueue.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Dispatcher
+
+/**
+ * @note completeBatch() completes the future of every row of a predicted batch and empties it
+*/
+void completeBatch(BatchQueue* queue, QueueBatch* batch){
+
+    int outputSize = queue->model->outputSize;
+
+    for (int i=0; i<batch->numRows; i++){
+
+        PredictFuture* future = batch->futures[i];
+
+        pthread_mutex_lock(&future->lock);
+
+        future->label = batch->labels[i];
+        if (future->probs != NULL){
+            memcpy(future->probs, batch->probs + (size_t)i * outputSize, sizeof(double) * outputSize);
+        }
+        future->done = 1;
+        pthread_cond_signal(&future->cond);
+
+        // the client may free the future as soon as the lock is released
+        pthread_mutex_unlock(&future->lock);
+    }
+
+    batch->numRows = 0;
+    batch->wantProbs = 0;
+}
+
+/**
+ * @note recordQueueLatencies() records the latency of every request of a predicted batch, queue lock held
+*/
+void recordQueueLatencies(BatchQueue* queue, QueueBatch* batch, long long completedNs){
+
+    for (int i=0; i<batch->numRows; i++){
+        recordLatency(&queue->latencies, completedNs - batch->submitNs[i]);
+    }
+}
+
+/**
+ * @note dispatcherThread() is the pthread body of a BatchQueue. It waits for a batch to fill up or reach its deadline,
+ * swaps it for the empty one and predicts it outside the lock.
+*/
+void* dispatcherThread(void* arg){
+
+    BatchQueue* queue = (BatchQueue*)arg;
+
+    pthread_mutex_lock(&queue->lock);
+
+    while (1){
+
+        QueueBatch* batch = &queue->batches[queue->filling];
+
+        while (batch->numRows == 0 && !queue->stop){
+            pthread_cond_wait(&queue->ready, &queue->lock);
+        }
+        if (batch->numRows == 0){
+            break;
+        }
+
+        // wait for more rows until the oldest one reaches its deadline, when stopping drain without waiting
+        long long deadline = batch->submitNs[0] + queue->maxWaitNs;
+        while (batch->numRows < queue->maxBatchRows && !queue->stop && profileNow() < deadline){
+
+            struct timespec ts = {deadline / 1000000000LL, deadline % 1000000000LL};
+            pthread_cond_timedwait(&queue->ready, &queue->lock, &ts);
+        }
+
+        queue->filling ^= 1;
+        queue->numBatches++;
+        queue->numRequests += batch->numRows;
+        pthread_cond_broadcast(&queue->space);
+
+        pthread_mutex_unlock(&queue->lock);
+        predictBatch(queue->pool, queue->model, batch->features, batch->numRows, batch->labels, batch->wantProbs ? batch->probs : NULL);
+        long long completedNs = profileNow();
+
+        // recorded before any future completes, so a client that got its result finds its latency recorded
+        pthread_mutex_lock(&queue->lock);
+        recordQueueLatencies(queue, batch, completedNs);
+        pthread_mutex_unlock(&queue->lock);
+
+        completeBatch(queue, batch);
+        pthread_mutex_lock(&queue->lock);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Clients
+
+/**
+ * @note submitPrediction() copies a row into the filling batch and returns without waiting for its prediction
+ * @dev blocks only while the filling batch is full
+ * @param queue the BatchQueue
+ * @param row model->inputSize features, copied
+ * @param probs where to write the softmax probabilities of the row once predicted, or NULL for the label only
+ * @param future initialized here, wait on it with waitPrediction() before reusing or freeing it
+*/
+void submitPrediction(BatchQueue* queue, const float* row, double* probs, PredictFuture* future){
+    assert(queue != NULL && row != NULL && future != NULL);
+
+    pthread_mutex_init(&future->lock, NULL);
+    pthread_cond_init(&future->cond, NULL);
+    future->done = 0;
+    future->label = -1;
+    future->probs = probs;
+
+    int inputSize = queue->model->inputSize;
+    long long submitNs = profileNow();
+
+    pthread_mutex_lock(&queue->lock);
+
+    assert(!queue->stop);
+    while (queue->batches[queue->filling].numRows == queue->maxBatchRows){
+        pthread_cond_wait(&queue->space, &queue->lock);
+    }
+
+    QueueBatch* batch = &queue->batches[queue->filling];
+    int index = batch->numRows++;
+
+    memcpy(batch->features + (size_t)index * inputSize, row, sizeof(float) * inputSize);
+    batch->futures[index] = future;
+    batch->submitNs[index] = submitNs;
+    batch->wantProbs |= probs != NULL;
+
+    if (index == 0 || batch->numRows == queue->maxBatchRows){
+        pthread_cond_signal(&queue->ready);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @note waitPrediction() blocks until a submitted row has been predicted
+ * @return the argmax class of the row
+*/
+int32_t waitPrediction(PredictFuture* future){
+    assert(future != NULL);
+
+    pthread_mutex_lock(&future->lock);
+
+    while (!future->done){
+        pthread_cond_wait(&future->cond, &future->lock);
+    }
+
+    pthread_mutex_unlock(&future->lock);
+
+    pthread_mutex_destroy(&future->lock);
+    pthread_cond_destroy(&future->cond);
+
+    return future->label;
+}
+
+/**
+ * @note predictQueued() submits a row and waits for its prediction
+ * @return the argmax class of the row
+*/
+int32_t predictQueued(BatchQueue* queue, const float* row, double* probs){
+
+    PredictFuture future;
+    submitPrediction(queue, row, probs, &future);
+    return waitPrediction(&future);
+}
+
+/**
+ * @note getQueueLatencies() copies the latencies of every request completed so far
+ * @param latencies where to copy the histogram to
+*/
+void getQueueLatencies(BatchQueue* queue, LatencyHistogram* latencies){
+    assert(queue != NULL && latencies != NULL);
+
+    pthread_mutex_lock(&queue->lock);
+    memcpy(latencies, &queue->latencies, sizeof(LatencyHistogram));
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Constructor/Destructor
+
+/**
+ * @note newBatchQueue() allocates the batch buffers of a BatchQueue and starts its dispatcher
+ * @param pool the InferencePool predicting the batches, not used by anything else while the queue exists
+ * @param model the InferenceModel
+ * @param maxBatchRows rows at which a batch is dispatched without waiting
+ * @param maxWaitNs longest a row waits for its batch to fill up, 0 dispatches whatever has arrived
+*/
+BatchQueue* newBatchQueue(InferencePool* pool, InferenceModel* model, int maxBatchRows, long long maxWaitNs){
+    assert(pool != NULL && model != NULL && maxBatchRows > 0 && maxWaitNs >= 0);
+
+    BatchQueue* queue = (BatchQueue*)calloc(1, sizeof(BatchQueue));
+    assert(queue != NULL);
+
+    queue->pool = pool;
+    queue->model = model;
+    queue->maxBatchRows = maxBatchRows;
+    queue->maxWaitNs = maxWaitNs;
+
+    for (int i=0; i<2; i++){
+
+        QueueBatch* batch = &queue->batches[i];
+        batch->features = (float*)malloc(sizeof(float) * maxBatchRows * model->inputSize);
+        batch->labels = (int32_t*)malloc(sizeof(int32_t) * maxBatchRows);
+        batch->probs = (double*)malloc(sizeof(double) * maxBatchRows * model->outputSize);
+        batch->futures = (PredictFuture**)malloc(sizeof(PredictFuture*) * maxBatchRows);
+        batch->submitNs = (long long*)malloc(sizeof(long long) * maxBatchRows);
+        assert(batch->features != NULL && batch->labels != NULL && batch->probs != NULL && batch->futures != NULL);
+        assert(batch->submitNs != NULL);
+    }
+
+    resetLatencyHistogram(&queue->latencies);
+
+    // deadlines are on the monotonic clock of profileNow()
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue->ready, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->space, NULL);
+
+    int status = pthread_create(&queue->dispatcher, NULL, dispatcherThread, queue);
+    assert(status == 0);
+
+    return queue;
+}
+
+/**
+ * @note freeBatchQueue() predicts every row still queued, stops the dispatcher and frees the queue
+ * @dev no row may be submitted once freeing has started
+ * @param queue ptr to a BatchQueue ptr, set to NULL
+*/
+void freeBatchQueue(BatchQueue** queue){
+    assert(queue != NULL && *queue != NULL);
+
+    pthread_mutex_lock(&(*queue)->lock);
+    (*queue)->stop = 1;
+    pthread_cond_signal(&(*queue)->ready);
+    pthread_mutex_unlock(&(*queue)->lock);
+
+    pthread_join((*queue)->dispatcher, NULL);
+
+    for (int i=0; i<2; i++){
+
+        free((*queue)->batches[i].features);
+        free((*queue)->batches[i].labels);
+        free((*queue)->batches[i].probs);
+        free((*queue)->batches[i].futures);
+        free((*queue)->batches[i].submitNs);
+    }
+
+    pthread_mutex_destroy(&(*queue)->lock);
+    pthread_cond_destroy(&(*queue)->ready);
+    pthread_cond_destroy(&(*queue)->space);
+
+    free(*queue);
+    *queue = NULL;
+}
@@ -0,0 +1,986 @@
+#include "lib.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// csvLoader.c
+
+// exact powers of 10 for parseDecimal()
+const double powersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// ---------------------------------------------------------------------------------------------------------------------- Label Dictionary
+
+/**
+ * @note hashLabel() hashes a label string of a given length with FNV-1a
+*/
+uint64_t hashLabel(const char* str, int len){
+
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (int i=0; i<len; i++){
+        hash = (hash ^ (unsigned char)str[i]) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @note initLabelDictionary() initializes an empty LabelDictionary
+*/
+void initLabelDictionary(LabelDictionary* dict){
+
+    dict->numLabels = 0;
+    dict->numSlots = 64;
+    dict->names = (char**)malloc(sizeof(char*) * dict->numSlots);
+    dict->slots = (int*)malloc(sizeof(int) * dict->numSlots);
+    assert(dict->names != NULL && dict->slots != NULL);
+
+    // -1 marks an empty slot
+    memset(dict->slots, 0xFF, sizeof(int) * dict->numSlots);
+}
+
+/**
+ * @note growLabelDictionary() doubles the number of slots and reinserts every label
+*/
+void growLabelDictionary(LabelDictionary* dict){
+
+    dict->numSlots *= 2;
+    dict->names = (char**)realloc(dict->names, sizeof(char*) * dict->numSlots);
+    dict->slots = (int*)realloc(dict->slots, sizeof(int) * dict->numSlots);
+    assert(dict->names != NULL && dict->slots != NULL);
+
+    memset(dict->slots, 0xFF, sizeof(int) * dict->numSlots);
+
+    for (int id=0; id<dict->numLabels; id++){
+
+        uint64_t slot = hashLabel(dict->names[id], strlen(dict->names[id])) % dict->numSlots;
+        while (dict->slots[slot] != -1){
+            slot = (slot + 1) % dict->numSlots;
+        }
+        dict->slots[slot] = id;
+    }
+}
+
+/**
+ * @note lookupLabel() returns the id of a label string, adding it to the dictionary if it has not been seen before
+ * @param dict the LabelDictionary
+ * @param str the label, not necessarily null terminated
+ * @param len length of the label
+*/
+int lookupLabel(LabelDictionary* dict, const char* str, int len){
+
+    uint64_t slot = hashLabel(str, len) % dict->numSlots;
+
+    // linear probe until the label or an empty slot is found
+    while (dict->slots[slot] != -1){
+
+        char* name = dict->names[dict->slots[slot]];
+        if ((int)strlen(name) == len && memcmp(name, str, len) == 0){
+            return dict->slots[slot];
+        }
+        slot = (slot + 1) % dict->numSlots;
+    }
+
+    // new label
+    int id = dict->numLabels++;
+    dict->names[id] = (char*)malloc(len + 1);
+    assert(dict->names[id] != NULL);
+    memcpy(dict->names[id], str, len);
+    dict->names[id][len] = '\0';
+    dict->slots[slot] = id;
+
+    // keep the load factor under 1/2
+    if (dict->numLabels * 2 > dict->numSlots){
+        growLabelDictionary(dict);
+    }
+
+    return id;
+}
+
+/**
+ * @note freeLabelDictionary() frees every label string and the dictionary arrays
+*/
+void freeLabelDictionary(LabelDictionary* dict){
+
+    for (int id=0; id<dict->numLabels; id++){
+        free(dict->names[id]);
+    }
+    free(dict->names);
+    free(dict->slots);
+
+    dict->names = NULL;
+    dict->slots = NULL;
+    dict->numLabels = 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Field Parsing
+
+/**
+ * @note trimField() shrinks [start, start + *len) to exclude surrounding whitespace and carriage returns
+ * @return the new start of the field
+*/
+const char* trimField(const char* start, int* len){
+
+    while (*len > 0 && (start[0] == ' ' || start[0] == '\t')){
+        start++, (*len)--;
+    }
+    while (*len > 0 && (start[*len - 1] == ' ' || start[*len - 1] == '\t' || start[*len - 1] == '\r')){
+        (*len)--;
+    }
+
+    return start;
+}
+
+/**
+ * @note parseDecimal() is a fast decimal to double parser used in place of strtod for CSV fields. Up to 19 significant
+ * digits are accumulated into an integer mantissa which is scaled by an exact power of 10, so common inputs (ie: 
+ * "-12.375", "4e1") are parsed exactly without locale handling or a null terminator.
+ * @dev inputs outside the fast path (more than 19 significant digits, large exponents) are scaled with pow(), inputs 
+ * that are not decimal numbers at all (ie: "nan", "inf") fall back to strtod on a bounded copy
+ * @param start first character of the number, leading blanks are skipped
+ * @param end end of the input, the parser never reads at or past it
+ * @param next set to the first character after the number, may be NULL
+*/
+double parseDecimal(const char* start, const char* end, const char** next){
+
+    const char* p = start;
+    while (p < end && (*p == ' ' || *p == '\t')){
+        p++;
+    }
+
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')){
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int numDigits = 0, sawDigit = 0, exponent = 0;
+
+    // integer part, digits past the 19th only scale the result
+    for (; p < end && (unsigned)(*p - '0') < 10; p++){
+
+        sawDigit = 1;
+        if (numDigits < 19){
+            mantissa = mantissa * 10 + (*p - '0');
+            numDigits += mantissa != 0;
+        }else{
+            exponent++;
+        }
+    }
+
+    // fraction
+    if (p < end && *p == '.'){
+        for (p++; p < end && (unsigned)(*p - '0') < 10; p++){
+
+            sawDigit = 1;
+            if (numDigits < 19){
+                mantissa = mantissa * 10 + (*p - '0');
+                numDigits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+
+    if (!sawDigit){
+
+        // not a decimal number
+        char field[64];
+        int len = end - start < (int)sizeof(field) - 1 ? end - start : (int)sizeof(field) - 1;
+        memcpy(field, start, len);
+        field[len] = '\0';
+
+        char* fieldEnd;
+        double result = strtod(field, &fieldEnd);
+        if (next != NULL){
+            *next = start + (fieldEnd - field);
+        }
+        return result;
+    }
+
+    // exponent
+    if (p < end && (*p == 'e' || *p == 'E')){
+
+        const char* e = p + 1;
+        int negativeExponent = 0;
+        if (e < end && (*e == '-' || *e == '+')){
+            negativeExponent = *e == '-';
+            e++;
+        }
+
+        if (e < end && (unsigned)(*e - '0') < 10){
+
+            int value = 0;
+            for (; e < end && (unsigned)(*e - '0') < 10; e++){
+                if (value < 10000){
+                    value = value * 10 + (*e - '0');
+                }
+            }
+            exponent += negativeExponent ? -value : value;
+            p = e;
+        }
+    }
+
+    if (next != NULL){
+        *next = p;
+    }
+
+    // mantissa < 2^53 and |exponent| <= 22 are both exact in a double, so one rounding happens
+    double result = (double)mantissa;
+    if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22){
+        result = exponent < 0 ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+    }else if (mantissa != 0){
+        result *= pow(10.0, exponent);
+    }
+
+    return negative ? -result : result;
+}
+
+/**
+ * @note parseNumericField() parses a numeric field, missing values are read as 0
+ * @param value set to the number
+ * @return 1 if parseDecimal() consumed the whole trimmed field, 0 if it holds anything else
+*/
+int parseNumericField(const char* start, int len, double* value){
+
+    start = trimField(start, &len);
+    if (len == 0){
+        *value = 0;
+        return 1;
+    }
+
+    const char* next;
+    *value = parseDecimal(start, start + len, &next);
+
+    return next == start + len;
+}
+
+/**
+ * @note isNumericField() returns 1 if a field parses completely as a number (empty fields count as missing numbers)
+*/
+int isNumericField(const char* start, int len){
+
+    // same parser as parseCsvRow(), so a column inferred as numeric never fails to parse in the rows sampled
+    double value;
+    return parseNumericField(start, len, &value);
+}
+
+/**
+ * @note lineEnd() returns a ptr to the '\n' ending a line, or to end if the line is not terminated
+*/
+const char* lineEnd(const char* line, const char* end){
+
+    const char* newline = memchr(line, '\n', end - line);
+    return newline != NULL ? newline : end;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Chunked Reading
+
+/**
+ * @note fillCsvBuffer() moves unread bytes to the front of the buffer and reads more of the file behind them
+ * @dev the buffer is doubled when it is full of a single unfinished line, which only happens for lines longer than
+ * CSV_CHUNK_BYTES
+*/
+void fillCsvBuffer(CsvStream* stream){
+
+    // compact
+    size_t unread = stream->len - stream->pos;
+    memmove(stream->buffer, stream->buffer + stream->pos, unread);
+    stream->len = unread;
+    stream->pos = 0;
+
+    if (stream->len == stream->capacity){
+
+        stream->capacity *= 2;
+        stream->buffer = (char*)realloc(stream->buffer, stream->capacity + 1);
+        assert(stream->buffer != NULL);
+    }
+
+    size_t bytesRead = fread(stream->buffer + stream->len, 1, stream->capacity - stream->len, stream->file);
+    stream->len += bytesRead;
+
+    if (bytesRead == 0){
+        stream->eof = 1;
+    }
+}
+
+/**
+ * @note nextCsvLine() returns the next complete line of the stream, null terminated in place
+ * @param stream the CsvStream
+ * @param lineLen set to the length of the line, excluding the newline
+ * @return ptr to the line within the stream buffer, or NULL at the end of the file
+*/
+char* nextCsvLine(CsvStream* stream, int* lineLen){
+
+    while (1){
+
+        char* line = stream->buffer + stream->pos;
+        char* end = stream->buffer + stream->len;
+        char* newline = memchr(line, '\n', end - line);
+
+        if (newline != NULL){
+
+            *newline = '\0';
+            *lineLen = newline - line;
+            stream->pos += *lineLen + 1;
+            stream->lineNumber++;
+            return line;
+        }
+
+        if (stream->eof){
+
+            // the last line of a file may not end with a newline
+            if (line == end){
+                return NULL;
+            }
+
+            *end = '\0';
+            *lineLen = end - line;
+            stream->pos = stream->len;
+            stream->lineNumber++;
+            return line;
+        }
+
+        fillCsvBuffer(stream);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Schema Inference
+
+/**
+ * @note inferCsvSchema() infers the number of columns, the kind of each column and whether the file has a header from
+ * the first CSV_SCHEMA_SAMPLE_ROWS lines of the first chunk. The buffer is not consumed.
+ * @dev a column is numeric if every sampled data row parses as a number in it. A header is detected when the first
+ * line holds a non numeric field in a column that is numeric in the rows below it.
+*/
+void inferCsvSchema(CsvStream* stream){
+
+    const char* start = stream->buffer;
+    const char* end = stream->buffer + stream->len;
+
+    // count columns from the first line
+    const char* firstEnd = lineEnd(start, end);
+    stream->numColumns = 1;
+    for (const char* c = start; c < firstEnd; c++){
+        stream->numColumns += (*c == ',');
+    }
+
+    stream->columnKinds = (int*)malloc(sizeof(int) * stream->numColumns);
+    int* firstLineNumeric = (int*)malloc(sizeof(int) * stream->numColumns);
+    assert(stream->columnKinds != NULL && firstLineNumeric != NULL);
+
+    for (int column=0; column<stream->numColumns; column++){
+        stream->columnKinds[column] = CSV_NUMERIC;
+        firstLineNumeric[column] = 1;
+    }
+
+    // check the kind of every field in the sampled lines
+    const char* line = start;
+    int numSampled = 0;
+
+    while (line < end && numSampled <= CSV_SCHEMA_SAMPLE_ROWS){
+
+        const char* lineStop = lineEnd(line, end);
+
+        // the final line of the chunk may be cut off, skip it unless the whole file is in the buffer
+        if (lineStop == end && !stream->eof && numSampled > 0){
+            break;
+        }
+
+        const char* field = line;
+        for (int column=0; column<stream->numColumns && field <= lineStop; column++){
+
+            const char* fieldEnd = memchr(field, ',', lineStop - field);
+            if (fieldEnd == NULL){
+                fieldEnd = lineStop;
+            }
+
+            int numeric = isNumericField(field, fieldEnd - field);
+
+            if (numSampled == 0){
+                firstLineNumeric[column] = numeric;
+            }else if (!numeric){
+                stream->columnKinds[column] = CSV_STRING;
+            }
+
+            field = fieldEnd + 1;
+        }
+
+        numSampled++;
+        line = lineStop + 1;
+    }
+
+    // a file with a single line has no header
+    if (numSampled == 1){
+        for (int column=0; column<stream->numColumns; column++){
+            stream->columnKinds[column] = firstLineNumeric[column] ? CSV_NUMERIC : CSV_STRING;
+        }
+    }
+
+    // header detection
+    if (stream->options.hasHeader == CSV_DETECT){
+
+        stream->options.hasHeader = 0;
+        for (int column=0; column<stream->numColumns && numSampled > 1; column++){
+
+            if (stream->columnKinds[column] == CSV_NUMERIC && !firstLineNumeric[column]){
+                stream->options.hasHeader = 1;
+            }
+        }
+    }
+
+    // without a header the first line is data too
+    if (!stream->options.hasHeader){
+        for (int column=0; column<stream->numColumns; column++){
+            if (!firstLineNumeric[column]){
+                stream->columnKinds[column] = CSV_STRING;
+            }
+        }
+    }
+
+    // resolve the label column
+    stream->labelColumn = stream->options.labelColumn == CSV_LAST_COLUMN ? stream->numColumns - 1 : stream->options.labelColumn;
+    assert(stream->labelColumn >= 0 && stream->labelColumn < stream->numColumns);
+    stream->labelsAreNumeric = stream->columnKinds[stream->labelColumn] == CSV_NUMERIC;
+
+    // every other numeric column is a feature, string columns other than the label cannot be used
+    stream->numFeatures = 0;
+    for (int column=0; column<stream->numColumns; column++){
+
+        if (column == stream->options.ignoreColumn ||
+            (column != stream->labelColumn && stream->columnKinds[column] == CSV_STRING)){
+
+            stream->columnKinds[column] = CSV_IGNORED;
+        }
+
+        if (column != stream->labelColumn && stream->columnKinds[column] == CSV_NUMERIC){
+            stream->numFeatures++;
+        }
+    }
+
+    free(firstLineNumeric);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- CsvStream
+
+/**
+ * @note defaultCsvOptions() sets the label to the last column, ignores no columns and detects the header
+*/
+void defaultCsvOptions(CsvOptions* options){
+    assert(options != NULL);
+
+    options->labelColumn = CSV_LAST_COLUMN;
+    options->ignoreColumn = CSV_NO_COLUMN;
+    options->hasHeader = CSV_DETECT;
+}
+
+/**
+ * @note openCsvStream() opens a CSV file, reads its first chunk and infers its schema
+ * @param path the CSV file
+ * @param options how to interpret the file, NULL for defaultCsvOptions()
+ * @return the CsvStream, or NULL if the file could not be opened or is empty
+*/
+CsvStream* openCsvStream(const char* path, CsvOptions* options){
+    assert(path != NULL);
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL){
+        printf("Error: could not open %s\n", path);
+        return NULL;
+    }
+
+    CsvStream* stream = (CsvStream*)malloc(sizeof(CsvStream));
+    assert(stream != NULL);
+
+    if (options != NULL){
+        stream->options = *options;
+    }else{
+        defaultCsvOptions(&stream->options);
+    }
+
+    // +1 leaves room to terminate an unterminated last line
+    stream->file = file;
+    stream->capacity = CSV_CHUNK_BYTES;
+    stream->buffer = (char*)malloc(stream->capacity + 1);
+    assert(stream->buffer != NULL);
+    stream->len = 0, stream->pos = 0, stream->eof = 0;
+
+    stream->numClasses = 0;
+    stream->rowsRead = 0;
+    stream->lineNumber = 0;
+    stream->badRow = 0;
+    initLabelDictionary(&stream->labels);
+
+    fillCsvBuffer(stream);
+    if (stream->len == 0){
+
+        printf("Error: %s is empty\n", path);
+        stream->columnKinds = NULL;
+        closeCsvStream(&stream);
+        return NULL;
+    }
+
+    inferCsvSchema(stream);
+
+    // skip the header
+    if (stream->options.hasHeader){
+        int lineLen;
+        nextCsvLine(stream, &lineLen);
+    }
+
+    return stream;
+}
+
+/**
+ * @note parseCsvFields() parses the line [line, lineStop) into its features and class label according to the schema of
+ * a stream. The line does not need to be null terminated, so it can be parsed in place from a read only mapping.
+ * @dev a row is malformed when it does not have exactly schema->numColumns fields, when a numeric field holds anything
+ * but a number, or when a numeric label is missing or not an integer in [0, INT32_MAX)
+ * @param schema the CsvStream whose inferred schema is used, only read
+ * @param labels dictionary string labels are looked up in
+ * @param error set to what is wrong with a malformed row
+ * @return 1 if a row was parsed, 0 for blank lines, CSV_BAD_ROW for malformed rows
+*/
+int parseCsvFields(CsvStream* schema, LabelDictionary* labels, const char* line, const char* lineStop, float* features, int32_t* label, const char** error){
+
+    if (line == lineStop || (lineStop - line == 1 && line[0] == '\r')){
+        return 0;
+    }
+
+    const char* field = line;
+    int feature = 0;
+
+    for (int column=0; column<schema->numColumns; column++){
+
+        if (field > lineStop){
+            *error = "too few fields";
+            return CSV_BAD_ROW;
+        }
+
+        const char* fieldEnd = memchr(field, ',', lineStop - field);
+        if (fieldEnd == NULL){
+            fieldEnd = lineStop;
+        }
+        int fieldLen = fieldEnd - field;
+
+        if (column == schema->labelColumn){
+
+            if (schema->labelsAreNumeric){
+
+                double value;
+                const char* trimmed = trimField(field, &fieldLen);
+                if (fieldLen == 0 || !parseNumericField(trimmed, fieldLen, &value)){
+                    *error = "label is not a number";
+                    return CSV_BAD_ROW;
+                }
+                if (value < 0 || value >= INT32_MAX || value != floor(value)){
+                    *error = "label is not an integer class id >= 0";
+                    return CSV_BAD_ROW;
+                }
+                *label = (int32_t)value;
+
+            }else{
+                const char* name = trimField(field, &fieldLen);
+                *label = lookupLabel(labels, name, fieldLen);
+            }
+
+        }else if (schema->columnKinds[column] == CSV_NUMERIC){
+
+            double value;
+            if (!parseNumericField(field, fieldLen, &value)){
+                *error = "numeric field is not a number";
+                return CSV_BAD_ROW;
+            }
+            features[feature++] = (float)value;
+        }
+
+        field = fieldEnd + 1;
+    }
+
+    if (field <= lineStop){
+        *error = "too many fields";
+        return CSV_BAD_ROW;
+    }
+
+    return 1;
+}
+
+/**
+ * @note parseCsvRow() parses a line of a stream into its features and class label
+ * @dev the error of a malformed row is printed with its line number
+ * @return 1 if a row was parsed, 0 for blank lines, CSV_BAD_ROW for malformed rows
+*/
+int parseCsvRow(CsvStream* stream, const char* line, int lineLen, float* features, int32_t* label){
+
+    const char* error;
+    int status = parseCsvFields(stream, &stream->labels, line, line + lineLen, features, label, &error);
+
+    if (status == CSV_BAD_ROW){
+        printf("Error: line %lld of the CSV file is malformed, %s\n", stream->lineNumber, error);
+    }
+    if (status != 1){
+        return status;
+    }
+
+    if (*label + 1 > stream->numClasses){
+        stream->numClasses = *label + 1;
+    }
+
+    return 1;
+}
+
+/**
+ * @note nextCsvBatch() parses up to maxRows rows into caller owned buffers
+ * @param stream the CsvStream
+ * @param features row major maxRows x stream->numFeatures buffer
+ * @param labels maxRows buffer of class ids
+ * @param maxRows capacity of the buffers in rows
+ * @return number of rows parsed, 0 at the end of the file, CSV_BAD_ROW once a malformed row has been read until the
+ * stream is rewound
+*/
+int nextCsvBatch(CsvStream* stream, float* features, int32_t* labels, int maxRows){
+    assert(stream != NULL && features != NULL && labels != NULL);
+
+    int numRows = 0;
+    int lineLen;
+    char* line;
+
+    while (numRows < maxRows && !stream->badRow && (line = nextCsvLine(stream, &lineLen)) != NULL){
+
+        int status = parseCsvRow(stream, line, lineLen, features + (size_t)numRows * stream->numFeatures, &labels[numRows]);
+        if (status == CSV_BAD_ROW){
+            stream->badRow = 1;
+        }else{
+            numRows += status;
+        }
+    }
+
+    if (stream->badRow){
+        return CSV_BAD_ROW;
+    }
+
+    stream->rowsRead += numRows;
+    return numRows;
+}
+
+/**
+ * @note rewindCsvStream() moves a stream back to its first data row, ie: at the start of an epoch
+ * @dev the label dictionary is kept, so ids stay stable across epochs
+*/
+void rewindCsvStream(CsvStream* stream){
+    assert(stream != NULL);
+
+    rewind(stream->file);
+    stream->len = 0, stream->pos = 0, stream->eof = 0;
+    stream->rowsRead = 0;
+    stream->lineNumber = 0;
+    stream->badRow = 0;
+
+    fillCsvBuffer(stream);
+
+    if (stream->options.hasHeader){
+        int lineLen;
+        nextCsvLine(stream, &lineLen);
+    }
+}
+
+/**
+ * @note closeCsvStream() closes the file and frees all memory of a CsvStream
+ * @param stream ptr to a CsvStream ptr, set to NULL
+*/
+void closeCsvStream(CsvStream** stream){
+    assert(stream != NULL && *stream != NULL);
+
+    fclose((*stream)->file);
+    free((*stream)->buffer);
+    free((*stream)->columnKinds);
+    freeLabelDictionary(&(*stream)->labels);
+
+    free(*stream);
+    *stream = NULL;
+}
+
+/**
+ * @note labelName() returns the string of a class id assigned by the label dictionary, or NULL for numeric labels
+*/
+const char* labelName(CsvStream* stream, int label){
+    assert(stream != NULL);
+
+    if (stream->labelsAreNumeric || label < 0 || label >= stream->labels.numLabels){
+        return NULL;
+    }
+
+    return stream->labels.names[label];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Parallel Loading
+
+/**
+ * @note nextLineStart() returns a ptr to the first character after the next '\n' at or after p, or end
+*/
+const char* nextLineStart(const char* p, const char* end){
+
+    const char* newline = memchr(p, '\n', end - p);
+    return newline != NULL ? newline + 1 : end;
+}
+
+/**
+ * @note countCsvRowsTask() is the pthread body of the first pass, which counts the lines and non blank lines of a chunk
+*/
+void* countCsvRowsTask(void* arg){
+
+    CsvParseTask* task = (CsvParseTask*)arg;
+    task->numRows = 0;
+    task->numLines = 0;
+
+    for (const char* line = task->start; line < task->end; ){
+
+        const char* lineStop = lineEnd(line, task->end);
+        task->numRows += !(line == lineStop || (lineStop - line == 1 && line[0] == '\r'));
+        task->numLines++;
+        line = lineStop + 1;
+    }
+
+    return NULL;
+}
+
+/**
+ * @note parseCsvRowsTask() is the pthread body of the second pass, which parses the rows of a chunk directly into its 
+ * slice of the shared feature matrix. String labels get ids from a dictionary local to the task.
+ * @dev parsing stops at the first malformed line, which is recorded in badLine
+*/
+void* parseCsvRowsTask(void* arg){
+
+    CsvParseTask* task = (CsvParseTask*)arg;
+    int numFeatures = task->schema->numFeatures;
+
+    float* features = task->features + task->firstRow * numFeatures;
+    int32_t* labels = task->labels + task->firstRow;
+    uint64_t row = 0;
+    int64_t lineIndex = 0;
+
+    for (const char* line = task->start; line < task->end; lineIndex++){
+
+        const char* lineStop = lineEnd(line, task->end);
+
+        int status = parseCsvFields(task->schema, &task->localLabels, line, lineStop, features + row * numFeatures, &labels[row], &task->error);
+        if (status == CSV_BAD_ROW){
+            task->badLine = lineIndex;
+            return NULL;
+        }
+
+        row += status;
+        line = lineStop + 1;
+    }
+
+    assert(row == task->numRows);
+    return NULL;
+}
+
+/**
+ * @note runCsvTasks() runs a pthread body over every task and waits for all of them, the last task runs on the calling
+ * thread
+*/
+void runCsvTasks(CsvParseTask* tasks, int numTasks, void* (*body)(void*)){
+
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * numTasks);
+    assert(threads != NULL);
+
+    for (int t=0; t<numTasks - 1; t++){
+        int status = pthread_create(&threads[t], NULL, body, &tasks[t]);
+        assert(status == 0);
+    }
+
+    body(&tasks[numTasks - 1]);
+
+    for (int t=0; t<numTasks - 1; t++){
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+}
+
+/**
+ * @note loadCsvDatasetThreads() loads an entire CSV file into a heap backed DenseDataset with multiple threads. The file 
+ * is mapped read only and split at newline boundaries into one chunk per thread. A first pass counts the rows of each 
+ * chunk so that the second pass can parse every chunk in place directly into its slice of one contiguous feature matrix.
+ * @dev string labels are first given ids by a dictionary per thread, which are merged in chunk order afterwards, so ids
+ * are assigned in order of first appearance in the file exactly as with nextCsvBatch()
+ * @param path the CSV file
+ * @param options how to interpret the file, NULL for defaultCsvOptions()
+ * @param numThreads number of parsing threads, or CSV_AUTO_THREADS for one per online cpu
+ * @return the DenseDataset, or NULL if the file could not be opened or holds a malformed row
+*/
+DenseDataset* loadCsvDatasetThreads(const char* path, CsvOptions* options, int numThreads){
+
+    // the schema is inferred from the first chunk as for streaming
+    CsvStream* schema = openCsvStream(path, options);
+    if (schema == NULL){
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    struct stat fileStat;
+    if (fd < 0 || fstat(fd, &fileStat) != 0){
+
+        printf("Error: could not open %s\n", path);
+        if (fd >= 0){
+            close(fd);
+        }
+        closeCsvStream(&schema);
+        return NULL;
+    }
+
+    size_t mapLen = fileStat.st_size;
+    char* mapping = mmap(NULL, mapLen, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED){
+        printf("Error: could not map %s\n", path);
+        closeCsvStream(&schema);
+        return NULL;
+    }
+    madvise(mapping, mapLen, MADV_SEQUENTIAL);
+
+    // the first chunk was read from the start of the file, so pos is the offset of the first data row
+    const char* dataStart = mapping + schema->pos;
+    const char* dataEnd = mapping + mapLen;
+
+    if (numThreads == CSV_AUTO_THREADS){
+        numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    // small files are not worth more than one thread per CSV_MIN_THREAD_BYTES
+    size_t dataLen = dataEnd - dataStart;
+    if ((size_t)numThreads > dataLen / CSV_MIN_THREAD_BYTES){
+        numThreads = (int)(dataLen / CSV_MIN_THREAD_BYTES);
+    }
+    if (numThreads < 1){
+        numThreads = 1;
+    }
+
+    // split at newline boundaries
+    CsvParseTask* tasks = (CsvParseTask*)malloc(sizeof(CsvParseTask) * numThreads);
+    assert(tasks != NULL);
+
+    const char* chunkStart = dataStart;
+    for (int t=0; t<numThreads; t++){
+
+        const char* chunkEnd = t == numThreads - 1 ? dataEnd : dataStart + dataLen * (t + 1) / numThreads;
+        if (chunkEnd < chunkStart){
+            chunkEnd = chunkStart;
+        }
+        if (chunkEnd > dataStart && chunkEnd < dataEnd && chunkEnd[-1] != '\n'){
+            chunkEnd = nextLineStart(chunkEnd, dataEnd);
+        }
+
+        tasks[t].schema = schema;
+        tasks[t].start = chunkStart;
+        tasks[t].end = chunkEnd;
+        chunkStart = chunkEnd;
+    }
+
+    // first pass: row counts give every chunk its offset in the matrix
+    runCsvTasks(tasks, numThreads, countCsvRowsTask);
+
+    uint64_t numRows = 0;
+    for (int t=0; t<numThreads; t++){
+        tasks[t].firstRow = numRows;
+        numRows += tasks[t].numRows;
+    }
+
+    // numClasses is only known once every chunk has been parsed
+    DenseDataset* dataset = newDenseDataset(numRows, schema->numFeatures, 0);
+
+    // second pass: parse in place
+    for (int t=0; t<numThreads; t++){
+        tasks[t].features = dataset->features;
+        tasks[t].labels = dataset->labels;
+        tasks[t].badLine = -1;
+        initLabelDictionary(&tasks[t].localLabels);
+    }
+
+    runCsvTasks(tasks, numThreads, parseCsvRowsTask);
+
+    // report the first malformed line of the file, lines before the data being the header
+    long long lineNumber = 1;
+    for (const char* c = mapping; c < dataStart; c++){
+        lineNumber += *c == '\n';
+    }
+
+    for (int t=0; t<numThreads; t++){
+
+        if (tasks[t].badLine < 0){
+            lineNumber += tasks[t].numLines;
+            continue;
+        }
+
+        printf("Error: line %lld of %s is malformed, %s\n", lineNumber + tasks[t].badLine, path, tasks[t].error);
+
+        for (int i=0; i<numThreads; i++){
+            freeLabelDictionary(&tasks[i].localLabels);
+        }
+        freeDenseDataset(&dataset);
+        munmap(mapping, mapLen);
+        free(tasks);
+        closeCsvStream(&schema);
+
+        return NULL;
+    }
+
+    // merge the local label dictionaries in chunk order and remap local ids to global ids
+    int32_t numClasses = 0;
+    for (int t=0; t<numThreads; t++){
+
+        int32_t* labels = dataset->labels + tasks[t].firstRow;
+
+        if (schema->labelsAreNumeric){
+
+            for (uint64_t row=0; row<tasks[t].numRows; row++){
+                if (labels[row] + 1 > numClasses){
+                    numClasses = labels[row] + 1;
+                }
+            }
+
+        }else{
+
+            LabelDictionary* local = &tasks[t].localLabels;
+            int* globalIds = (int*)malloc(sizeof(int) * (local->numLabels + 1));
+            assert(globalIds != NULL);
+
+            for (int id=0; id<local->numLabels; id++){
+                globalIds[id] = lookupLabel(&schema->labels, local->names[id], strlen(local->names[id]));
+            }
+            for (uint64_t row=0; row<tasks[t].numRows; row++){
+                labels[row] = globalIds[labels[row]];
+            }
+
+            free(globalIds);
+            numClasses = schema->labels.numLabels;
+        }
+
+        freeLabelDictionary(&tasks[t].localLabels);
+    }
+
+    dataset->numClasses = numClasses;
+
+    munmap(mapping, mapLen);
+    free(tasks);
+    closeCsvStream(&schema);
+
+    return dataset;
+}
+
+/**
+ * @note loadCsvDataset() loads an entire CSV file into a heap backed DenseDataset with one parsing thread per cpu
+ * @dev intended for files that fit in memory, larger files should be consumed batch by batch with nextCsvBatch()
+ * @param path the CSV file
+ * @param options how to interpret the file, NULL for defaultCsvOptions()
+ * @return the DenseDataset, or NULL if the file could not be opened or holds a malformed row
+*/
+DenseDataset* loadCsvDataset(const char* path, CsvOptions* options){
+    return loadCsvDatasetThreads(path, options, CSV_AUTO_THREADS);
+}
@@ -0,0 +1,432 @@
+#include "lib.h"
+#include <sched.h>
+
+// dataLoader.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Ring
+
+/**
+ * @note loaderWait() backs off inside a wait loop on the ring, spinning briefly before yielding the cpu
+ * @param spins number of times the caller has waited so far, incremented
+*/
+void loaderWait(int* spins){
+
+    if ((*spins)++ < 64){
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }else{
+        sched_yield();
+    }
+}
+
+/**
+ * @note acquireSlot() waits for the consumer to release a ring slot and returns it to the producer
+ * @return the free Batch, or NULL if the loader is being stopped
+*/
+Batch* acquireSlot(DataLoader* loader){
+
+    uint64_t head = atomic_load_explicit(&loader->head, memory_order_relaxed);
+    int spins = 0;
+
+    while (head - atomic_load_explicit(&loader->tail, memory_order_acquire) >= LOADER_RING_SLOTS){
+
+        if (atomic_load_explicit(&loader->stop, memory_order_relaxed)){
+            return NULL;
+        }
+        loaderWait(&spins);
+    }
+
+    return &loader->ring[head % LOADER_RING_SLOTS];
+}
+
+/**
+ * @note publishSlot() hands the slot returned by acquireSlot() to the consumer
+*/
+void publishSlot(DataLoader* loader){
+
+    uint64_t head = atomic_load_explicit(&loader->head, memory_order_relaxed);
+    atomic_store_explicit(&loader->head, head + 1, memory_order_release);
+}
+
+/**
+ * @note nextBatch() waits for the next mini-batch prepared by the loader thread
+ * @dev the returned Batch stays valid until releaseBatch(), call it once the batch has been consumed
+ * @param loader the DataLoader
+ * @return the next Batch, or NULL at the end of an epoch, once every epoch has been delivered and once a malformed 
+ * streamed row has stopped the loader. getLoaderStatus() tells these apart.
+*/
+Batch* nextBatch(DataLoader* loader){
+    assert(loader != NULL);
+
+    uint64_t tail = atomic_load_explicit(&loader->tail, memory_order_relaxed);
+    int spins = 0;
+
+    while (atomic_load_explicit(&loader->head, memory_order_acquire) == tail){
+
+        // re-check head after seeing finished, the last batches may have been published in between
+        if (atomic_load_explicit(&loader->finished, memory_order_acquire) &&
+            atomic_load_explicit(&loader->head, memory_order_acquire) == tail){
+
+            loader->status = atomic_load_explicit(&loader->badRow, memory_order_relaxed) ? LOADER_BAD_ROW : LOADER_DONE;
+            return NULL;
+        }
+        loaderWait(&spins);
+    }
+
+    Batch* batch = &loader->ring[tail % LOADER_RING_SLOTS];
+
+    // end of epoch marker
+    if (batch->numRows == 0){
+
+        loader->position.epoch = batch->epoch + 1;
+        loader->position.batch = 0;
+
+        atomic_store_explicit(&loader->tail, tail + 1, memory_order_release);
+        loader->status = LOADER_END_OF_EPOCH;
+        return NULL;
+    }
+
+    loader->status = LOADER_OK;
+    return batch;
+}
+
+/**
+ * @note releaseBatch() returns the batch from the last nextBatch() to the loader thread for refilling
+*/
+void releaseBatch(DataLoader* loader){
+    assert(loader != NULL);
+
+    loader->position.batch++;
+
+    uint64_t tail = atomic_load_explicit(&loader->tail, memory_order_relaxed);
+    atomic_store_explicit(&loader->tail, tail + 1, memory_order_release);
+}
+
+/**
+ * @note getLoaderPosition() returns the position of the next batch nextBatch() will deliver, call it from the consuming 
+ * thread between batches. A loader created with newDataLoaderAt() at that position continues with the same batches.
+*/
+LoaderPosition getLoaderPosition(DataLoader* loader){
+    assert(loader != NULL);
+    return loader->position;
+}
+
+/**
+ * @note getLoaderStatus() returns why the last nextBatch() call returned what it did, call it from the consuming thread
+ * @return LOADER_OK for a batch, LOADER_END_OF_EPOCH, LOADER_DONE once every epoch has been delivered, or 
+ * LOADER_BAD_ROW once a malformed streamed row has stopped the loader, the row being at line loader->badLine
+*/
+int getLoaderStatus(DataLoader* loader){
+    assert(loader != NULL);
+    return loader->status;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Producers
+
+/**
+ * @note shuffleOrder() applies a Fisher-Yates shuffle to the rows of an in memory dataset
+ * @dev the order is reset first, so the permutation only depends on the epoch's Rng stream
+*/
+void shuffleOrder(DataLoader* loader){
+
+    for (uint64_t row=0; row<loader->dataset->numRows; row++){
+        loader->order[row] = row;
+    }
+
+    for (uint64_t i=loader->dataset->numRows; i-- > 1; ){
+
+        uint64_t j = rngBelow(&loader->rng, i + 1);
+        uint64_t temp = loader->order[i];
+        loader->order[i] = loader->order[j];
+        loader->order[j] = temp;
+    }
+}
+
+/**
+ * @note produceDatasetEpoch() gathers the batches of one epoch of an in memory dataset into the ring
+ * @param skip number of batches at the start of the epoch that are not delivered
+ * @return 0 if the loader was stopped
+*/
+int produceDatasetEpoch(DataLoader* loader, int epoch, int64_t skip){
+
+    if (loader->shuffle){
+        shuffleOrder(loader);
+    }
+
+    for (uint64_t start=skip * loader->batchSize; start<loader->dataset->numRows; start+=loader->batchSize){
+
+        Batch* batch = acquireSlot(loader);
+        if (batch == NULL){
+            return 0;
+        }
+
+        uint64_t numRows = loader->dataset->numRows - start;
+        batch->numRows = numRows < (uint64_t)loader->batchSize ? (int)numRows : loader->batchSize;
+        batch->epoch = epoch;
+
+        gatherBatch(loader->dataset, loader->order + start, batch->numRows, batch->features, batch->labels);
+        publishSlot(loader);
+    }
+
+    return 1;
+}
+
+/**
+ * @note readStreamRows() reads up to maxRows streamed rows, recording a malformed row in the loader
+ * @return the number of rows read, 0 at the end of the stream or at a malformed row
+*/
+int readStreamRows(DataLoader* loader, float* features, int32_t* labels, int maxRows){
+
+    int numRead = nextCsvBatch(loader->stream, features, labels, maxRows);
+
+    if (numRead == CSV_BAD_ROW){
+
+        loader->badLine = loader->stream->lineNumber;
+        atomic_store_explicit(&loader->badRow, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    return numRead;
+}
+
+/**
+ * @note refillShuffleBuffer() reads streamed rows into the shuffle buffer until it is full or the stream ends
+*/
+void refillShuffleBuffer(DataLoader* loader){
+
+    loader->bufferCount += readStreamRows(
+        loader,
+        loader->bufferFeatures + (size_t)loader->bufferCount * loader->numFeatures,
+        loader->bufferLabels + loader->bufferCount,
+        loader->bufferRows - loader->bufferCount
+    );
+}
+
+/**
+ * @note produceStreamEpoch() streams one epoch of a CsvStream through the shuffle buffer into the ring
+ * @dev each output row is drawn uniformly from the buffer and its slot is refilled with the next streamed row, or with
+ * the last buffered row once the stream has ended
+ * @dev skipped batches are still drawn, into a slot that is not published, so the shuffle buffer ends up in the same 
+ * state as if they had been delivered
+ * @dev a malformed row stops the epoch at once, the batch being filled is not published
+ * @param skip number of batches at the start of the epoch that are not delivered
+ * @return 0 if the loader was stopped or hit a malformed row
+*/
+int produceStreamEpoch(DataLoader* loader, int epoch, int64_t skip){
+
+    if (epoch > loader->start.epoch){
+        rewindCsvStream(loader->stream);
+    }
+
+    size_t rowBytes = sizeof(float) * loader->numFeatures;
+    loader->bufferCount = 0;
+    refillShuffleBuffer(loader);
+
+    for (int64_t index=0; loader->bufferCount > 0 && !atomic_load_explicit(&loader->badRow, memory_order_relaxed); index++){
+
+        Batch* batch = acquireSlot(loader);
+        if (batch == NULL){
+            return 0;
+        }
+
+        batch->numRows = 0;
+        batch->epoch = epoch;
+
+        while (batch->numRows < loader->batchSize && loader->bufferCount > 0){
+
+            int slot = loader->shuffle ? (int)rngBelow(&loader->rng, loader->bufferCount) : 0;
+
+            memcpy(batch->features + (size_t)batch->numRows * loader->numFeatures, loader->bufferFeatures + (size_t)slot * loader->numFeatures, rowBytes);
+            batch->labels[batch->numRows++] = loader->bufferLabels[slot];
+
+            // refill the slot from the stream, or fill the hole with the last row
+            int32_t* label = &loader->bufferLabels[slot];
+            if (readStreamRows(loader, loader->bufferFeatures + (size_t)slot * loader->numFeatures, label, 1) == 0){
+
+                loader->bufferCount--;
+                memcpy(loader->bufferFeatures + (size_t)slot * loader->numFeatures, loader->bufferFeatures + (size_t)loader->bufferCount * loader->numFeatures, rowBytes);
+                *label = loader->bufferLabels[loader->bufferCount];
+            }
+        }
+
+        if (atomic_load_explicit(&loader->badRow, memory_order_relaxed)){
+            return 0;
+        }
+
+        if (index >= skip){
+            publishSlot(loader);
+        }
+    }
+
+    return !atomic_load_explicit(&loader->badRow, memory_order_relaxed);
+}
+
+/**
+ * @note loaderThread() is the pthread body of a DataLoader, it produces every epoch from the start position on, each 
+ * followed by an end marker
+*/
+void* loaderThread(void* arg){
+
+    DataLoader* loader = (DataLoader*)arg;
+
+    for (int epoch=loader->start.epoch; epoch<loader->numEpochs; epoch++){
+
+        seedRngStream(&loader->rng, loader->seed, epoch);
+        int64_t skip = epoch == loader->start.epoch ? loader->start.batch : 0;
+
+        int running = loader->dataset != NULL ? produceDatasetEpoch(loader, epoch, skip) : produceStreamEpoch(loader, epoch, skip);
+
+        Batch* marker = running ? acquireSlot(loader) : NULL;
+        if (marker == NULL){
+            break;
+        }
+
+        marker->numRows = 0;
+        marker->epoch = epoch;
+        publishSlot(loader);
+    }
+
+    atomic_store_explicit(&loader->finished, 1, memory_order_release);
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Constructors
+
+/**
+ * @note initDataLoader() allocates the ring and starts the loader thread once the source is set
+*/
+DataLoader* initDataLoader(DataLoader* loader, uint64_t seed, LoaderPosition start){
+    assert(start.epoch >= 0 && start.batch >= 0);
+
+    loader->seed = seed;
+    loader->start = start;
+    loader->position = start;
+
+    size_t featureBytes = sizeof(float) * loader->batchSize * loader->numFeatures;
+    size_t labelBytes = sizeof(int32_t) * loader->batchSize;
+
+    // aligned_alloc requires a multiple of the alignment
+    featureBytes = (featureBytes + DATASET_ALIGNMENT) / DATASET_ALIGNMENT * DATASET_ALIGNMENT;
+    labelBytes = (labelBytes + DATASET_ALIGNMENT) / DATASET_ALIGNMENT * DATASET_ALIGNMENT;
+
+    for (int slot=0; slot<LOADER_RING_SLOTS; slot++){
+
+        loader->ring[slot].features = (float*)aligned_alloc(DATASET_ALIGNMENT, featureBytes);
+        loader->ring[slot].labels = (int32_t*)aligned_alloc(DATASET_ALIGNMENT, labelBytes);
+        assert(loader->ring[slot].features != NULL && loader->ring[slot].labels != NULL);
+        loader->ring[slot].numRows = 0;
+        loader->ring[slot].epoch = 0;
+    }
+
+    atomic_init(&loader->head, 0);
+    atomic_init(&loader->tail, 0);
+    atomic_init(&loader->stop, 0);
+    atomic_init(&loader->finished, 0);
+    atomic_init(&loader->badRow, 0);
+    loader->badLine = 0;
+    loader->status = LOADER_OK;
+
+    int status = pthread_create(&loader->thread, NULL, loaderThread, loader);
+    assert(status == 0);
+
+    return loader;
+}
+
+/**
+ * @note newDataLoader() starts a loader thread delivering numEpochs epochs of an in memory dataset in mini-batches
+ * @param dataset the DenseDataset, not owned by the loader
+ * @param batchSize rows per batch
+ * @param numEpochs number of epochs to deliver
+ * @param shuffle LOADER_SHUFFLE for a new permutation every epoch, LOADER_NO_SHUFFLE for file order
+ * @param seed seed of the shuffle, the same seed gives the same batches
+*/
+DataLoader* newDataLoader(DenseDataset* dataset, int batchSize, int numEpochs, int shuffle, uint64_t seed){
+    return newDataLoaderAt(dataset, batchSize, numEpochs, shuffle, seed, (LoaderPosition){0, 0});
+}
+
+/**
+ * @note newDataLoaderAt() is newDataLoader() starting at a position from getLoaderPosition(), ie: to resume training. 
+ * With the same dataset, batch size, shuffle and seed it delivers the batches the original loader had left.
+*/
+DataLoader* newDataLoaderAt(DenseDataset* dataset, int batchSize, int numEpochs, int shuffle, uint64_t seed, LoaderPosition start){
+    assert(dataset != NULL && batchSize > 0);
+
+    DataLoader* loader = (DataLoader*)calloc(1, sizeof(DataLoader));
+    assert(loader != NULL);
+
+    loader->dataset = dataset;
+    loader->numFeatures = dataset->numFeatures;
+    loader->batchSize = batchSize;
+    loader->numEpochs = numEpochs;
+    loader->shuffle = shuffle;
+
+    loader->order = (uint64_t*)malloc(sizeof(uint64_t) * (dataset->numRows + 1));
+    assert(loader->order != NULL);
+    for (uint64_t row=0; row<dataset->numRows; row++){
+        loader->order[row] = row;
+    }
+
+    return initDataLoader(loader, seed, start);
+}
+
+/**
+ * @note newStreamLoader() starts a loader thread delivering numEpochs epochs of a CsvStream in mini-batches, shuffled
+ * through a buffer of shuffleBufferRows rows. Memory use is bounded by the buffer and the ring.
+ * @param stream an open CsvStream positioned at its first row, not owned by the loader
+ * @param batchSize rows per batch
+ * @param shuffleBufferRows rows held in the shuffle buffer, larger buffers shuffle better. LOADER_NO_SHUFFLE keeps
+ * file order
+ * @param numEpochs number of epochs to deliver, the stream is rewound between epochs
+ * @param seed seed of the shuffle
+*/
+DataLoader* newStreamLoader(CsvStream* stream, int batchSize, int shuffleBufferRows, int numEpochs, uint64_t seed){
+    return newStreamLoaderAt(stream, batchSize, shuffleBufferRows, numEpochs, seed, (LoaderPosition){0, 0});
+}
+
+/**
+ * @note newStreamLoaderAt() is newStreamLoader() starting at a position from getLoaderPosition(). The batches skipped 
+ * in the start epoch are still read and drawn through the shuffle buffer, but not delivered.
+*/
+DataLoader* newStreamLoaderAt(CsvStream* stream, int batchSize, int shuffleBufferRows, int numEpochs, uint64_t seed, LoaderPosition start){
+    assert(stream != NULL && batchSize > 0);
+
+    DataLoader* loader = (DataLoader*)calloc(1, sizeof(DataLoader));
+    assert(loader != NULL);
+
+    loader->stream = stream;
+    loader->numFeatures = stream->numFeatures;
+    loader->batchSize = batchSize;
+    loader->numEpochs = numEpochs;
+    loader->shuffle = shuffleBufferRows > 1;
+
+    loader->bufferRows = shuffleBufferRows > 1 ? shuffleBufferRows : 1;
+    loader->bufferFeatures = (float*)malloc(sizeof(float) * loader->bufferRows * loader->numFeatures + 1);
+    loader->bufferLabels = (int32_t*)malloc(sizeof(int32_t) * loader->bufferRows);
+    assert(loader->bufferFeatures != NULL && loader->bufferLabels != NULL);
+
+    return initDataLoader(loader, seed, start);
+}
+
+/**
+ * @note freeDataLoader() stops the loader thread, even mid epoch, and frees the loader. The source is not freed.
+ * @param loader ptr to a DataLoader ptr, set to NULL
+*/
+void freeDataLoader(DataLoader** loader){
+    assert(loader != NULL && *loader != NULL);
+
+    atomic_store_explicit(&(*loader)->stop, 1, memory_order_relaxed);
+    pthread_join((*loader)->thread, NULL);
+
+    for (int slot=0; slot<LOADER_RING_SLOTS; slot++){
+        free((*loader)->ring[slot].features);
+        free((*loader)->ring[slot].labels);
+    }
+
+    free((*loader)->order);
+    free((*loader)->bufferFeatures);
+    free((*loader)->bufferLabels);
+
+    free(*loader);
+    *loader = NULL;
+}
@@ -0,0 +1,573 @@
+#include "lib.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// dataset.c
+
+_Static_assert(sizeof(DatasetHeader) == 64, "DatasetHeader must stay 64 bytes");
+
+// ---------------------------------------------------------------------------------------------------------------------- Header
+
+/**
+ * @note alignOffset() rounds a byte offset up to the next multiple of DATASET_ALIGNMENT
+*/
+uint64_t alignOffset(uint64_t offset){
+    return (offset + DATASET_ALIGNMENT - 1) / DATASET_ALIGNMENT * DATASET_ALIGNMENT;
+}
+
+/**
+ * @note dtypeSize() returns the bytes per feature value of a storage type
+*/
+size_t dtypeSize(int dtype){
+
+    switch (dtype){
+        case DTYPE_FLOAT32: return sizeof(float);
+        case DTYPE_UINT8: return sizeof(uint8_t);
+        case DTYPE_INT16: return sizeof(int16_t);
+    }
+
+    assert(0 && "unknown dtype");
+    return 0;
+}
+
+/**
+ * @note initDatasetHeader() fills a DatasetHeader for a float32 dataset of the given shape, including the offsets of 
+ * the feature and label blocks
+*/
+void initDatasetHeader(DatasetHeader* header, uint64_t numRows, int numFeatures, int numClasses){
+    initQuantizedDatasetHeader(header, numRows, numFeatures, numClasses, DTYPE_FLOAT32);
+}
+
+/**
+ * @note initQuantizedDatasetHeader() fills a DatasetHeader for a dataset whose features are stored as dtype. Quantized
+ * datasets get a block of per column scales and offsets between the header and the feature matrix.
+*/
+void initQuantizedDatasetHeader(DatasetHeader* header, uint64_t numRows, int numFeatures, int numClasses, int dtype){
+    assert(header != NULL);
+    assert(numFeatures > 0 && numClasses > 0);
+
+    memset(header, 0, sizeof(DatasetHeader));
+    memcpy(header->magic, DATASET_MAGIC, 4);
+    header->version = DATASET_VERSION;
+    header->numRows = numRows;
+    header->numFeatures = numFeatures;
+    header->numClasses = numClasses;
+    header->dtype = dtype;
+
+    if (dtype == DTYPE_FLOAT32){
+        header->quantOffset = 0;
+        header->featuresOffset = alignOffset(sizeof(DatasetHeader));
+    }else{
+        header->quantOffset = alignOffset(sizeof(DatasetHeader));
+        header->featuresOffset = alignOffset(header->quantOffset + 2 * numFeatures * sizeof(float));
+    }
+
+    header->labelsOffset = alignOffset(header->featuresOffset + numRows * numFeatures * dtypeSize(dtype));
+}
+
+/**
+ * @note validateDatasetHeader() checks the magic, version, dimensions and dtype of a dataset header
+ * @return 1 if the header is valid, 0 otherwise
+*/
+int validateDatasetHeader(const DatasetHeader* header){
+
+    if (memcmp(header->magic, DATASET_MAGIC, 4) != 0 || header->version != DATASET_VERSION){
+        return 0;
+    }
+
+    // both are held as int in a DenseDataset
+    return header->numFeatures > 0 && header->numFeatures <= INT32_MAX &&
+        header->numClasses > 0 && header->numClasses <= INT32_MAX &&
+        header->dtype <= DTYPE_INT16;
+}
+
+/**
+ * @note validateDatasetLayout() checks that the blocks described by a valid dataset header are aligned for their types, 
+ * do not overlap and fit in a file of fileSize bytes
+ * @dev every size and end offset is computed with overflow checks, so a crafted header can not wrap around to pass
+ * @return 1 if the layout is valid, 0 otherwise
+*/
+int validateDatasetLayout(const DatasetHeader* header, uint64_t fileSize){
+
+    uint64_t featureBytes, featuresEnd, labelBytes, labelsEnd;
+
+    if (__builtin_mul_overflow(header->numRows, (uint64_t)header->numFeatures * dtypeSize(header->dtype), &featureBytes) ||
+        __builtin_add_overflow(header->featuresOffset, featureBytes, &featuresEnd) ||
+        __builtin_mul_overflow(header->numRows, sizeof(int32_t), &labelBytes) ||
+        __builtin_add_overflow(header->labelsOffset, labelBytes, &labelsEnd)){
+
+        return 0;
+    }
+
+    // scales and offsets sit between the header and the features of a quantized dataset
+    uint64_t quantEnd = header->dtype == DTYPE_FLOAT32 ? sizeof(DatasetHeader) : 
+        header->quantOffset + 2 * (uint64_t)header->numFeatures * sizeof(float);
+
+    return (header->dtype == DTYPE_FLOAT32 || (header->quantOffset >= sizeof(DatasetHeader) && header->quantOffset % sizeof(float) == 0)) &&
+        header->featuresOffset >= quantEnd && header->featuresOffset % dtypeSize(header->dtype) == 0 &&
+        header->labelsOffset >= featuresEnd && header->labelsOffset % sizeof(int32_t) == 0 &&
+        labelsEnd <= fileSize;
+}
+
+/**
+ * @note readDatasetHeader() reads and validates the header at the start of a binary dataset file
+ * @return 1 if the header is valid, 0 otherwise
+*/
+int readDatasetHeader(FILE* file, DatasetHeader* header){
+    assert(file != NULL && header != NULL);
+
+    if (fread(header, sizeof(DatasetHeader), 1, file) != 1){
+        return 0;
+    }
+
+    return validateDatasetHeader(header);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Writer
+
+/**
+ * @note newDatasetWriter() creates a binary dataset file for numRows rows and writes its header
+ * @param path the file to create
+ * @param numRows the number of rows that will be written
+ * @param numFeatures number of features per row
+ * @param numClasses number of classes
+*/
+DatasetWriter* newDatasetWriter(const char* path, uint64_t numRows, int numFeatures, int numClasses){
+    return newQuantizedDatasetWriter(path, numRows, numFeatures, numClasses, DTYPE_FLOAT32, NULL, NULL);
+}
+
+/**
+ * @note newQuantizedDatasetWriter() creates a binary dataset file whose features are stored as dtype, and writes its
+ * header and quantization parameters. Rows passed to writeDatasetRows() are quantized as they are written.
+ * @param path the file to create
+ * @param numRows the number of rows that will be written
+ * @param numFeatures number of features per row
+ * @param numClasses number of classes
+ * @param dtype DTYPE_FLOAT32, DTYPE_UINT8 or DTYPE_INT16
+ * @param scale per column scales from computeQuantParams(), NULL for DTYPE_FLOAT32
+ * @param offset per column offsets from computeQuantParams(), NULL for DTYPE_FLOAT32
+*/
+DatasetWriter* newQuantizedDatasetWriter(const char* path, uint64_t numRows, int numFeatures, int numClasses, int dtype, const float* scale, const float* offset){
+    assert(path != NULL);
+    assert(dtype == DTYPE_FLOAT32 || (scale != NULL && offset != NULL));
+
+    DatasetWriter* writer = (DatasetWriter*)calloc(1, sizeof(DatasetWriter));
+    assert(writer != NULL);
+
+    initQuantizedDatasetHeader(&writer->header, numRows, numFeatures, numClasses, dtype);
+    writer->rowsWritten = 0;
+
+    // write the header
+    writer->featureFile = fopen(path, "wb+");
+    assert(writer->featureFile != NULL);
+    size_t written = fwrite(&writer->header, sizeof(DatasetHeader), 1, writer->featureFile);
+    assert(written == 1);
+
+    // keep a copy of the quantization parameters and write them to their block
+    if (dtype != DTYPE_FLOAT32){
+
+        writer->scale = (float*)malloc(sizeof(float) * numFeatures);
+        writer->offset = (float*)malloc(sizeof(float) * numFeatures);
+        assert(writer->scale != NULL && writer->offset != NULL);
+        memcpy(writer->scale, scale, sizeof(float) * numFeatures);
+        memcpy(writer->offset, offset, sizeof(float) * numFeatures);
+
+        int seekQuant = fseeko(writer->featureFile, writer->header.quantOffset, SEEK_SET);
+        size_t scalesWritten = fwrite(scale, sizeof(float), numFeatures, writer->featureFile);
+        size_t offsetsWritten = fwrite(offset, sizeof(float), numFeatures, writer->featureFile);
+        assert(seekQuant == 0 && scalesWritten == (size_t)numFeatures && offsetsWritten == (size_t)numFeatures);
+    }
+
+    // second handle on the same file for the label block
+    writer->labelFile = fopen(path, "rb+");
+    assert(writer->labelFile != NULL);
+
+    int seekFeatures = fseeko(writer->featureFile, writer->header.featuresOffset, SEEK_SET);
+    int seekLabels = fseeko(writer->labelFile, writer->header.labelsOffset, SEEK_SET);
+    assert(seekFeatures == 0 && seekLabels == 0);
+
+    return writer;
+}
+
+/**
+ * @note writeDatasetRows() appends a block of rows to a dataset being written
+ * @dev rows of a quantized dataset are quantized into a buffer kept by the writer and written from there
+ * @param writer the DatasetWriter
+ * @param features row major numRows x numFeatures matrix
+ * @param labels numRows class labels
+ * @param numRows number of rows in this block
+*/
+void writeDatasetRows(DatasetWriter* writer, const float* features, const int32_t* labels, int numRows){
+    assert(writer != NULL && features != NULL && labels != NULL);
+    assert(writer->rowsWritten + numRows <= writer->header.numRows);
+
+    int numFeatures = writer->header.numFeatures;
+    size_t numValues = (size_t)numRows * numFeatures;
+    size_t valueSize = dtypeSize(writer->header.dtype);
+    const void* data = features;
+
+    if (writer->header.dtype != DTYPE_FLOAT32){
+
+        // grow the quantization buffer to the largest block seen
+        if (numValues * valueSize > writer->quantBufferBytes){
+
+            writer->quantBufferBytes = numValues * valueSize;
+            writer->quantBuffer = realloc(writer->quantBuffer, writer->quantBufferBytes);
+            assert(writer->quantBuffer != NULL);
+        }
+
+        for (int row=0; row<numRows; row++){
+            quantizeRow(
+                features + (size_t)row * numFeatures, 
+                numFeatures, 
+                writer->header.dtype, 
+                writer->scale, 
+                writer->offset, 
+                (char*)writer->quantBuffer + (size_t)row * numFeatures * valueSize
+            );
+        }
+
+        data = writer->quantBuffer;
+    }
+
+    size_t featuresWritten = fwrite(data, valueSize, numValues, writer->featureFile);
+    size_t labelsWritten = fwrite(labels, sizeof(int32_t), numRows, writer->labelFile);
+    assert(featuresWritten == numValues && labelsWritten == (size_t)numRows);
+
+    writer->rowsWritten += numRows;
+}
+
+/**
+ * @note closeDatasetWriter() flushes and closes a dataset file once every row has been written
+ * @param writer ptr to a DatasetWriter ptr, set to NULL
+*/
+void closeDatasetWriter(DatasetWriter** writer){
+    assert(writer != NULL && *writer != NULL);
+    assert((*writer)->rowsWritten == (*writer)->header.numRows);
+
+    fclose((*writer)->featureFile);
+    fclose((*writer)->labelFile);
+
+    free((*writer)->scale);
+    free((*writer)->offset);
+    free((*writer)->quantBuffer);
+
+    free(*writer);
+    *writer = NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Quantization
+
+/**
+ * @note computeQuantParams() computes per column scales and offsets mapping the range [min, max] of each column of a 
+ * sample of rows onto the full range of dtype, so that x = offset + scale * q
+ * @dev values outside the sampled range are clamped by quantizeRow(), pass every row to avoid clamping
+ * @param features row major numRows x numFeatures sample
+ * @param numRows rows in the sample
+ * @param numFeatures number of features per row
+ * @param dtype DTYPE_UINT8 or DTYPE_INT16
+ * @param scale numFeatures scales, filled
+ * @param offset numFeatures offsets, filled
+*/
+void computeQuantParams(const float* features, uint64_t numRows, int numFeatures, int dtype, float* scale, float* offset){
+    assert(features != NULL && scale != NULL && offset != NULL);
+    assert(dtype == DTYPE_UINT8 || dtype == DTYPE_INT16);
+
+    for (int j=0; j<numFeatures; j++){
+
+        float min = numRows > 0 ? features[j] : 0;
+        float max = min;
+
+        for (uint64_t row=1; row<numRows; row++){
+
+            float x = features[row * numFeatures + j];
+            min = x < min ? x : min;
+            max = x > max ? x : max;
+        }
+
+        quantParamsFromRange(min, max, dtype, scale + j, offset + j);
+    }
+}
+
+/**
+ * @note quantParamsFromRange() computes the scale and offset mapping the range [min, max] of one column onto the full
+ * range of dtype, for callers that track column ranges themselves, e.g. over more rows than fit in memory
+ * @param scale scale of the column, filled
+ * @param offset offset of the column, filled
+*/
+void quantParamsFromRange(float min, float max, int dtype, float* scale, float* offset){
+    assert(scale != NULL && offset != NULL);
+    assert(dtype == DTYPE_UINT8 || dtype == DTYPE_INT16);
+
+    double levels = dtype == DTYPE_UINT8 ? UINT8_MAX : UINT16_MAX;
+
+    // constant columns still need a nonzero scale
+    *scale = max > min ? (float)((max - min) / levels) : 1.0f;
+
+    // the minimum maps to the lowest code, 0 for uint8 and INT16_MIN for int16
+    *offset = dtype == DTYPE_UINT8 ? min : min - (float)INT16_MIN * *scale;
+}
+
+/**
+ * @note quantizeRow() rounds a row of features to the nearest codes of dtype, clamping out of range values
+ * @param row numFeatures features
+ * @param out numFeatures codes of type dtype
+*/
+void quantizeRow(const float* row, int numFeatures, int dtype, const float* scale, const float* offset, void* out){
+    assert(dtype == DTYPE_UINT8 || dtype == DTYPE_INT16);
+
+    float low = dtype == DTYPE_UINT8 ? 0 : INT16_MIN;
+    float high = dtype == DTYPE_UINT8 ? UINT8_MAX : INT16_MAX;
+
+    for (int j=0; j<numFeatures; j++){
+
+        float q = nearbyintf((row[j] - offset[j]) / scale[j]);
+        q = q < low ? low : (q > high ? high : q);
+
+        if (dtype == DTYPE_UINT8){
+            ((uint8_t*)out)[j] = (uint8_t)q;
+        }else{
+            ((int16_t*)out)[j] = (int16_t)q;
+        }
+    }
+}
+
+/**
+ * @note dequantizeRow() expands a row of codes back to floats, out[j] = offset[j] + scale[j] * row[j]
+ * @dev with SSE2 the codes are widened to int32 and converted 8 at a time, 4 floats per instruction
+ * @param row numFeatures codes of type dtype
+ * @param out numFeatures features
+*/
+void dequantizeRow(const void* row, int numFeatures, int dtype, const float* scale, const float* offset, float* out){
+    assert(dtype == DTYPE_UINT8 || dtype == DTYPE_INT16);
+
+    int j = 0;
+
+#ifdef __SSE2__
+    for (; j + 8 <= numFeatures; j += 8){
+
+        __m128i lo, hi;
+
+        if (dtype == DTYPE_UINT8){
+
+            // 8 uint8 -> 8 uint16 -> 2 x 4 int32, zero extended
+            __m128i codes = _mm_loadl_epi64((const __m128i*)((const uint8_t*)row + j));
+            codes = _mm_unpacklo_epi8(codes, _mm_setzero_si128());
+            lo = _mm_unpacklo_epi16(codes, _mm_setzero_si128());
+            hi = _mm_unpackhi_epi16(codes, _mm_setzero_si128());
+        }else{
+
+            // 8 int16 -> 2 x 4 int32, sign extended by shifting down from the high half
+            __m128i codes = _mm_loadu_si128((const __m128i*)((const int16_t*)row + j));
+            lo = _mm_srai_epi32(_mm_unpacklo_epi16(codes, codes), 16);
+            hi = _mm_srai_epi32(_mm_unpackhi_epi16(codes, codes), 16);
+        }
+
+        __m128 outLo = _mm_add_ps(_mm_loadu_ps(offset + j), _mm_mul_ps(_mm_loadu_ps(scale + j), _mm_cvtepi32_ps(lo)));
+        __m128 outHi = _mm_add_ps(_mm_loadu_ps(offset + j + 4), _mm_mul_ps(_mm_loadu_ps(scale + j + 4), _mm_cvtepi32_ps(hi)));
+        _mm_storeu_ps(out + j, outLo);
+        _mm_storeu_ps(out + j + 4, outHi);
+    }
+#endif
+
+    // scalar tail, and the whole row without SSE2
+    for (; j<numFeatures; j++){
+
+        float q = dtype == DTYPE_UINT8 ? ((const uint8_t*)row)[j] : ((const int16_t*)row)[j];
+        out[j] = offset[j] + scale[j] * q;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Dense Dataset
+
+/**
+ * @note newDenseDataset() allocates an owned DenseDataset whose feature matrix and label column are both aligned to
+ * DATASET_ALIGNMENT bytes, the same layout as a mapped dataset file
+ * @param numRows number of rows
+ * @param numFeatures number of features per row
+ * @param numClasses number of classes
+*/
+DenseDataset* newDenseDataset(uint64_t numRows, int numFeatures, int numClasses){
+
+    DenseDataset* dataset = (DenseDataset*)malloc(sizeof(DenseDataset));
+    assert(dataset != NULL);
+
+    dataset->numRows = numRows;
+    dataset->numFeatures = numFeatures;
+    dataset->numClasses = numClasses;
+
+    // aligned_alloc requires a multiple of the alignment, which also keeps empty datasets valid
+    dataset->features = (float*)aligned_alloc(DATASET_ALIGNMENT, alignOffset(numRows * numFeatures * sizeof(float) + 1));
+    dataset->labels = (int32_t*)aligned_alloc(DATASET_ALIGNMENT, alignOffset(numRows * sizeof(int32_t) + 1));
+    assert(dataset->features != NULL && dataset->labels != NULL);
+
+    dataset->mapping = NULL;
+    dataset->mapLen = 0;
+
+    dataset->dtype = DTYPE_FLOAT32;
+    dataset->quantFeatures = NULL;
+    dataset->scale = NULL;
+    dataset->offset = NULL;
+
+    return dataset;
+}
+
+/**
+ * @note openDenseDataset() maps a binary dataset file read only and returns a DenseDataset pointing into the mapping
+ * @dev nothing is read up front apart from the header, so opening is O(1) in the size of the dataset. Pages are faulted
+ * in from the page cache as rows are touched and can be evicted by the OS, so datasets larger than RAM work as well.
+ * Labels are not checked against numClasses since that would read every row, call verifyDenseDataset() where that cost
+ * is acceptable.
+ * @dev quantized files are mapped as is, their rows are dequantized by gatherBatch()
+ * @param path the binary dataset file
+ * @return the DenseDataset, or NULL if the file could not be opened or is not a valid dataset
+*/
+DenseDataset* openDenseDataset(const char* path){
+    assert(path != NULL);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0){
+        printf("Error: could not open %s\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0){
+        printf("Error: could not stat %s\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    // validate the header and that the file holds every block it describes
+    DatasetHeader header;
+    ssize_t headerBytes = pread(fd, &header, sizeof(DatasetHeader), 0);
+
+    int valid = headerBytes == sizeof(DatasetHeader) &&
+        validateDatasetHeader(&header) &&
+        validateDatasetLayout(&header, st.st_size);
+
+    if (!valid){
+        printf("Error: %s is not a valid dataset file\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED){
+        printf("Error: could not map %s\n", path);
+        return NULL;
+    }
+
+    DenseDataset* dataset = (DenseDataset*)malloc(sizeof(DenseDataset));
+    assert(dataset != NULL);
+
+    dataset->numRows = header.numRows;
+    dataset->numFeatures = header.numFeatures;
+    dataset->numClasses = header.numClasses;
+    dataset->labels = (int32_t*)((char*)mapping + header.labelsOffset);
+    dataset->mapping = mapping;
+    dataset->mapLen = st.st_size;
+    dataset->dtype = header.dtype;
+
+    if (header.dtype == DTYPE_FLOAT32){
+
+        dataset->features = (float*)((char*)mapping + header.featuresOffset);
+        dataset->quantFeatures = NULL;
+        dataset->scale = NULL;
+        dataset->offset = NULL;
+    }else{
+
+        dataset->features = NULL;
+        dataset->quantFeatures = (char*)mapping + header.featuresOffset;
+        dataset->scale = (const float*)((char*)mapping + header.quantOffset);
+        dataset->offset = dataset->scale + header.numFeatures;
+    }
+
+    return dataset;
+}
+
+/**
+ * @note verifyDenseDataset() checks that every label of a dataset is a class id in [0, numClasses)
+ * @dev reads the whole label column, 4 bytes per row
+ * @return 1 if every label is valid, 0 otherwise
+*/
+int verifyDenseDataset(DenseDataset* dataset){
+    assert(dataset != NULL);
+
+    for (uint64_t row=0; row<dataset->numRows; row++){
+
+        if (dataset->labels[row] < 0 || dataset->labels[row] >= dataset->numClasses){
+
+            printf("Error: row %llu has label %d outside [0, %d)\n", (unsigned long long)row, dataset->labels[row], dataset->numClasses);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @note freeDenseDataset() unmaps or frees the arrays of a DenseDataset and the struct itself
+ * @param dataset ptr to a DenseDataset ptr, set to NULL
+*/
+void freeDenseDataset(DenseDataset** dataset){
+    assert(dataset != NULL && *dataset != NULL);
+
+    if ((*dataset)->mapping != NULL){
+        munmap((*dataset)->mapping, (*dataset)->mapLen);
+    }else{
+        free((*dataset)->features);
+        free((*dataset)->labels);
+    }
+
+    free(*dataset);
+    *dataset = NULL;
+}
+
+/**
+ * @note getFeatureRow() returns a ptr to the features of a row, no copy is made
+ * @dev only float32 datasets hold rows that can be pointed to, use gatherBatch() for quantized datasets
+*/
+const float* getFeatureRow(DenseDataset* dataset, uint64_t row){
+    assert(dataset != NULL && row < dataset->numRows);
+    assert(dataset->dtype == DTYPE_FLOAT32);
+    return dataset->features + row * dataset->numFeatures;
+}
+
+/**
+ * @note gatherBatch() copies the rows at a set of indices into contiguous caller owned batch buffers
+ * @dev rows are contiguous in the dataset, so each row is one memcpy, or one dequantizeRow() for a quantized dataset
+ * @param dataset the DenseDataset
+ * @param rows indices of the rows to gather
+ * @param batchSize number of indices
+ * @param features batchSize x numFeatures buffer
+ * @param labels batchSize buffer
+*/
+void gatherBatch(DenseDataset* dataset, const uint64_t* rows, int batchSize, float* features, int32_t* labels){
+    assert(dataset != NULL && rows != NULL && features != NULL && labels != NULL);
+
+    size_t rowBytes = sizeof(float) * dataset->numFeatures;
+    size_t codeBytes = dtypeSize(dataset->dtype) * dataset->numFeatures;
+
+    for (int i=0; i<batchSize; i++){
+        assert(rows[i] < dataset->numRows);
+
+        float* out = features + (size_t)i * dataset->numFeatures;
+
+        if (dataset->dtype == DTYPE_FLOAT32){
+            memcpy(out, dataset->features + rows[i] * dataset->numFeatures, rowBytes);
+        }else{
+            const void* codes = (const char*)dataset->quantFeatures + rows[i] * codeBytes;
+            dequantizeRow(codes, dataset->numFeatures, dataset->dtype, dataset->scale, dataset->offset, out);
+        }
+
+        labels[i] = dataset->labels[rows[i]];
+        assert(labels[i] >= 0 && labels[i] < dataset->numClasses);
+    }
+}
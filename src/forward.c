@@ -17,7 +17,7 @@ Value** newOutputVector(int outputSize){
 
     // init values to 0 for dot product accumulatiaon
     for (int i=0; i<outputSize; i++){
-        output[i] = newValue(0, NULL, NO_ANCESTORS, "init output");
+        output[i] = newConstant(0, "init output");
         assert(output[i] != NULL);
     }
 
@@ -36,8 +36,12 @@ Value** MultiplyWeights(Layer* layer, Value** input, GraphStack* graphStack){
 
     // init output vector 
     Value** output = newOutputVector(layer->outputSize); 
-    // ! memory leak here from initial Value structs inside output vector created from newOutputVector(). not super 
-    // ! important at the moment, but worth noting that those Value's will not be part of the computational graph 
+
+    // the initial zero Values become ancestors of the first Add() of each dot product, push them to the graph 
+    // stack so they are released along with the rest of the graph
+    for (int i=0; i<layer->outputSize; i++){
+        pushGraphStack(graphStack, output[i]);
+    }
 
     // iterate over each output neuron
     for (int i=0; i<layer->outputSize; i++){
@@ -96,36 +100,76 @@ Value** ApplyReLU(Layer* layer, Value** input, GraphStack* graphStack){
 }
 
 
+/**
+ * @note ForwardLayer() computes the output of a single layer: ReLU(W * input + b)
+ * @param layer the layer to apply
+ * @param input input vecctor represented as array of Value struct ptrs 
+ * @param graphStack the graph stack the layer's operations are pushed to
+ * @return output vector represented as array of Value struct ptrs
+*/
+Value** ForwardLayer(Layer* layer, Value** input, GraphStack* graphStack){
+
+    Value** output = MultiplyWeights(layer, input, graphStack);
+    output = AddBias(layer, output, graphStack);
+    output = ApplyReLU(layer, output, graphStack);
+
+    return output;
+}
+
+
 /**
  * @note Forward() is used to perform the forward pass of an MLP struct. 
- * @dev 
- * 
+ * @dev if gradient checkpointing has been enabled with setCheckpointInterval(), the pass is delegated to 
+ * ForwardCheckpointed() and only the final segment of the graph is kept on the mlp's graph stack.
  * @returns an array of Value struct pointers representing the final output of the network
 */
 Value** Forward(MLP* mlp, Value** input){
 
-    // retrieve input layer
-    Layer* layer = mlp->inputLayer;
+    PROFILE_BEGIN(PHASE_FORWARD);
 
-    // compute output of first layer 
-    Value** output = MultiplyWeights(layer, input, mlp->graphStack);
-    output = AddBias(layer, output, mlp->graphStack);
-    output = ApplyReLU(layer, output, mlp->graphStack);
+    if (mlp->checkpointInterval > 0){
 
-    // move to next layer before starting loop
-    layer = layer->next;
+        Value** output = ForwardCheckpointed(mlp, input);
 
-    // compute next hidden states
+        PROFILE_END(PHASE_FORWARD);
+        return output;
+    }
+
+    // retrieve input layer
+    Layer* layer = mlp->inputLayer;
+    Value** output = input;
+
+    // compute hidden states layer by layer
     while(layer != NULL) {
 
-        // compute layer output
-        output = MultiplyWeights(layer, output, mlp->graphStack);
-        output = AddBias(layer, output, mlp->graphStack);
-        output = ApplyReLU(layer, output, mlp->graphStack);
+        output = ForwardLayer(layer, output, mlp->graphStack);
     
         // move up one layer
         layer = layer->next;
     }
 
+    PROFILE_END(PHASE_FORWARD);
+
     return output;
+}
+
+/**
+ * @note ForwardRow() performs the forward pass of an MLP struct on a row of a DenseDataset (or any contiguous float 
+ * feature vector), so datasets do not need to keep a Value struct per feature.
+ * @dev the row is wrapped in input Values that are pushed to the mlp's graph stack and released with the rest of the 
+ * graph by ZeroGrad()
+ * @param mlp the mlp to run
+ * @param row ptr to mlp->inputLayer->inputSize features, ie: from getFeatureRow()
+ * @returns an array of Value struct pointers representing the final output of the network
+*/
+Value** ForwardRow(MLP* mlp, const float* row){
+    assert(mlp != NULL && row != NULL);
+
+    for (int i=0; i<mlp->inputLayer->inputSize; i++){
+
+        mlp->inputRow[i] = newConstant(row[i], "input");
+        pushGraphStack(mlp->graphStack, mlp->inputRow[i]);
+    }
+
+    return Forward(mlp, mlp->inputRow);
 }
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "lib.h"
+
+// gradCheckpoint.c
+
+/**
+ * @note gradient checkpointing keeps only the activations at segment boundaries alive between Forward() and 
+ * Backward(). With a segment length of k layers in an mlp of depth L, the live graph is at most one segment 
+ * (k layers) plus L/k boundary vectors, which is minimized at k = sqrt(L) for O(sqrt(L)) peak graph memory.
+ * @dev the cost is one extra forward pass through every segment but the last, recomputed inside CheckpointBackward().
+ * Since a backward pass is roughly twice the work of a forward pass, a training step costs about 4/3 of an 
+ * uncheckpointed step when there are many segments.
+*/
+
+// ---------------------------------------------------------------------------------------------------------------------- Checkpoint Configuration
+
+/**
+ * @note sqrtCheckpointInterval() returns the segment length that minimizes peak graph memory for an mlp of a given depth
+ * @param numLayers the number of layers in the mlp
+ * @return ceil(sqrt(numLayers))
+*/
+int sqrtCheckpointInterval(int numLayers){
+    assert(numLayers > 0);
+
+    int interval = (int)sqrt((double)numLayers);
+    if (interval * interval < numLayers){
+        interval++;
+    }
+
+    return interval;
+}
+
+/**
+ * @note setCheckpointInterval() enables, reconfigures or disables gradient checkpointing on an mlp
+ * @dev must be called while the mlp's computational graph is empty (before Forward() or after ZeroGrad())
+ * @param mlp the mlp to configure
+ * @param interval number of layers per segment, NO_CHECKPOINTING to disable, or CHECKPOINT_SQRT to use 
+ * sqrtCheckpointInterval()
+*/
+void setCheckpointInterval(MLP* mlp, int interval){
+    assert(mlp != NULL);
+    assert(interval >= NO_CHECKPOINTING || interval == CHECKPOINT_SQRT);
+    assert(mlp->graphStack->len == 1);
+
+    // release any state from a previous configuration
+    releaseCheckpoints(mlp);
+    if (mlp->segmentInputs != NULL){
+        free(mlp->segmentInputs);
+        mlp->segmentInputs = NULL;
+    }
+
+    if (interval == CHECKPOINT_SQRT){
+        interval = sqrtCheckpointInterval(mlp->numLayers);
+    }
+
+    mlp->checkpointInterval = interval;
+    mlp->numSegments = 0;
+
+    // disabling releases the boundary stack as well
+    if (interval == NO_CHECKPOINTING){
+
+        if (mlp->checkpointStack != NULL){
+            graphPreservingStackRelease(&mlp->checkpointStack);
+        }
+        return;
+    }
+
+    // one entry per segment holding the input vector of that segment
+    mlp->numSegments = (mlp->numLayers + interval - 1) / interval;
+    mlp->segmentInputs = (Value***)calloc(mlp->numSegments, sizeof(Value**));
+    assert(mlp->segmentInputs != NULL);
+
+    if (mlp->checkpointStack == NULL){
+        mlp->checkpointStack = newGraphStack();
+    }
+}
+
+/**
+ * @note releaseCheckpoints() frees the segment boundary Values kept by the last ForwardCheckpointed() call
+ * @dev called by ZeroGrad(), the input vector of the first segment belongs to the caller and is not freed
+ * @param mlp the mlp to release the boundaries of
+*/
+void releaseCheckpoints(MLP* mlp){
+    assert(mlp != NULL);
+
+    if (mlp->checkpointStack == NULL || mlp->segmentInputs == NULL){
+        return;
+    }
+
+    // free the boundary Value structs
+    releaseGraph(mlp->checkpointStack);
+
+    // free the boundary arrays themselves
+    for (int segment=1; segment<mlp->numSegments; segment++){
+
+        if (mlp->segmentInputs[segment] != NULL){
+            free(mlp->segmentInputs[segment]);
+        }
+    }
+
+    memset(mlp->segmentInputs, 0, mlp->numSegments * sizeof(Value**));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Checkpointed Forward/Backward
+
+/**
+ * @note segmentStartLayer() returns the first layer of a segment
+*/
+Layer* segmentStartLayer(MLP* mlp, int segment){
+
+    Layer* layer = mlp->inputLayer;
+    for (int i=0; i<segment * mlp->checkpointInterval; i++){
+        layer = layer->next;
+    }
+
+    return layer;
+}
+
+/**
+ * @note ForwardCheckpointed() performs the forward pass of an mlp with gradient checkpointing enabled. 
+ * @dev every segment but the last is computed on a scratch GraphStack that is released once the segment's output 
+ * has been copied into detached boundary Values. The last segment is built on the mlp's own graph stack as usual, 
+ * so the loss and Backward() work unchanged up to the last boundary.
+ * @dev called by Forward() when mlp->checkpointInterval > 0
+ * @param mlp the mlp to run
+ * @param input input vector represented as an array of Value struct ptrs
+ * @returns an array of Value struct pointers representing the final output of the network
+*/
+Value** ForwardCheckpointed(MLP* mlp, Value** input){
+    assert(mlp != NULL && input != NULL);
+    assert(mlp->checkpointInterval > 0);
+
+    // boundaries from a previous pass that was never zeroed
+    releaseCheckpoints(mlp);
+
+    GraphStack* segmentStack = newGraphStack();
+
+    Layer* layer = mlp->inputLayer;
+    Value** output = input;
+
+    for (int segment=0; segment<mlp->numSegments; segment++){
+
+        mlp->segmentInputs[segment] = output;
+
+        // only the last segment keeps its graph
+        int isLastSegment = (segment == mlp->numSegments - 1);
+        GraphStack* stack = isLastSegment ? mlp->graphStack : segmentStack;
+
+        // compute the layers of the segment
+        int width = 0;
+        for (int i=0; i<mlp->checkpointInterval && layer != NULL; i++){
+
+            output = ForwardLayer(layer, output, stack);
+            width = layer->outputSize;
+            layer = layer->next;
+        }
+
+        if (!isLastSegment){
+
+            // detach the segment output into boundary leaves
+            Value** boundary = (Value**)malloc(width * sizeof(Value*));
+            assert(boundary != NULL);
+
+            for (int i=0; i<width; i++){
+                boundary[i] = newValue(output[i]->value, NULL, NO_ANCESTORS, "checkpoint");
+                pushGraphStack(mlp->checkpointStack, boundary[i]);
+            }
+
+            // drop the segment's graph
+            releaseGraph(segmentStack);
+            output = boundary;
+        }
+    }
+
+    graphPreservingStackRelease(&segmentStack);
+
+    return output;
+}
+
+/**
+ * @note CheckpointBackward() finishes backpropagation for an mlp run with ForwardCheckpointed(). 
+ * @dev Backward() on the loss only reaches the boundary leaves of the last segment. Walking the segments from last 
+ * to first, each one is recomputed from its input boundary, its outputs are seeded with the grads accumulated on 
+ * the following boundary, and the gradient is pushed back through it before its graph is released again.
+ * @dev call directly after Backward(), a no-op when checkpointing is disabled
+ * @param mlp the mlp to backpropagate through
+*/
+void CheckpointBackward(MLP* mlp){
+    assert(mlp != NULL);
+
+    if (mlp->checkpointInterval == NO_CHECKPOINTING || mlp->numSegments < 2){
+        return;
+    }
+
+    PROFILE_BEGIN(PHASE_RECOMPUTE);
+
+    GraphStack* segmentStack = newGraphStack();
+
+    for (int segment=mlp->numSegments - 2; segment>=0; segment--){
+
+        assert(mlp->segmentInputs[segment] != NULL);
+
+        // recompute the segment from its input boundary
+        Layer* layer = segmentStartLayer(mlp, segment);
+        Value** output = mlp->segmentInputs[segment];
+        int width = 0;
+
+        for (int i=0; i<mlp->checkpointInterval; i++){
+
+            output = ForwardLayer(layer, output, segmentStack);
+            width = layer->outputSize;
+            layer = layer->next;
+        }
+
+        // seed the recomputed outputs with the grads held by the next boundary
+        Value** boundary = mlp->segmentInputs[segment + 1];
+        for (int i=0; i<width; i++){
+            output[i]->grad = boundary[i]->grad;
+        }
+
+        backwardFromSeeds(output, width);
+
+        // drop the recomputed graph
+        releaseGraph(segmentStack);
+    }
+
+    graphPreservingStackRelease(&segmentStack);
+
+    PROFILE_END(PHASE_RECOMPUTE);
+}
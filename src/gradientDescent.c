@@ -2,6 +2,27 @@
 
 // gradientDescent.c
 
+/**
+ * @note StepLayer() applies the gradient descent learning rule to the weights and biases of one layer
+ * @param layer a ptr to the Layer to update in place
+ * @param lr the learning rate to use in the update rule
+*/
+void StepLayer(Layer* layer, double lr){
+    assert(layer != NULL);
+
+    // update weights
+    for (int i=0; i<(layer->inputSize * layer->outputSize); i++){
+        
+        layer->weights[i]->value -= lr * layer->weights[i]->grad;
+    }
+
+    // update biases
+    for (int i=0; i<layer->outputSize; i++){
+        
+        layer->biases[i]->value -= lr * layer->biases[i]->grad;
+    }
+}
+
 /**
  * @note Step() applies the gradient descent learning rule to an mlp 
  * @dev Step() is meant to be called directly after a call to Backward()
@@ -12,23 +33,11 @@
 void Step(MLP* mlp, double lr){
     assert(mlp != NULL);
 
-    // Retrieve input layer
-    Layer* layer = mlp->inputLayer;
-
-    while (layer != NULL){
+    PROFILE_BEGIN(PHASE_STEP);
 
-        // update weights
-        for (int i=0; i<(layer->inputSize * layer->outputSize); i++){
-            
-            layer->weights[i]->grad -= lr * layer->weights[i]->grad;
-        }
-
-        // update biases
-        for (int i=0; i<layer->outputSize; i++){
-            
-            layer->biases[i]->grad -= lr * layer->biases[i]->grad;
-        }
-
-        layer = layer->next;
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+        StepLayer(layer, lr);
     }
-}
\ No newline at end of file
+
+    PROFILE_END(PHASE_STEP);
+}
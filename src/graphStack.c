@@ -24,6 +24,8 @@ GraphStack* newGraphStack(void){
     
     stack->len = 1;
 
+    memTrackAlloc(MEM_GRAPH_NODES, 1, sizeof(GraphStack) + sizeof(GraphNode));
+
     return stack;
 }
 
@@ -49,6 +51,8 @@ void pushGraphStack(GraphStack* stack, Value* value){
     // update stack head
     stack->head = node;
     stack->len++;
+
+    memTrackAlloc(MEM_GRAPH_NODES, 1, sizeof(GraphNode));
 }
 
 /**
@@ -72,6 +76,7 @@ void popGraphStack(GraphStack* stack){
         
     }
     free(stack->head);  
+    memTrackFree(MEM_GRAPH_NODES, 1, sizeof(GraphNode));
 
     // adjust the head node
     stack->head = next;
@@ -114,6 +119,7 @@ void graphPreservingStackRelease(GraphStack** graphStack){
         GraphNode* next = graphNode->next;
 
         free(graphNode);
+        memTrackFree(MEM_GRAPH_NODES, 1, sizeof(GraphNode));
 
         // move forward 1 node
         graphNode = next;
@@ -122,5 +128,6 @@ void graphPreservingStackRelease(GraphStack** graphStack){
     // free graphStack indirect val, set to null
     free(*graphStack);
     *graphStack = NULL;
+    memTrackFree(MEM_GRAPH_NODES, 0, sizeof(GraphStack));
 }   
 
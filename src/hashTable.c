@@ -28,6 +28,8 @@ HashTable* newHashTable(int size){
         table->buckets[i] = NULL;
     }
 
+    memTrackAlloc(MEM_HASH_BUCKETS, 0, sizeof(HashTable) + sizeof(BucketNode*) * size);
+
     return table;
 }
 
@@ -60,6 +62,7 @@ void freeHashTable(HashTable** tablePtr){
 
             if (nodeToFree != NULL){
                 free(nodeToFree);
+                memTrackFree(MEM_HASH_BUCKETS, 1, sizeof(BucketNode));
             }        
         }
 
@@ -67,6 +70,8 @@ void freeHashTable(HashTable** tablePtr){
         (*tablePtr)->buckets[i] = NULL;
     }
 
+    memTrackFree(MEM_HASH_BUCKETS, 0, sizeof(HashTable) + sizeof(BucketNode*) * (*tablePtr)->size);
+
     // free buckets array ptr
     if ((*tablePtr)->buckets != NULL){
         free((*tablePtr)->buckets);
@@ -109,6 +114,8 @@ BucketNode* newBucketNode(Value* value){
     newNode->next = NULL;
     newNode->key = value;
 
+    memTrackAlloc(MEM_HASH_BUCKETS, 1, sizeof(BucketNode));
+
     return newNode;
 }
 
@@ -0,0 +1,374 @@
+#include "lib.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// inference.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Constructors
+
+/**
+ * @note initInferenceLayers() points the layers of a model at parameters laid out as described by a model file header
+ * @param model the model, numLayers and inputSize already set
+ * @param base start of the model file image, mapped or snapshotted
+ * @param layerInfo the layer table of the image
+*/
+void initInferenceLayers(InferenceModel* model, const char* base, const ModelLayerInfo* layerInfo){
+
+    model->layers = (InferenceLayer*)malloc(sizeof(InferenceLayer) * model->numLayers);
+    assert(model->layers != NULL);
+
+    int inputSize = model->inputSize;
+    model->maxWidth = inputSize;
+
+    for (int i=0; i<model->numLayers; i++){
+
+        InferenceLayer* layer = &model->layers[i];
+        layer->inputSize = inputSize;
+        layer->outputSize = layerInfo[i].outputSize;
+        layer->activation = layerInfo[i].activation;
+        layer->weights = (const double*)(base + layerInfo[i].offset);
+        layer->biases = layer->weights + (size_t)layer->inputSize * layer->outputSize;
+
+        model->maxWidth = layer->outputSize > model->maxWidth ? layer->outputSize : model->maxWidth;
+        inputSize = layer->outputSize;
+    }
+
+    model->outputSize = inputSize;
+}
+
+/**
+ * @note openInferenceModel() maps a model file written by saveMLP() read only and returns an InferenceModel whose 
+ * layers point into the mapping
+ * @dev only the header and layer table are read, so opening is O(1) in the size of the model. The checksum is not 
+ * verified since that would read every page, call verifyInferenceModel() where that cost is acceptable.
+ * @param path the model file
+ * @return the InferenceModel, or NULL if the file could not be opened or is not a valid model file
+*/
+InferenceModel* openInferenceModel(const char* path){
+    assert(path != NULL);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0){
+        printf("Error: could not open %s\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0){
+        printf("Error: could not stat %s\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void* mapping = st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    // validate the header and that the file holds every blob it describes
+    const ModelHeader* header = (const ModelHeader*)mapping;
+
+    int valid = mapping != MAP_FAILED &&
+        (uint64_t)st.st_size >= sizeof(ModelHeader) &&
+        validateModelHeader(header, st.st_size) &&
+        validateModelLayers(header, (const ModelLayerInfo*)((char*)mapping + header->layersOffset), st.st_size);
+
+    if (!valid){
+
+        printf("Error: %s is not a valid model file\n", path);
+        if (mapping != MAP_FAILED){
+            munmap(mapping, st.st_size);
+        }
+        return NULL;
+    }
+
+    InferenceModel* model = (InferenceModel*)malloc(sizeof(InferenceModel));
+    assert(model != NULL);
+
+    model->numLayers = header->numLayers;
+    model->inputSize = header->inputSize;
+    model->mapping = mapping;
+    model->mapLen = st.st_size;
+    model->params = NULL;
+    model->imageBytes = st.st_size;
+    model->checksum = header->checksum;
+
+    initInferenceLayers(model, (const char*)mapping, (const ModelLayerInfo*)((char*)mapping + header->layersOffset));
+
+    return model;
+}
+
+/**
+ * @note newInferenceModel() snapshots the current parameters of an MLP into an owned InferenceModel, in the same 
+ * layout as a model file, so training can go on while the snapshot serves predictions
+ * @dev the snapshot is a complete model file image, header and layer table included, so writing params to disk as is 
+ * produces a model file
+ * @param mlp the mlp to snapshot
+*/
+InferenceModel* newInferenceModel(MLP* mlp){
+    assert(mlp != NULL);
+
+    int* layerSizes = (int*)malloc(sizeof(int) * mlp->numLayers);
+    ModelLayerInfo* layerInfo = (ModelLayerInfo*)malloc(sizeof(ModelLayerInfo) * mlp->numLayers);
+    assert(layerSizes != NULL && layerInfo != NULL);
+
+    int numLayers = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+        layerSizes[numLayers++] = layer->outputSize;
+    }
+
+    ModelHeader header;
+    initModelHeader(&header, layerInfo, mlp->inputLayer->inputSize, layerSizes, numLayers);
+
+    // the image ends with the last blob
+    uint64_t lastInputSize = numLayers > 1 ? (uint64_t)layerSizes[numLayers - 2] : (uint64_t)header.inputSize;
+    uint64_t imageBytes = layerInfo[numLayers - 1].offset + (lastInputSize + 1) * layerSizes[numLayers - 1] * sizeof(double);
+
+    InferenceModel* model = (InferenceModel*)malloc(sizeof(InferenceModel));
+    assert(model != NULL);
+
+    model->numLayers = numLayers;
+    model->inputSize = header.inputSize;
+    model->mapping = NULL;
+    model->mapLen = 0;
+    model->imageBytes = imageBytes;
+    model->params = aligned_alloc(MODEL_ALIGNMENT, alignOffset(imageBytes));
+    assert(model->params != NULL);
+
+    // zero the alignment padding, the header and layer table are written once the checksum is known
+    memset(model->params, 0, alignOffset(imageBytes));
+
+    // copy every layer's weights and biases into its blob
+    uint64_t hash = MODEL_CHECKSUM_SEED;
+    int i = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next, i++){
+
+        double* blob = (double*)((char*)model->params + layerInfo[i].offset);
+        int numWeights = layer->inputSize * layer->outputSize;
+
+        for (int j=0; j<numWeights; j++){
+            blob[j] = layer->weights[j]->value;
+        }
+        for (int j=0; j<layer->outputSize; j++){
+            blob[numWeights + j] = layer->biases[j]->value;
+        }
+
+        hash = checksumParams(hash, blob, numWeights + layer->outputSize);
+    }
+    model->checksum = hash;
+
+    header.checksum = hash;
+    memcpy(model->params, &header, sizeof(ModelHeader));
+    memcpy((char*)model->params + header.layersOffset, layerInfo, sizeof(ModelLayerInfo) * numLayers);
+
+    initInferenceLayers(model, (const char*)model->params, layerInfo);
+
+    free(layerSizes);
+    free(layerInfo);
+
+    return model;
+}
+
+/**
+ * @note verifyInferenceModel() recomputes the checksum of every parameter of a model
+ * @return 1 if it matches the checksum of the model file, 0 otherwise
+*/
+int verifyInferenceModel(InferenceModel* model){
+    assert(model != NULL);
+
+    uint64_t hash = MODEL_CHECKSUM_SEED;
+
+    for (int i=0; i<model->numLayers; i++){
+
+        InferenceLayer* layer = &model->layers[i];
+        hash = checksumParams(hash, layer->weights, (size_t)layer->inputSize * layer->outputSize + layer->outputSize);
+    }
+
+    return hash == model->checksum;
+}
+
+/**
+ * @note freeInferenceModel() unmaps or frees the parameters of an InferenceModel and the struct itself
+ * @param model ptr to an InferenceModel ptr, set to NULL
+*/
+void freeInferenceModel(InferenceModel** model){
+    assert(model != NULL && *model != NULL);
+
+    if ((*model)->mapping != NULL){
+        munmap((*model)->mapping, (*model)->mapLen);
+    }
+    free((*model)->params);
+    free((*model)->layers);
+
+    free(*model);
+    *model = NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Forward
+
+/**
+ * @note forwardLayers() runs one row through the model without building a computational graph
+ * @dev activations ping-pong between the two halves of scratch, so nothing is allocated per call. Each dot product 
+ * sums in the same order as MultiplyWeights() and then adds the bias as AddBias() does, so the outputs match Forward().
+ * @param model the InferenceModel
+ * @param row model->inputSize features
+ * @param scratch 2 * model->maxWidth doubles owned by the caller, one per concurrent caller
+ * @return the model->outputSize outputs of the last layer, in whichever half of scratch they ended up
+*/
+const double* forwardLayers(InferenceModel* model, const float* row, double* scratch){
+    assert(model != NULL && row != NULL && scratch != NULL);
+
+    double* in = scratch;
+    double* out = scratch + model->maxWidth;
+
+    for (int j=0; j<model->inputSize; j++){
+        in[j] = row[j];
+    }
+
+    for (int l=0; l<model->numLayers; l++){
+
+        InferenceLayer* layer = &model->layers[l];
+
+        for (int i=0; i<layer->outputSize; i++){
+
+            const double* weightRow = layer->weights + (size_t)i * layer->inputSize;
+
+            double sum = 0;
+            for (int j=0; j<layer->inputSize; j++){
+                sum += weightRow[j] * in[j];
+            }
+            sum = layer->biases[i] + sum;
+
+            out[i] = sum > 0 ? sum : 0;
+        }
+
+        double* temp = in;
+        in = out;
+        out = temp;
+    }
+
+    return in;
+}
+
+/**
+ * @note forwardInference() runs one row through the model with forwardLayers() and copies out the outputs
+ * @param scratch 2 * model->maxWidth doubles owned by the caller, one per concurrent caller
+ * @param output model->outputSize doubles, the outputs of the last layer
+*/
+void forwardInference(InferenceModel* model, const float* row, double* scratch, double* output){
+    assert(output != NULL);
+    memcpy(output, forwardLayers(model, row, scratch), sizeof(double) * model->outputSize);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Inference Context
+
+/**
+ * @note newInferenceContext() allocates the working memory of one thread running a model, the only allocation of the
+ * inference path
+ * @dev one aligned block holds the two ping-pong activation buffers of model->maxWidth doubles followed by the 
+ * model->outputSize outputs, so a context is a fixed footprint of (2 * maxWidth + outputSize) doubles
+ * @param model the InferenceModel, outlives the context
+*/
+InferenceContext* newInferenceContext(InferenceModel* model){
+    assert(model != NULL);
+
+    InferenceContext* context = (InferenceContext*)malloc(sizeof(InferenceContext));
+    assert(context != NULL);
+
+    size_t bytes = sizeof(double) * (2 * (size_t)model->maxWidth + model->outputSize);
+    double* buffer = (double*)aligned_alloc(MODEL_ALIGNMENT, alignOffset(bytes));
+    assert(buffer != NULL);
+
+    context->model = model;
+    context->ping = buffer;
+    context->pong = buffer + model->maxWidth;
+    context->output = buffer + 2 * model->maxWidth;
+    context->latency = NULL;
+
+    return context;
+}
+
+/**
+ * @note freeInferenceContext() frees the buffers of a context and the struct itself
+ * @param context ptr to an InferenceContext ptr, set to NULL
+*/
+void freeInferenceContext(InferenceContext** context){
+    assert(context != NULL && *context != NULL);
+
+    free((*context)->ping);
+    free((*context)->latency);
+    free(*context);
+    *context = NULL;
+}
+
+/**
+ * @note forwardContext() runs one row through the context's model without touching the heap
+ * @return context->output, the model->outputSize outputs valid until the next call
+*/
+const double* forwardContext(InferenceContext* context, const float* row){
+    assert(context != NULL);
+
+    long long start = context->latency != NULL ? profileNow() : 0;
+
+    forwardInference(context->model, row, context->ping, context->output);
+
+    if (context->latency != NULL){
+        recordLatency(context->latency, profileNow() - start);
+    }
+
+    return context->output;
+}
+
+/**
+ * @note predictContext() runs one row through the context's model and returns its class without touching the heap
+ * @param probs where to write the model->outputSize softmax probabilities, or NULL
+ * @return the argmax class of the row
+*/
+int32_t predictContext(InferenceContext* context, const float* row, double* probs){
+    assert(context != NULL);
+
+    long long start = context->latency != NULL ? profileNow() : 0;
+
+    int32_t label;
+    forwardInference(context->model, row, context->ping, context->output);
+    predictOutputs(context->output, context->model->outputSize, &label, probs);
+
+    if (context->latency != NULL){
+        recordLatency(context->latency, profileNow() - start);
+    }
+
+    return label;
+}
+
+/**
+ * @note enableContextLatency() starts recording the latency of every forwardContext() and predictContext() call of a 
+ * context. The histogram is allocated here, so the calls themselves still never touch the heap.
+*/
+void enableContextLatency(InferenceContext* context){
+    assert(context != NULL);
+
+    if (context->latency == NULL){
+
+        context->latency = (LatencyHistogram*)malloc(sizeof(LatencyHistogram));
+        assert(context->latency != NULL);
+        resetLatencyHistogram(context->latency);
+    }
+}
+
+/**
+ * @note mergeContextLatencies() merges the per call latencies of the contexts of every thread into one histogram
+ * @dev read between calls, as a context's histogram has no synchronization with its thread. Contexts without latency 
+ * recording are skipped.
+ * @param histogram reset, then filled with the merged latencies
+*/
+void mergeContextLatencies(InferenceContext** contexts, int numContexts, LatencyHistogram* histogram){
+    assert(contexts != NULL && histogram != NULL);
+
+    resetLatencyHistogram(histogram);
+
+    for (int i=0; i<numContexts; i++){
+        if (contexts[i]->latency != NULL){
+            mergeLatencyHistogram(histogram, contexts[i]->latency);
+        }
+    }
+}
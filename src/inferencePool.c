@@ -0,0 +1,255 @@
+#include "lib.h"
+#include <unistd.h>
+
+// inferencePool.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Prediction
+
+/**
+ * @note predictOutputs() writes the argmax and/or softmax probabilities of the outputs of a forward pass
+ * @dev the softmax subtracts the largest output before exponentiating, so it does not overflow on large outputs. Ties 
+ * in the argmax go to the lowest class.
+ * @param output outputSize outputs of the last layer
+ * @param label where to write the argmax, or NULL
+ * @param probs where to write outputSize probabilities, or NULL
+*/
+void predictOutputs(const double* output, int outputSize, int32_t* label, double* probs){
+
+    int32_t argmax = 0;
+    for (int i=1; i<outputSize; i++){
+        argmax = output[i] > output[argmax] ? i : argmax;
+    }
+
+    if (label != NULL){
+        *label = argmax;
+    }
+
+    if (probs != NULL){
+
+        double expSum = 0;
+        for (int i=0; i<outputSize; i++){
+            probs[i] = exp(output[i] - output[argmax]);
+            expSum += probs[i];
+        }
+        for (int i=0; i<outputSize; i++){
+            probs[i] /= expSum;
+        }
+    }
+}
+
+/**
+ * @note predictRow() runs one row through the model and writes its argmax and/or softmax probabilities
+ * @param scratch 2 * model->maxWidth + model->outputSize doubles, the outputs being written after the activations
+ * @param label where to write the argmax, or NULL
+ * @param probs where to write model->outputSize probabilities, or NULL
+*/
+void predictRow(InferenceModel* model, const float* row, double* scratch, int32_t* label, double* probs){
+
+    double* output = scratch + 2 * model->maxWidth;
+    forwardInference(model, row, scratch, output);
+    predictOutputs(output, model->outputSize, label, probs);
+}
+
+/**
+ * @note runPredictChunks() claims chunks of the current batch until none are left and predicts their rows
+*/
+void runPredictChunks(InferencePool* pool, PoolWorker* worker){
+
+    InferenceModel* model = pool->model;
+
+    // only this worker touches its scratch, so it can grow it without locking
+    size_t scratchLen = 2 * (size_t)model->maxWidth + model->outputSize;
+    if (worker->scratchLen < scratchLen){
+
+        free(worker->scratch);
+        worker->scratch = (double*)malloc(sizeof(double) * scratchLen);
+        assert(worker->scratch != NULL);
+        worker->scratchLen = scratchLen;
+    }
+
+    int64_t begin;
+    while ((begin = atomic_fetch_add_explicit(&pool->nextRow, PREDICT_CHUNK_ROWS, memory_order_relaxed)) < pool->numRows){
+
+        int64_t end = begin + PREDICT_CHUNK_ROWS < pool->numRows ? begin + PREDICT_CHUNK_ROWS : pool->numRows;
+
+        for (int64_t row=begin; row<end; row++){
+
+            predictRow(
+                model,
+                pool->features + row * model->inputSize,
+                worker->scratch,
+                pool->labels != NULL ? pool->labels + row : NULL,
+                pool->probs != NULL ? pool->probs + row * model->outputSize : NULL
+            );
+        }
+    }
+}
+
+/**
+ * @note predictBatch() predicts numRows rows on every worker of the pool and returns once all are written
+ * @dev rows are independent, so results are the same for any number of workers
+ * @dev with latencies enabled the call is timed into the histogram of its batch size, which has a single writer since 
+ * the pool predicts one batch at a time
+ * @param pool the InferencePool, one predictBatch() at a time
+ * @param model the InferenceModel
+ * @param features row major numRows x model->inputSize matrix
+ * @param labels numRows argmax classes, or NULL
+ * @param probs row major numRows x model->outputSize softmax probabilities, or NULL
+*/
+void predictBatch(InferencePool* pool, InferenceModel* model, const float* features, int64_t numRows, int32_t* labels, double* probs){
+    assert(pool != NULL && model != NULL && (features != NULL || numRows == 0) && numRows >= 0);
+
+    if (numRows == 0){
+        return;
+    }
+
+    long long start = pool->latencies != NULL ? profileNow() : 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->model = model;
+    pool->features = features;
+    pool->numRows = numRows;
+    pool->labels = labels;
+    pool->probs = probs;
+    atomic_store_explicit(&pool->nextRow, 0, memory_order_relaxed);
+
+    pool->active = pool->numWorkers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+
+    pthread_mutex_unlock(&pool->lock);
+
+    runPredictChunks(pool, &pool->workers[0]);
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->active--;
+    while (pool->active > 0){
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    if (pool->latencies != NULL){
+        recordBatchLatency(pool->latencies, numRows, profileNow() - start);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Pool
+
+/**
+ * @note poolThread() is the pthread body of a worker, it predicts its share of every batch published to the pool
+*/
+void* poolThread(void* arg){
+
+    PoolWorker* worker = (PoolWorker*)arg;
+    InferencePool* pool = worker->pool;
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (1){
+
+        while (pool->generation == generation && !pool->stop){
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stop){
+            break;
+        }
+        generation = pool->generation;
+
+        pthread_mutex_unlock(&pool->lock);
+        runPredictChunks(pool, worker);
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->active == 0){
+            pthread_cond_signal(&pool->done);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * @note newInferencePool() starts the worker threads of an InferencePool
+ * @param numThreads number of threads predicting a batch, the caller included. 0 uses every online core.
+*/
+InferencePool* newInferencePool(int numThreads){
+    assert(numThreads >= 0);
+
+    if (numThreads == 0){
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = cores > 0 ? (int)cores : 1;
+    }
+
+    InferencePool* pool = (InferencePool*)calloc(1, sizeof(InferencePool));
+    assert(pool != NULL);
+
+    pool->numWorkers = numThreads;
+    pool->workers = (PoolWorker*)calloc(numThreads, sizeof(PoolWorker));
+    assert(pool->workers != NULL);
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (int i=0; i<numThreads; i++){
+
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+
+        if (i > 0){
+            int status = pthread_create(&pool->workers[i].thread, NULL, poolThread, &pool->workers[i]);
+            assert(status == 0);
+        }
+    }
+
+    return pool;
+}
+
+/**
+ * @note freeInferencePool() stops and joins the workers and frees the pool
+ * @param pool ptr to an InferencePool ptr, set to NULL
+*/
+void freeInferencePool(InferencePool** pool){
+    assert(pool != NULL && *pool != NULL);
+
+    pthread_mutex_lock(&(*pool)->lock);
+    (*pool)->stop = 1;
+    pthread_cond_broadcast(&(*pool)->start);
+    pthread_mutex_unlock(&(*pool)->lock);
+
+    for (int i=0; i<(*pool)->numWorkers; i++){
+
+        if (i > 0){
+            pthread_join((*pool)->workers[i].thread, NULL);
+        }
+        free((*pool)->workers[i].scratch);
+    }
+
+    if ((*pool)->latencies != NULL){
+        freeBatchLatencies(&(*pool)->latencies);
+    }
+
+    pthread_mutex_destroy(&(*pool)->lock);
+    pthread_cond_destroy(&(*pool)->start);
+    pthread_cond_destroy(&(*pool)->done);
+
+    free((*pool)->workers);
+    free(*pool);
+    *pool = NULL;
+}
+
+/**
+ * @note enablePoolLatencies() starts recording the latency of every predictBatch() call of a pool by batch size, read 
+ * pool->latencies between calls or write it out with writeBatchLatencies()
+*/
+void enablePoolLatencies(InferencePool* pool){
+    assert(pool != NULL);
+
+    if (pool->latencies == NULL){
+        pool->latencies = newBatchLatencies();
+    }
+}
@@ -0,0 +1,248 @@
+#include "lib.h"
+
+// latencyHistogram.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Buckets
+
+/**
+ * @note latencyBucket() returns the bucket of a value. Values below LATENCY_SUB_BUCKETS get a bucket each, above that 
+ * a value with its highest set bit at e lands in row e - LATENCY_SUB_BITS + 1 at the LATENCY_SUB_BITS bits below e.
+ * @dev values of 2^LATENCY_MAX_EXPONENT ns and above are clamped into the last bucket
+*/
+int latencyBucket(uint64_t ns){
+
+    if (ns < LATENCY_SUB_BUCKETS){
+        return (int)ns;
+    }
+
+    int exponent = 63 - __builtin_clzll(ns);
+    if (exponent >= LATENCY_MAX_EXPONENT){
+        return LATENCY_NUM_BUCKETS - 1;
+    }
+
+    int shift = exponent - LATENCY_SUB_BITS;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + (int)(ns >> shift) - LATENCY_SUB_BUCKETS;
+}
+
+/**
+ * @note bucketLowerBound() returns the smallest value of a bucket
+*/
+uint64_t bucketLowerBound(int bucket){
+    assert(bucket >= 0 && bucket < LATENCY_NUM_BUCKETS);
+
+    if (bucket < LATENCY_SUB_BUCKETS){
+        return bucket;
+    }
+
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t mantissa = LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS;
+
+    return mantissa << shift;
+}
+
+/**
+ * @note bucketUpperBound() returns the largest value of a bucket
+*/
+uint64_t bucketUpperBound(int bucket){
+    assert(bucket >= 0 && bucket < LATENCY_NUM_BUCKETS);
+
+    if (bucket < LATENCY_SUB_BUCKETS){
+        return bucket;
+    }
+
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    return bucketLowerBound(bucket) + (1ULL << shift) - 1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Recording
+
+/**
+ * @note resetLatencyHistogram() clears a histogram
+*/
+void resetLatencyHistogram(LatencyHistogram* histogram){
+    assert(histogram != NULL);
+
+    memset(histogram, 0, sizeof(LatencyHistogram));
+    histogram->min = UINT64_MAX;
+}
+
+/**
+ * @note recordLatency() counts one value, from the histogram's owning thread only
+*/
+void recordLatency(LatencyHistogram* histogram, uint64_t ns){
+
+    histogram->counts[latencyBucket(ns)]++;
+    histogram->count++;
+    histogram->sum += ns;
+    histogram->min = ns < histogram->min ? ns : histogram->min;
+    histogram->max = ns > histogram->max ? ns : histogram->max;
+}
+
+/**
+ * @note mergeLatencyHistogram() adds the counts of src to dst, the result being what recording every value of both 
+ * into one histogram would give
+*/
+void mergeLatencyHistogram(LatencyHistogram* dst, const LatencyHistogram* src){
+    assert(dst != NULL && src != NULL);
+
+    for (int i=0; i<LATENCY_NUM_BUCKETS; i++){
+        dst->counts[i] += src->counts[i];
+    }
+
+    dst->count += src->count;
+    dst->sum += src->sum;
+    dst->min = src->min < dst->min ? src->min : dst->min;
+    dst->max = src->max > dst->max ? src->max : dst->max;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Queries
+
+/**
+ * @note latencyPercentile() returns the nearest rank percentile of the recorded values
+ * @dev the value is the upper bound of the bucket holding the rank, clamped to the exact max, so it is never below the
+ * true percentile and at most 1/32 above it
+ * @param p percentile in [0, 100], eg: 99.9
+ * @return the percentile in ns, 0 for an empty histogram
+*/
+uint64_t latencyPercentile(const LatencyHistogram* histogram, double p){
+    assert(histogram != NULL && p >= 0 && p <= 100);
+
+    if (histogram->count == 0){
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)ceil(p / 100.0 * histogram->count);
+    rank = rank < 1 ? 1 : rank;
+
+    uint64_t seen = 0;
+    for (int i=0; i<LATENCY_NUM_BUCKETS; i++){
+
+        seen += histogram->counts[i];
+        if (seen >= rank){
+
+            uint64_t upper = bucketUpperBound(i);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+/**
+ * @note latencyMean() returns the exact mean of the recorded values, 0 for an empty histogram
+*/
+double latencyMean(const LatencyHistogram* histogram){
+    assert(histogram != NULL);
+    return histogram->count > 0 ? (double)histogram->sum / histogram->count : 0;
+}
+
+/**
+ * @note writeLatencyHistogram() writes a summary line and every non empty bucket of a histogram
+ * @dev the format is "# name count=N mean=... p50=... p90=... p99=... p999=... max=..." followed by one
+ * "lower upper count cumulative_fraction" line per non empty bucket, in ns
+*/
+void writeLatencyHistogram(const LatencyHistogram* histogram, const char* name, FILE* file){
+    assert(histogram != NULL && name != NULL && file != NULL);
+
+    fprintf(file, "# %s count=%llu mean=%.1lf p50=%llu p90=%llu p99=%llu p999=%llu max=%llu\n",
+        name,
+        (unsigned long long)histogram->count,
+        latencyMean(histogram),
+        (unsigned long long)latencyPercentile(histogram, 50),
+        (unsigned long long)latencyPercentile(histogram, 90),
+        (unsigned long long)latencyPercentile(histogram, 99),
+        (unsigned long long)latencyPercentile(histogram, 99.9),
+        (unsigned long long)(histogram->count > 0 ? histogram->max : 0));
+
+    uint64_t seen = 0;
+    for (int i=0; i<LATENCY_NUM_BUCKETS; i++){
+
+        if (histogram->counts[i] == 0){
+            continue;
+        }
+
+        seen += histogram->counts[i];
+        fprintf(file, "%llu %llu %llu %.6lf\n",
+            (unsigned long long)bucketLowerBound(i),
+            (unsigned long long)bucketUpperBound(i),
+            (unsigned long long)histogram->counts[i],
+            (double)seen / histogram->count);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Batch Sizes
+
+/**
+ * @note newBatchLatencies() allocates an empty histogram per batch size class
+*/
+BatchLatencies* newBatchLatencies(void){
+
+    BatchLatencies* latencies = (BatchLatencies*)malloc(sizeof(BatchLatencies));
+    assert(latencies != NULL);
+
+    for (int c=0; c<LATENCY_BATCH_CLASSES; c++){
+        resetLatencyHistogram(&latencies->classes[c]);
+    }
+
+    return latencies;
+}
+
+/**
+ * @note freeBatchLatencies() frees a BatchLatencies
+ * @param latencies ptr to a BatchLatencies ptr, set to NULL
+*/
+void freeBatchLatencies(BatchLatencies** latencies){
+    assert(latencies != NULL && *latencies != NULL);
+
+    free(*latencies);
+    *latencies = NULL;
+}
+
+/**
+ * @note batchSizeClass() returns the batch size class of a batch, floor(log2(numRows)) capped to the last class
+*/
+int batchSizeClass(int64_t numRows){
+    assert(numRows > 0);
+
+    int c = 63 - __builtin_clzll((uint64_t)numRows);
+    return c < LATENCY_BATCH_CLASSES ? c : LATENCY_BATCH_CLASSES - 1;
+}
+
+/**
+ * @note recordBatchLatency() records the latency of a batch in the histogram of its batch size class
+*/
+void recordBatchLatency(BatchLatencies* latencies, int64_t numRows, uint64_t ns){
+    recordLatency(&latencies->classes[batchSizeClass(numRows)], ns);
+}
+
+/**
+ * @note writeBatchLatencies() writes the histogram of every batch size class that recorded a batch to a file
+ * @return 1 on success, 0 if the file could not be written
+*/
+int writeBatchLatencies(const BatchLatencies* latencies, const char* path){
+    assert(latencies != NULL && path != NULL);
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL){
+        printf("Error: could not open %s\n", path);
+        return 0;
+    }
+
+    for (int c=0; c<LATENCY_BATCH_CLASSES; c++){
+
+        if (latencies->classes[c].count == 0){
+            continue;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "batch %lld+", 1LL << c);
+        writeLatencyHistogram(&latencies->classes[c], name, file);
+    }
+
+    int ok = fclose(file) == 0;
+    if (!ok){
+        printf("Error: could not write %s\n", path);
+    }
+
+    return ok;
+}
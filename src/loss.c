@@ -8,12 +8,15 @@
  * @dev Softmax() is not being considered an autograd operation by itself, instead it is considered a helper function for 
  * categoricalCrossEntropy(). For this reason there is no direct softmaxBackward() function for computing partial derivatives 
  * for Softmax().
+ * @dev opens PHASE_LOSS, which the cross entropy function closes, so softmax and loss are one call per example
  * @param valueArr an array of Value struct pointers to apply softmax to
  * @param lenArr length of each array
  * @return a dynamically allocated array of the softmax outputs
 */
 double* Softmax(Value** valueArr, int lenArr){
 
+    PROFILE_OPEN(PHASE_LOSS);
+
     // allocate memory for sotmax array
     double* softmax = malloc(sizeof(double) * lenArr);
     assert(softmax != NULL);
@@ -42,6 +45,50 @@ void freeSoftmax(double** softmaxArr){
     *softmaxArr = NULL;
 }
 
+/**
+ * @note newOneHotTargets() creates a table of one hot target vectors indexed by class, so a dataset of int32 class 
+ * labels can be passed to categoricalCrossEntropy() as targets[label] without keeping target Values per example
+ * @param numClasses number of classes
+ * @return numClasses arrays of numClasses Value struct ptrs
+*/
+Value*** newOneHotTargets(int numClasses){
+
+    Value*** targets = (Value***)malloc(sizeof(Value**) * numClasses);
+    assert(targets != NULL);
+
+    for (int label=0; label<numClasses; label++){
+
+        targets[label] = (Value**)malloc(sizeof(Value*) * numClasses);
+        assert(targets[label] != NULL);
+
+        for (int class=0; class<numClasses; class++){
+            targets[label][class] = newConstant(class == label, "target");
+        }
+    }
+
+    return targets;
+}
+
+/**
+ * @note freeOneHotTargets() frees a table created by newOneHotTargets()
+ * @param targets ptr to the table, set to NULL
+ * @param numClasses number of classes the table was created with
+*/
+void freeOneHotTargets(Value**** targets, int numClasses){
+    assert(targets != NULL && *targets != NULL);
+
+    for (int label=0; label<numClasses; label++){
+
+        for (int class=0; class<numClasses; class++){
+            freeValue(&(*targets)[label][class]);
+        }
+        free((*targets)[label]);
+    }
+
+    free(*targets);
+    *targets = NULL;
+}
+
 /**
  * @note categoricalCrossEntropyBackward() computes the gradient of the single value output from categoricalCrossEntropy()
  * wrt to its immediate ancestors. 
@@ -50,14 +97,16 @@ void freeSoftmax(double** softmaxArr){
  * @param v a Value struct ptr that is the output of categoricalCrossEntropy() 
  * @param softmaxOutput an array of doubles containing the outputs to softmax(mlp output)
  * @param targetsArr traget vector array
+ * @param label unused, see sparseCategoricalCrossEntropyBackward()
 */
-void categoricalCrossEntropyBackward(Value* v, double* softmaxOutput, Value** targetsArr, int lenArr){
+void categoricalCrossEntropyBackward(Value* v, double* softmaxOutput, Value** targetsArr, int label, int lenArr){
     assert(v!= NULL);
     assert(v->ancestors != NULL);
+    (void)label;
 
     // Propagate the gradient to all ancestors
     for(int i = 0; i<lenArr; i++){
-        if (v->ancestors[i] != NULL){
+        if (v->ancestors[i] != NULL && v->ancestors[i]->requiresGrad){
 
             // apply chain rule
             v->ancestors[i]->grad += v->grad * (softmaxOutput[i] - targetsArr[i]->value);
@@ -108,5 +157,62 @@ Value* categoricalCrossEntropy(
     // set backward function ptr 
     loss->BackwardLoss = categoricalCrossEntropyBackward;
 
+    PROFILE_CLOSE(PHASE_LOSS);
+
+    return loss;
+}
+
+/**
+ * @note sparseCategoricalCrossEntropyBackward() computes the gradient of the output of sparseCategoricalCrossEntropy() 
+ * wrt to its immediate ancestors. With a one hot target every partial derivative is the softmax probability, minus 1 
+ * at the target class only.
+ * @param v a Value struct ptr that is the output of sparseCategoricalCrossEntropy() 
+ * @param softmaxOutput an array of doubles containing the outputs to softmax(mlp output)
+ * @param targetsArr unused, the target is given by label
+ * @param label index of the target class
+*/
+void sparseCategoricalCrossEntropyBackward(Value* v, double* softmaxOutput, Value** targetsArr, int label, int lenArr){
+    assert(v != NULL);
+    assert(v->ancestors != NULL);
+    assert(label >= 0 && label < lenArr);
+    (void)targetsArr;
+
+    for (int i = 0; i<lenArr; i++){
+        if (v->ancestors[i] != NULL && v->ancestors[i]->requiresGrad){
+            v->ancestors[i]->grad += v->grad * softmaxOutput[i];
+        }
+    }
+
+    // the only non zero target
+    if (v->ancestors[label]->requiresGrad){
+        v->ancestors[label]->grad -= v->grad;
+    }
+}
+
+/**
+ * @note sparseCategoricalCrossEntropy() is categoricalCrossEntropy() for a target given as a class index rather than 
+ * a one hot vector of Value structs. The loss is a single log lookup, -log(softmax[label]), and no target Values need 
+ * to exist at all. Backpropagate the result with BackwardSparse().
+ * @param outputArr is the output vector array of an MLP struct that is the same length as the number of classes
+ * @param label index of the target class
+ * @param softmaxOutput the Softmax() of outputArr
+ * @param lenArr is the length of both outputArr and softmaxOutput
+ * @param graphStack is the graph stack of the mlp of which the outputArr came from
+*/
+Value* sparseCategoricalCrossEntropy(
+    Value** outputArr, 
+    int label, 
+    double* softmaxOutput, 
+    int lenArr, 
+    GraphStack* graphStack
+    ){
+    assert(label >= 0 && label < lenArr);
+
+    Value* loss = newValue(-log(softmaxOutput[label]), outputArr, lenArr, "loss");
+    pushGraphStack(graphStack, loss);
+    loss->BackwardLoss = sparseCategoricalCrossEntropyBackward;
+
+    PROFILE_CLOSE(PHASE_LOSS);
+
     return loss;
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "lib.h"
+
+// memStats.c
+
+MemStats memStats = {0};
+
+// ---------------------------------------------------------------------------------------------------------------------- Accounting Hooks
+
+/**
+ * @note memTrackAlloc() records an allocation of count objects totalling bytes in a category, updating high water marks
+ * @param category the MemCategory of the allocation
+ * @param count the number of objects allocated (0 for supporting arrays/structs)
+ * @param bytes the number of bytes allocated
+*/
+void memTrackAlloc(MemCategory category, long long count, size_t bytes){
+    assert(category >= 0 && category < NUM_MEM_CATEGORIES);
+
+    MemCounter* counter = &memStats.categories[category];
+
+    counter->count += count;
+    counter->bytes += bytes;
+    memStats.totalBytes += bytes;
+
+    // update high water marks
+    if (counter->count > counter->peakCount){
+        counter->peakCount = counter->count;
+    }
+    if (counter->bytes > counter->peakBytes){
+        counter->peakBytes = counter->bytes;
+    }
+    if (memStats.totalBytes > memStats.peakTotalBytes){
+        memStats.peakTotalBytes = memStats.totalBytes;
+    }
+}
+
+/**
+ * @note memTrackFree() records the release of count objects totalling bytes in a category
+*/
+void memTrackFree(MemCategory category, long long count, size_t bytes){
+    assert(category >= 0 && category < NUM_MEM_CATEGORIES);
+
+    MemCounter* counter = &memStats.categories[category];
+
+    counter->count -= count;
+    counter->bytes -= bytes;
+    memStats.totalBytes -= bytes;
+}
+
+/**
+ * @note memTrackTransfer() moves already allocated objects from one category to another, ie: a Value created by 
+ * newValue() that becomes a weight owned by a Layer
+*/
+void memTrackTransfer(MemCategory from, MemCategory to, long long count, size_t bytes){
+
+    memTrackFree(from, count, bytes);
+    memTrackAlloc(to, count, bytes);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Queries
+
+/**
+ * @note getMemStats() copies the current counters into stats
+ * @dev cheap enough to call after every Forward()/Backward()
+ * @param stats ptr to a MemStats struct to fill
+*/
+void getMemStats(MemStats* stats){
+    assert(stats != NULL);
+    *stats = memStats;
+}
+
+/**
+ * @note resetMemPeaks() resets all high water marks to the current live values, so that the peaks of the next 
+ * training step can be measured in isolation
+*/
+void resetMemPeaks(void){
+
+    for (int i=0; i<NUM_MEM_CATEGORIES; i++){
+        memStats.categories[i].peakCount = memStats.categories[i].count;
+        memStats.categories[i].peakBytes = memStats.categories[i].bytes;
+    }
+    memStats.peakTotalBytes = memStats.totalBytes;
+}
+
+/**
+ * @note printMemStats() prints the live and peak counts/bytes of every category
+*/
+void printMemStats(void){
+
+    const char* names[NUM_MEM_CATEGORIES] = {"values", "graph nodes", "hash buckets", "parameters"};
+
+    for (int i=0; i<NUM_MEM_CATEGORIES; i++){
+
+        MemCounter* counter = &memStats.categories[i];
+        printf("%-13s live: %lld (%lld bytes) --- peak: %lld (%lld bytes)\n", 
+            names[i], counter->count, counter->bytes, counter->peakCount, counter->peakBytes);
+    }
+    printf("total         live: %lld bytes --- peak: %lld bytes\n", memStats.totalBytes, memStats.peakTotalBytes);
+}
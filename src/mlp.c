@@ -3,20 +3,24 @@
 // ---------------------------------------------------------------------------------------------------------------------- MLP Constructors
 
 /**
- * @note randDouble is a helper function that returns a double value between -1 and 1
+ * @note randSeed() draws a 64 bit seed from rand(), so srand() still makes newMLP() and newLayer() reproducible
 */
-double randDouble(void){
-    return (double)rand() / (RAND_MAX + 1u) * 2.0f - 1.0f;
+uint64_t randSeed(void){
+    return ((uint64_t)rand() << 32) ^ (uint64_t)rand();
 }
 
 /**
- * @note newLayer allocates memory for and intializes a new Layer struct. 
- * @dev weights and biases within the Value struct ptr arrays are initialized to random doubles between -1 and 1
- * @dev output vector array of Value struct ptrs initialized to Value structs of zeroes
+ * @note newLayerInit() allocates memory for and intializes a new Layer struct. 
+ * @dev weights and biases are generated into one contiguous buffer by initWeights() and then copied into the Value 
+ * struct ptr arrays. Biases are uniform in [-1, 1) under INIT_UNIFORM and zero under INIT_XAVIER and INIT_HE. INIT_NONE
+ * draws nothing and leaves every parameter at zero.
  * @param inputSize
  * @param outputSize
+ * @param scheme INIT_UNIFORM, INIT_XAVIER, INIT_HE or INIT_NONE
+ * @param seed seed of the model
+ * @param stream index of the layer in the model, weights and biases draw from streams 2 * stream and 2 * stream + 1
 */
-Layer* newLayer(int inputSize, int outputSize){
+Layer* newLayerInit(int inputSize, int outputSize, int scheme, uint64_t seed, uint64_t stream){
 
     // allocate mem for layer
     Layer* layer = (Layer*)malloc(sizeof(Layer));
@@ -33,34 +37,65 @@ Layer* newLayer(int inputSize, int outputSize){
     layer->weights = (Value**)malloc(inputSize * outputSize * sizeof(Value*));
     layer->biases = (Value**)malloc(outputSize * sizeof(Value*));
     assert(layer->weights != NULL && layer->biases != NULL);
+    memTrackAlloc(MEM_PARAMETERS, 0, sizeof(Layer) + (inputSize * outputSize + outputSize) * sizeof(Value*));
+
+    // generate the initial parameters
+    int numWeights = inputSize * outputSize;
+    double* params = (double*)malloc(sizeof(double) * (numWeights + outputSize));
+    assert(params != NULL);
+
+    if (scheme == INIT_NONE){
+        memset(params, 0, sizeof(double) * (numWeights + outputSize));
+    }else if (scheme == INIT_UNIFORM){
+        initWeights(params, numWeights, scheme, inputSize, outputSize, seed, 2 * stream, INIT_AUTO_THREADS);
+        initWeights(params + numWeights, outputSize, scheme, inputSize, outputSize, seed, 2 * stream + 1, 1);
+    }else{
+        initWeights(params, numWeights, scheme, inputSize, outputSize, seed, 2 * stream, INIT_AUTO_THREADS);
+        memset(params + numWeights, 0, sizeof(double) * outputSize);
+    }
 
     // init weights
-    for (int i = 0; i < (inputSize * outputSize); i++){
+    for (int i = 0; i < numWeights; i++){
 
-        // weights initialized between -1 and 1
-        layer->weights[i] = newValue(randDouble(), NULL, NO_ANCESTORS, "init weights");
+        layer->weights[i] = newValue(params[i], NULL, NO_ANCESTORS, "init weights");
         assert(layer->weights[i] != NULL);
+        memTrackTransfer(MEM_VALUES, MEM_PARAMETERS, 1, valueBytes(layer->weights[i]));
     }
 
     // init biases and output/hidden state
     for (int i = 0; i < outputSize; i++){
 
-        // init biases between -1 and 1
-        layer->biases[i] = newValue(randDouble(), NULL, NO_ANCESTORS, "init biases");
+        layer->biases[i] = newValue(params[numWeights + i], NULL, NO_ANCESTORS, "init biases");
         assert(layer->biases[i] != NULL);
+        memTrackTransfer(MEM_VALUES, MEM_PARAMETERS, 1, valueBytes(layer->biases[i]));
     }
 
+    free(params);
+
     return layer;
 }
 
+/**
+ * @note newLayer() is newLayerInit() with weights and biases uniform in [-1, 1), seeded from rand()
+ * @param inputSize
+ * @param outputSize
+*/
+Layer* newLayer(int inputSize, int outputSize){
+    return newLayerInit(inputSize, outputSize, INIT_UNIFORM, randSeed(), 0);
+}
+
 
 /**
- * @note newMLP() is a constructor for an MLP struct containing a listed list of Layer structs 
+ * @note newMLPInit() is a constructor for an MLP struct containing a listed list of Layer structs 
+ * @dev layer i draws from its own streams of seed, so the parameters depend on the seed alone and not on the number of 
+ * threads generating them
  * @param inputSize the length of the input feature vector
  * @param layerSizes An array of integers representing the number of neurons in each layer of the network
  * @param numLayers
+ * @param scheme INIT_UNIFORM, INIT_XAVIER, INIT_HE or INIT_NONE
+ * @param seed
 */
-MLP* newMLP(int inputSize, int layerSizes[], int numLayers){
+MLP* newMLPInit(int inputSize, int layerSizes[], int numLayers, int scheme, uint64_t seed){
 
     // allocate mem for layer
     MLP* mlp = (MLP*)malloc(sizeof(MLP));
@@ -69,9 +104,17 @@ MLP* newMLP(int inputSize, int layerSizes[], int numLayers){
     // create graph stack
     mlp->graphStack = newGraphStack();
     assert(mlp->graphStack != NULL);
+
+    mlp->numLayers = numLayers;
+
+    // gradient checkpointing is opt in, see setCheckpointInterval()
+    mlp->checkpointInterval = NO_CHECKPOINTING;
+    mlp->numSegments = 0;
+    mlp->segmentInputs = NULL;
+    mlp->checkpointStack = NULL;
     
     // create input layer
-    Layer* prevLayer = newLayer(inputSize, layerSizes[0]); 
+    Layer* prevLayer = newLayerInit(inputSize, layerSizes[0], scheme, seed, 0); 
     assert(prevLayer != NULL);
 
     // set link to input layer
@@ -84,7 +127,7 @@ MLP* newMLP(int inputSize, int layerSizes[], int numLayers){
     for (int i=1; i<numLayers; i++){
 
         // allocate mem and init layer
-        currentLayer = newLayer(layerSizes[i-1], layerSizes[i]);
+        currentLayer = newLayerInit(layerSizes[i-1], layerSizes[i], scheme, seed, i);
         assert(currentLayer != NULL);
 
         // set links
@@ -99,9 +142,22 @@ MLP* newMLP(int inputSize, int layerSizes[], int numLayers){
     // set link to output layer
     mlp->outputLayer = prevLayer;
 
+    mlp->inputRow = (Value**)malloc(inputSize * sizeof(Value*));
+    assert(mlp->inputRow != NULL);
+
     return mlp;
 }
 
+/**
+ * @note newMLP() is newMLPInit() with weights and biases uniform in [-1, 1), seeded from rand()
+ * @param inputSize the length of the input feature vector
+ * @param layerSizes An array of integers representing the number of neurons in each layer of the network
+ * @param numLayers
+*/
+MLP* newMLP(int inputSize, int layerSizes[], int numLayers){
+    return newMLPInit(inputSize, layerSizes, numLayers, INIT_UNIFORM, randSeed());
+}
+
 // ---------------------------------------------------------------------------------------------------------------------- MLP Destructors
 
 /**
@@ -113,6 +169,7 @@ void freeLayer(Layer** layer){
     // free Value structs in weights
     for (int i = 0; i < (*layer)->outputSize * (*layer)->inputSize; i++){
 
+        memTrackTransfer(MEM_PARAMETERS, MEM_VALUES, 1, valueBytes((*layer)->weights[i]));
         freeValue(&((*layer)->weights[i]));
         assert((*layer)->weights[i] == NULL);
     } 
@@ -121,6 +178,7 @@ void freeLayer(Layer** layer){
     for (int i = 0; i < (*layer)->outputSize; i++){
 
         // free bias
+        memTrackTransfer(MEM_PARAMETERS, MEM_VALUES, 1, valueBytes((*layer)->biases[i]));
         freeValue(&((*layer)->biases[i]));
         assert((*layer)->biases[i] == NULL);    
     }
@@ -132,6 +190,9 @@ void freeLayer(Layer** layer){
     (*layer)->weights = NULL;
     (*layer)->biases = NULL;
 
+    int numParams = (*layer)->inputSize * (*layer)->outputSize + (*layer)->outputSize;
+    memTrackFree(MEM_PARAMETERS, 0, sizeof(Layer) + numParams * sizeof(Value*));
+
     // free layer struct
     free(*layer);
     *layer = NULL;
@@ -161,6 +222,13 @@ void freeMLP(MLP** mlp){
     // release graph stack
     releaseGraph((*mlp)->graphStack);
 
+    // release gradient checkpointing state
+    setCheckpointInterval(*mlp, NO_CHECKPOINTING);
+
+    graphPreservingStackRelease(&(*mlp)->graphStack);
+
+    free((*mlp)->inputRow);
+
     // free mlp struct
     free(*mlp);
     *mlp = NULL;
@@ -0,0 +1,347 @@
+#include "lib.h"
+
+// modelFile.c
+
+_Static_assert(sizeof(ModelHeader) == 64, "ModelHeader must stay 64 bytes");
+_Static_assert(sizeof(ModelLayerInfo) == 16, "ModelLayerInfo must stay 16 bytes");
+
+// ---------------------------------------------------------------------------------------------------------------------- Layout
+
+/**
+ * @note initModelHeader() fills a ModelHeader and its layer table for an mlp of the given shape, including the offset 
+ * of every layer's parameter blob. The checksum is left at 0.
+ * @param header the header to fill
+ * @param layers numLayers entries to fill
+ * @param inputSize the length of the input feature vector
+ * @param layerSizes the number of neurons in each layer
+ * @param numLayers the number of layers
+*/
+void initModelHeader(ModelHeader* header, ModelLayerInfo* layers, int inputSize, const int* layerSizes, int numLayers){
+    assert(header != NULL && layers != NULL && layerSizes != NULL);
+    assert(inputSize > 0 && numLayers > 0);
+
+    memset(header, 0, sizeof(ModelHeader));
+    memcpy(header->magic, MODEL_MAGIC, 4);
+    header->version = MODEL_VERSION;
+    header->numLayers = numLayers;
+    header->inputSize = inputSize;
+    header->dtype = MODEL_DTYPE_FLOAT64;
+
+    header->layersOffset = sizeof(ModelHeader);
+    header->paramsOffset = alignOffset(header->layersOffset + numLayers * sizeof(ModelLayerInfo));
+
+    uint64_t offset = header->paramsOffset;
+    uint64_t layerInputSize = inputSize;
+
+    for (int i=0; i<numLayers; i++){
+        assert(layerSizes[i] > 0);
+
+        uint64_t numParams = layerInputSize * layerSizes[i] + layerSizes[i];
+
+        layers[i].outputSize = layerSizes[i];
+        layers[i].activation = MODEL_ACTIVATION_RELU;
+        layers[i].offset = offset;
+
+        header->numParams += numParams;
+        offset = alignOffset(offset + numParams * sizeof(double));
+        layerInputSize = layerSizes[i];
+    }
+}
+
+/**
+ * @note validateModelHeader() checks the magic, version and dtype of a ModelHeader and that its layer table fits 
+ * within a file of fileSize bytes
+ * @return 1 if the header is valid, 0 otherwise
+*/
+int validateModelHeader(const ModelHeader* header, uint64_t fileSize){
+    assert(header != NULL);
+
+    return memcmp(header->magic, MODEL_MAGIC, 4) == 0 &&
+        header->version == MODEL_VERSION &&
+        header->dtype == MODEL_DTYPE_FLOAT64 &&
+        header->numLayers > 0 &&
+        header->inputSize > 0 && header->inputSize <= INT32_MAX &&
+        header->layersOffset >= sizeof(ModelHeader) &&
+        header->layersOffset <= fileSize &&
+        header->numLayers <= (fileSize - header->layersOffset) / sizeof(ModelLayerInfo);
+}
+
+/**
+ * @note validateModelLayers() checks that the layer table of a valid header describes the layout initModelHeader() 
+ * produces for its layer sizes, and that every parameter blob lies within a file of fileSize bytes
+ * @dev sizes are bounded to int and each blob is checked against the bytes left after its offset by dividing, so a 
+ * crafted table can neither trip the asserts of initModelHeader() nor wrap a product past fileSize
+ * @return 1 if the layer table is valid, 0 otherwise
+*/
+int validateModelLayers(const ModelHeader* header, const ModelLayerInfo* layers, uint64_t fileSize){
+    assert(header != NULL && layers != NULL);
+
+    int* layerSizes = (int*)malloc(sizeof(int) * header->numLayers);
+    ModelLayerInfo* expected = (ModelLayerInfo*)malloc(sizeof(ModelLayerInfo) * header->numLayers);
+    assert(layerSizes != NULL && expected != NULL);
+
+    int valid = 1;
+    uint64_t layerInputSize = header->inputSize;
+
+    for (uint32_t i=0; i<header->numLayers && valid; i++){
+
+        valid = layers[i].outputSize > 0 && layers[i].outputSize <= INT32_MAX;
+        layerSizes[i] = (int)layers[i].outputSize;
+
+        // at most 2^62 + 2^31 parameters, which does not overflow
+        uint64_t numParams = (layerInputSize + 1) * layers[i].outputSize;
+        valid = valid && layers[i].offset <= fileSize && numParams <= (fileSize - layers[i].offset) / sizeof(double);
+
+        layerInputSize = layers[i].outputSize;
+    }
+
+    if (valid){
+
+        ModelHeader expectedHeader;
+        initModelHeader(&expectedHeader, expected, header->inputSize, layerSizes, header->numLayers);
+
+        valid = expectedHeader.numParams == header->numParams && 
+            expectedHeader.layersOffset == header->layersOffset &&
+            expectedHeader.paramsOffset == header->paramsOffset;
+
+        for (uint32_t i=0; i<header->numLayers && valid; i++){
+            valid = layers[i].offset == expected[i].offset && layers[i].activation == MODEL_ACTIVATION_RELU;
+        }
+    }
+
+    free(layerSizes);
+    free(expected);
+
+    return valid;
+}
+
+/**
+ * @note checksumParams() folds parameters into a running checksum, FNV-1a over 64 bit words instead of bytes so it 
+ * keeps up with disk bandwidth
+ * @dev the multiply by an odd prime is a bijection, so any change to a single parameter changes the checksum
+ * @param hash the running checksum, MODEL_CHECKSUM_SEED to start
+ * @param params the parameters to add
+ * @param count number of parameters
+ * @return the updated checksum
+*/
+uint64_t checksumParams(uint64_t hash, const double* params, size_t count){
+
+    for (size_t i=0; i<count; i++){
+
+        uint64_t word;
+        memcpy(&word, &params[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Save/Load
+
+/**
+ * @note writeParams() writes the values of an array of parameter Values in chunks, updating the checksum
+ * @return 1 if every chunk was written
+*/
+int writeParams(FILE* file, Value** params, size_t count, double* chunk, uint64_t* hash){
+
+    for (size_t start=0; start<count; start+=MODEL_IO_CHUNK_VALUES){
+
+        size_t chunkCount = count - start < MODEL_IO_CHUNK_VALUES ? count - start : MODEL_IO_CHUNK_VALUES;
+
+        for (size_t i=0; i<chunkCount; i++){
+            chunk[i] = params[start + i]->value;
+        }
+
+        *hash = checksumParams(*hash, chunk, chunkCount);
+        if (fwrite(chunk, sizeof(double), chunkCount, file) != chunkCount){
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @note readParams() reads chunks of parameters into the values of an array of Values, updating the checksum
+ * @return 1 if every chunk was read
+*/
+int readParams(FILE* file, Value** params, size_t count, double* chunk, uint64_t* hash){
+
+    for (size_t start=0; start<count; start+=MODEL_IO_CHUNK_VALUES){
+
+        size_t chunkCount = count - start < MODEL_IO_CHUNK_VALUES ? count - start : MODEL_IO_CHUNK_VALUES;
+
+        if (fread(chunk, sizeof(double), chunkCount, file) != chunkCount){
+            return 0;
+        }
+        *hash = checksumParams(*hash, chunk, chunkCount);
+
+        for (size_t i=0; i<chunkCount; i++){
+            params[start + i]->value = chunk[i];
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @note saveMLP() writes the parameters of an mlp to a model file
+ * @dev parameters are staged through a chunk buffer, so saving needs MODEL_IO_CHUNK_VALUES doubles of extra memory 
+ * regardless of model size. The header is written again with the checksum once every blob is on disk.
+ * @param mlp the mlp to save, its gradients and graph are not saved
+ * @param path the file to create
+ * @return 1 on success, 0 if the file could not be written
+*/
+int saveMLP(MLP* mlp, const char* path){
+    assert(mlp != NULL && path != NULL);
+
+    int* layerSizes = (int*)malloc(sizeof(int) * mlp->numLayers);
+    ModelLayerInfo* layers = (ModelLayerInfo*)malloc(sizeof(ModelLayerInfo) * mlp->numLayers);
+    double* chunk = (double*)malloc(sizeof(double) * MODEL_IO_CHUNK_VALUES);
+    assert(layerSizes != NULL && layers != NULL && chunk != NULL);
+
+    int numLayers = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+        layerSizes[numLayers++] = layer->outputSize;
+    }
+    assert(numLayers == mlp->numLayers);
+
+    ModelHeader header;
+    initModelHeader(&header, layers, mlp->inputLayer->inputSize, layerSizes, numLayers);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL){
+
+        printf("Error: could not create %s\n", path);
+        free(layerSizes);
+        free(layers);
+        free(chunk);
+        return 0;
+    }
+
+    int ok = fwrite(&header, sizeof(ModelHeader), 1, file) == 1 &&
+        fwrite(layers, sizeof(ModelLayerInfo), numLayers, file) == (size_t)numLayers;
+
+    // seeking past the end leaves the alignment padding zero filled
+    uint64_t hash = MODEL_CHECKSUM_SEED;
+    int i = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL && ok; layer = layer->next, i++){
+
+        ok = fseeko(file, layers[i].offset, SEEK_SET) == 0 &&
+            writeParams(file, layer->weights, (size_t)layer->inputSize * layer->outputSize, chunk, &hash) &&
+            writeParams(file, layer->biases, layer->outputSize, chunk, &hash);
+    }
+
+    header.checksum = hash;
+    ok = ok && fseeko(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(ModelHeader), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok){
+        printf("Error: could not write %s\n", path);
+    }
+
+    free(layerSizes);
+    free(layers);
+    free(chunk);
+
+    return ok;
+}
+
+/**
+ * @note loadMLP() creates an mlp from a model file written by saveMLP()
+ * @param path the model file
+ * @return the MLP, or NULL if the file could not be opened or is not a valid model file
+*/
+MLP* loadMLP(const char* path){
+    assert(path != NULL);
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL){
+        printf("Error: could not open %s\n", path);
+        return NULL;
+    }
+
+    off_t fileSize = fseeko(file, 0, SEEK_END) == 0 ? ftello(file) : -1;
+    if (fileSize < 0){
+        printf("Error: could not read the size of %s\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    MLP* mlp = readMLP(file, 0, (uint64_t)fileSize, path);
+    fclose(file);
+
+    return mlp;
+}
+
+/**
+ * @note readMLP() creates an mlp from a model file image stored at some offset of an open file, ie: inside a training 
+ * checkpoint
+ * @dev the layout is validated before the mlp is built and the checksum after every parameter has been read, so a 
+ * truncated or corrupted image never yields an mlp
+ * @param file the open file
+ * @param base byte offset of the image in the file, every offset of the image is relative to it
+ * @param size bytes available to the image
+ * @param path name of the file for error messages
+ * @return the MLP, or NULL if the image is not valid
+*/
+MLP* readMLP(FILE* file, uint64_t base, uint64_t size, const char* path){
+    assert(file != NULL && path != NULL);
+
+    // header, then the layer table it describes
+    ModelHeader header;
+    ModelLayerInfo* layers = NULL;
+
+    int valid = fseeko(file, base, SEEK_SET) == 0 &&
+        fread(&header, sizeof(ModelHeader), 1, file) == 1 && 
+        validateModelHeader(&header, size);
+
+    if (valid){
+
+        layers = (ModelLayerInfo*)malloc(sizeof(ModelLayerInfo) * header.numLayers);
+        assert(layers != NULL);
+
+        valid = fseeko(file, base + header.layersOffset, SEEK_SET) == 0 &&
+            fread(layers, sizeof(ModelLayerInfo), header.numLayers, file) == header.numLayers &&
+            validateModelLayers(&header, layers, size);
+    }
+
+    if (!valid){
+
+        printf("Error: %s is not a valid model file\n", path);
+        free(layers);
+        return NULL;
+    }
+
+    int* layerSizes = (int*)malloc(sizeof(int) * header.numLayers);
+    double* chunk = (double*)malloc(sizeof(double) * MODEL_IO_CHUNK_VALUES);
+    assert(layerSizes != NULL && chunk != NULL);
+
+    for (uint32_t i=0; i<header.numLayers; i++){
+        layerSizes[i] = layers[i].outputSize;
+    }
+
+    // every parameter is read below, so nothing is drawn for them
+    MLP* mlp = newMLPInit(header.inputSize, layerSizes, header.numLayers, INIT_NONE, 0);
+
+    uint64_t hash = MODEL_CHECKSUM_SEED;
+    int i = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL && valid; layer = layer->next, i++){
+
+        valid = fseeko(file, base + layers[i].offset, SEEK_SET) == 0 &&
+            readParams(file, layer->weights, (size_t)layer->inputSize * layer->outputSize, chunk, &hash) &&
+            readParams(file, layer->biases, layer->outputSize, chunk, &hash);
+    }
+
+    if (!valid || hash != header.checksum){
+
+        printf("Error: %s is corrupted, checksum mismatch\n", path);
+        freeMLP(&mlp);
+    }
+
+    free(layers);
+    free(layerSizes);
+    free(chunk);
+
+    return mlp;
+}
@@ -0,0 +1,130 @@
+#include "lib.h"
+
+// profile.c
+
+/**
+ * @note Profile accumulates the time spent in each ProfilePhase along with the work done during that time
+ * @param phaseNs total nanoseconds spent in each phase
+ * @param phaseCalls number of times each phase was recorded
+ * @param phaseStart start time of a phase opened with profileOpen() and not yet closed, 0 if none
+ * @param numExamples examples processed (reported by the training loop)
+ * @param numNodes graph nodes swept by Backward()
+*/
+typedef struct {
+    long long phaseNs[NUM_PROFILE_PHASES];
+    long long phaseCalls[NUM_PROFILE_PHASES];
+    long long phaseStart[NUM_PROFILE_PHASES];
+    long long numExamples;
+    long long numNodes;
+} Profile;
+
+Profile profile = {0};
+
+// ---------------------------------------------------------------------------------------------------------------------- Recording
+
+/**
+ * @note profileNow() returns the current time of the monotonic clock in nanoseconds
+*/
+long long profileNow(void){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @note profileRecord() adds elapsed time to a phase
+ * @param phase the ProfilePhase the time was spent in
+ * @param elapsedNs the elapsed time in nanoseconds
+*/
+void profileRecord(ProfilePhase phase, long long elapsedNs){
+    assert(phase >= 0 && phase < NUM_PROFILE_PHASES);
+
+    profile.phaseNs[phase] += elapsedNs;
+    profile.phaseCalls[phase]++;
+}
+
+/**
+ * @note profileOpen() starts a phase that ends in another function than the one it begins in, ie: PHASE_LOSS spans 
+ * Softmax() and the cross entropy function called after it. Opening an open phase restarts it.
+ * @param phase the ProfilePhase being entered
+*/
+void profileOpen(ProfilePhase phase){
+    assert(phase >= 0 && phase < NUM_PROFILE_PHASES);
+
+    profile.phaseStart[phase] = profileNow();
+}
+
+/**
+ * @note profileClose() records the time since profileOpen() as one call of a phase, nothing if the phase is not open
+ * @param phase the ProfilePhase being left
+*/
+void profileClose(ProfilePhase phase){
+    assert(phase >= 0 && phase < NUM_PROFILE_PHASES);
+
+    if (profile.phaseStart[phase] != 0){
+        profileRecord(phase, profileNow() - profile.phaseStart[phase]);
+        profile.phaseStart[phase] = 0;
+    }
+}
+
+/**
+ * @note profileAddExamples() counts examples processed for the examples/sec figure
+*/
+void profileAddExamples(long long numExamples){
+    profile.numExamples += numExamples;
+}
+
+/**
+ * @note profileAddNodes() counts graph nodes swept for the nodes/sec figure
+*/
+void profileAddNodes(long long numNodes){
+    profile.numNodes += numNodes;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Reporting
+
+/**
+ * @note printProfileReport() prints the time spent in each phase, its share of the total, and the throughput of 
+ * the training loop in examples/sec and graph nodes/sec
+ * @param epoch the epoch the accumulated timings belong to
+*/
+void printProfileReport(int epoch){
+
+    const char* names[NUM_PROFILE_PHASES] = {
+        "forward", "softmax/loss", "backward sort", "backward sweep", "recompute", "step", "zero grad/release"
+    };
+
+    long long totalNs = 0;
+    for (int phase=0; phase<NUM_PROFILE_PHASES; phase++){
+        totalNs += profile.phaseNs[phase];
+    }
+
+    printf("\nProfile Epoch %d\n", epoch);
+
+    for (int phase=0; phase<NUM_PROFILE_PHASES; phase++){
+
+        if (profile.phaseCalls[phase] == 0){
+            continue;
+        }
+
+        printf("  %-18s %10.3lf ms  %5.1lf%%  (%lld calls)\n", 
+            names[phase], 
+            profile.phaseNs[phase] / 1e6, 
+            totalNs > 0 ? 100.0 * profile.phaseNs[phase] / totalNs : 0,
+            profile.phaseCalls[phase]);
+    }
+
+    double seconds = totalNs / 1e9;
+    if (seconds > 0){
+        printf("  %.1lf examples/sec --- %.1lf nodes/sec\n", profile.numExamples / seconds, profile.numNodes / seconds);
+    }
+}
+
+/**
+ * @note resetProfile() clears all accumulated timings and counters
+*/
+void resetProfile(void){
+    memset(&profile, 0, sizeof(Profile));
+}
@@ -0,0 +1,95 @@
+#include "lib.h"
+
+// rng.c
+
+/**
+ * @note splitMix64() advances a splitmix64 state and returns the next output, used to expand a single seed into 
+ * the four words of xoshiro256** state
+*/
+uint64_t splitMix64(uint64_t* state){
+
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+/**
+ * @note seedRng() initializes an Rng from a 64 bit seed
+*/
+void seedRng(Rng* rng, uint64_t seed){
+    assert(rng != NULL);
+
+    for (int i=0; i<4; i++){
+        rng->s[i] = splitMix64(&seed);
+    }
+}
+
+/**
+ * @note seedRngStream() initializes the Rng of one of many independent streams derived from a single seed, ie: one per 
+ * epoch, so a stream can be recreated from (seed, stream) alone without replaying the ones before it
+*/
+void seedRngStream(Rng* rng, uint64_t seed, uint64_t stream){
+
+    uint64_t state = stream;
+    seedRng(rng, seed ^ splitMix64(&state));
+}
+
+/**
+ * @note rotl() rotates a 64 bit word left by k bits
+*/
+uint64_t rotl(uint64_t x, int k){
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @note rngNext() returns the next 64 random bits of a xoshiro256** stream
+*/
+uint64_t rngNext(Rng* rng){
+
+    uint64_t* s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+/**
+ * @note rngUniform() returns a double uniformly distributed in [0, 1) from the top 53 bits of the next output
+*/
+double rngUniform(Rng* rng){
+    return (rngNext(rng) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @note rngBelow() returns an integer uniformly distributed in [0, n) using Lemire's multiply and shift reduction, 
+ * which avoids the division of a modulo
+*/
+uint64_t rngBelow(Rng* rng, uint64_t n){
+    assert(n > 0);
+    return (uint64_t)(((__uint128_t)rngNext(rng) * n) >> 64);
+}
+
+/**
+ * @note rngNormal() returns a standard normal sample using the Box-Muller transform
+*/
+double rngNormal(Rng* rng){
+
+    double u1 = rngUniform(rng);
+    double u2 = rngUniform(rng);
+
+    // avoid log(0)
+    if (u1 < 1e-300){
+        u1 = 1e-300;
+    }
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
@@ -0,0 +1,232 @@
+#include "lib.h"
+
+// servingModel.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Readers
+
+/**
+ * @note registerServingReader() hands the lowest free reader slot to an inference thread, once per thread
+ * @dev at most SERVING_MAX_READERS readers may be registered at the same time
+ * @return the reader index to pass to acquireSnapshot() and releaseSnapshot()
+*/
+int registerServingReader(ServingModel* serving){
+    assert(serving != NULL);
+
+    for (int reader=0; reader<SERVING_MAX_READERS; reader++){
+
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&serving->readers[reader].registered, &expected, 1)){
+
+            atomic_fetch_add(&serving->numReaders, 1);
+            return reader;
+        }
+    }
+
+    assert(0 && "more than SERVING_MAX_READERS serving readers registered");
+    return -1;
+}
+
+/**
+ * @note unregisterServingReader() frees a reader slot for the next registerServingReader(), once the thread is done
+ * @param reader index from registerServingReader(), holding no snapshot
+*/
+void unregisterServingReader(ServingModel* serving, int reader){
+    assert(serving != NULL && reader >= 0 && reader < SERVING_MAX_READERS);
+
+    ReaderSlot* slot = &serving->readers[reader];
+    assert(atomic_load_explicit(&slot->registered, memory_order_relaxed) == 1);
+    assert(atomic_load_explicit(&slot->epoch, memory_order_relaxed) == SERVING_QUIESCENT);
+
+    atomic_fetch_sub(&serving->numReaders, 1);
+    atomic_store_explicit(&slot->registered, 0, memory_order_release);
+}
+
+/**
+ * @note acquireSnapshot() returns the current snapshot, which stays valid until releaseSnapshot()
+ * @dev wait free: a load of the epoch, a store to the reader's own slot and a load of the snapshot. The store must be 
+ * ordered before the snapshot load, so a publisher scanning the slots either sees the announcement or has already 
+ * swapped in the snapshot this reader will load.
+ * @param reader index from registerServingReader(), holding no snapshot
+*/
+ModelSnapshot* acquireSnapshot(ServingModel* serving, int reader){
+
+    ReaderSlot* slot = &serving->readers[reader];
+    assert(atomic_load_explicit(&slot->epoch, memory_order_relaxed) == SERVING_QUIESCENT);
+
+    atomic_store_explicit(&slot->epoch, atomic_load_explicit(&serving->epoch, memory_order_acquire), memory_order_seq_cst);
+
+    return atomic_load_explicit(&serving->current, memory_order_seq_cst);
+}
+
+/**
+ * @note releaseSnapshot() gives up the snapshot returned by the reader's last acquireSnapshot()
+*/
+void releaseSnapshot(ServingModel* serving, int reader){
+    atomic_store_explicit(&serving->readers[reader].epoch, SERVING_QUIESCENT, memory_order_release);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Publisher
+
+/**
+ * @note newModelSnapshot() snapshots an MLP into a new ModelSnapshot
+*/
+ModelSnapshot* newModelSnapshot(MLP* mlp, uint64_t version){
+
+    ModelSnapshot* snapshot = (ModelSnapshot*)malloc(sizeof(ModelSnapshot));
+    assert(snapshot != NULL);
+
+    snapshot->model = newInferenceModel(mlp);
+    snapshot->version = version;
+    snapshot->retireEpoch = 0;
+    snapshot->next = NULL;
+
+    return snapshot;
+}
+
+/**
+ * @note freeModelSnapshot() frees a snapshot and its model
+*/
+void freeModelSnapshot(ModelSnapshot** snapshot){
+    assert(snapshot != NULL && *snapshot != NULL);
+
+    freeInferenceModel(&(*snapshot)->model);
+    free(*snapshot);
+    *snapshot = NULL;
+}
+
+/**
+ * @note reclaimLocked() frees every retired snapshot no reader can still hold, publishLock held
+ * @return number of snapshots still retired
+*/
+int reclaimLocked(ServingModel* serving){
+
+    // the oldest epoch any reader announced, retired snapshots before it are unreachable
+    // every slot is scanned, since slots are freed and claimed again in any order and unused slots stay quiescent
+    uint64_t oldest = UINT64_MAX;
+
+    for (int i=0; i<SERVING_MAX_READERS; i++){
+
+        uint64_t epoch = atomic_load_explicit(&serving->readers[i].epoch, memory_order_seq_cst);
+        if (epoch != SERVING_QUIESCENT && epoch < oldest){
+            oldest = epoch;
+        }
+    }
+
+    ModelSnapshot** link = &serving->retired;
+    while (*link != NULL){
+
+        ModelSnapshot* snapshot = *link;
+
+        if (snapshot->retireEpoch < oldest){
+
+            *link = snapshot->next;
+            freeModelSnapshot(&snapshot);
+            serving->numRetired--;
+
+        }else{
+            link = &snapshot->next;
+        }
+    }
+
+    return serving->numRetired;
+}
+
+/**
+ * @note publishModel() snapshots the MLP and makes it the current model for every following acquireSnapshot(), then 
+ * reclaims the snapshots no reader holds anymore
+ * @dev the snapshot is copied before publishLock is taken, so publishing never pauses readers or the MLP's owner 
+ * for longer than the copy
+ * @param serving the ServingModel
+ * @param mlp the mlp to publish, read only during the call
+ * @return the version of the new snapshot
+*/
+uint64_t publishModel(ServingModel* serving, MLP* mlp){
+    assert(serving != NULL && mlp != NULL);
+
+    ModelSnapshot* snapshot = newModelSnapshot(mlp, 0);
+
+    pthread_mutex_lock(&serving->publishLock);
+
+    snapshot->version = ++serving->version;
+
+    ModelSnapshot* old = atomic_exchange_explicit(&serving->current, snapshot, memory_order_seq_cst);
+
+    // readers that announced this epoch or earlier may hold old, readers announcing later load the new snapshot
+    old->retireEpoch = atomic_fetch_add_explicit(&serving->epoch, 1, memory_order_seq_cst);
+    old->next = serving->retired;
+    serving->retired = old;
+    serving->numRetired++;
+
+    reclaimLocked(serving);
+
+    uint64_t version = snapshot->version;
+    pthread_mutex_unlock(&serving->publishLock);
+
+    return version;
+}
+
+/**
+ * @note reclaimSnapshots() frees the retired snapshots readers have released since the last publish
+ * @return number of snapshots still retired
+*/
+int reclaimSnapshots(ServingModel* serving){
+    assert(serving != NULL);
+
+    pthread_mutex_lock(&serving->publishLock);
+    int numRetired = reclaimLocked(serving);
+    pthread_mutex_unlock(&serving->publishLock);
+
+    return numRetired;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Constructor/Destructor
+
+/**
+ * @note newServingModel() creates a ServingModel with a snapshot of the MLP as version 1
+*/
+ServingModel* newServingModel(MLP* mlp){
+    assert(mlp != NULL);
+
+    ServingModel* serving = (ServingModel*)calloc(1, sizeof(ServingModel));
+    assert(serving != NULL);
+
+    serving->readers = (ReaderSlot*)aligned_alloc(64, sizeof(ReaderSlot) * SERVING_MAX_READERS);
+    assert(serving->readers != NULL);
+
+    for (int i=0; i<SERVING_MAX_READERS; i++){
+        atomic_init(&serving->readers[i].epoch, SERVING_QUIESCENT);
+        atomic_init(&serving->readers[i].registered, 0);
+    }
+
+    serving->version = 1;
+    atomic_init(&serving->current, newModelSnapshot(mlp, serving->version));
+    atomic_init(&serving->epoch, 1);
+    atomic_init(&serving->numReaders, 0);
+    pthread_mutex_init(&serving->publishLock, NULL);
+
+    return serving;
+}
+
+/**
+ * @note freeServingModel() frees the current and every retired snapshot
+ * @dev no reader may hold a snapshot
+ * @param serving ptr to a ServingModel ptr, set to NULL
+*/
+void freeServingModel(ServingModel** serving){
+    assert(serving != NULL && *serving != NULL);
+
+    ModelSnapshot* current = atomic_load(&(*serving)->current);
+    freeModelSnapshot(&current);
+
+    while ((*serving)->retired != NULL){
+
+        ModelSnapshot* snapshot = (*serving)->retired;
+        (*serving)->retired = snapshot->next;
+        freeModelSnapshot(&snapshot);
+    }
+
+    pthread_mutex_destroy(&(*serving)->publishLock);
+    free((*serving)->readers);
+    free(*serving);
+    *serving = NULL;
+}
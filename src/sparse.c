@@ -0,0 +1,251 @@
+#include "lib.h"
+
+// sparse.c
+
+// ---------------------------------------------------------------------------------------------------------------------- CSR
+
+/**
+ * @note newSparseBatch() allocates an empty SparseBatch
+ * @param numRows max number of rows
+ * @param numCols number of columns (features)
+ * @param capacity initial number of nonzeros, grown as needed by denseToSparse()
+*/
+SparseBatch* newSparseBatch(int numRows, int numCols, int64_t capacity){
+
+    SparseBatch* batch = (SparseBatch*)malloc(sizeof(SparseBatch));
+    assert(batch != NULL);
+
+    batch->numRows = 0;
+    batch->numCols = numCols;
+    batch->nnz = 0;
+    batch->capacity = capacity > 0 ? capacity : 1;
+
+    batch->rowPtr = (int64_t*)malloc(sizeof(int64_t) * (numRows + 1));
+    batch->colIdx = (int32_t*)malloc(sizeof(int32_t) * batch->capacity);
+    batch->values = (float*)malloc(sizeof(float) * batch->capacity);
+    assert(batch->rowPtr != NULL && batch->colIdx != NULL && batch->values != NULL);
+
+    batch->rowPtr[0] = 0;
+
+    return batch;
+}
+
+/**
+ * @note freeSparseBatch() frees a SparseBatch and its arrays
+ * @param batch ptr to a SparseBatch ptr, set to NULL
+*/
+void freeSparseBatch(SparseBatch** batch){
+    assert(batch != NULL && *batch != NULL);
+
+    free((*batch)->rowPtr);
+    free((*batch)->colIdx);
+    free((*batch)->values);
+
+    free(*batch);
+    *batch = NULL;
+}
+
+/**
+ * @note denseToSparse() fills a SparseBatch with the nonzeros of a row major dense batch, ie: a Batch from a DataLoader
+ * @param batch SparseBatch allocated for at least numRows rows, its previous contents are replaced
+ * @param features row major numRows x batch->numCols matrix
+ * @param numRows number of rows to convert
+*/
+void denseToSparse(SparseBatch* batch, const float* features, int numRows){
+    assert(batch != NULL && features != NULL);
+
+    batch->numRows = numRows;
+    batch->nnz = 0;
+
+    for (int row=0; row<numRows; row++){
+
+        const float* denseRow = features + (size_t)row * batch->numCols;
+
+        for (int col=0; col<batch->numCols; col++){
+
+            if (denseRow[col] == 0){
+                continue;
+            }
+
+            // grow geometrically
+            if (batch->nnz == batch->capacity){
+
+                batch->capacity *= 2;
+                batch->colIdx = (int32_t*)realloc(batch->colIdx, sizeof(int32_t) * batch->capacity);
+                batch->values = (float*)realloc(batch->values, sizeof(float) * batch->capacity);
+                assert(batch->colIdx != NULL && batch->values != NULL);
+            }
+
+            batch->colIdx[batch->nnz] = col;
+            batch->values[batch->nnz] = denseRow[col];
+            batch->nnz++;
+        }
+
+        batch->rowPtr[row + 1] = batch->nnz;
+    }
+}
+
+/**
+ * @note rowNonzeros() returns the number of nonzeros of a row
+*/
+int rowNonzeros(SparseBatch* batch, int row){
+    assert(batch != NULL && row >= 0 && row < batch->numRows);
+    return (int)(batch->rowPtr[row + 1] - batch->rowPtr[row]);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Sparse First Layer
+
+/**
+ * @note MultiplyWeightsSparse() is MultiplyWeights() for a sparse input vector. Only the weight columns of the nonzero
+ * features enter the dot products, so the graph, and with it Backward(), scales with nnz instead of inputSize.
+ * @dev weights of zero features are not in the graph and get no gradient, which is exactly their true gradient
+ * @param layer the layer in which to use its weight matrix
+ * @param cols column indices of the nonzero features
+ * @param input Value struct ptrs holding the nonzero feature values, in the order of cols
+ * @param nnz number of nonzero features
+ * @param graphStack the graph stack of the mlp of which the layer came from
+ * @return output vector represented as array of Value struct ptrs
+*/
+Value** MultiplyWeightsSparse(Layer* layer, const int32_t* cols, Value** input, int nnz, GraphStack* graphStack){
+
+    Value** output = newOutputVector(layer->outputSize);
+
+    for (int i=0; i<layer->outputSize; i++){
+        pushGraphStack(graphStack, output[i]);
+    }
+
+    // iterate over each output neuron
+    for (int i=0; i<layer->outputSize; i++){
+
+        Value** weightRow = layer->weights + (size_t)i * layer->inputSize;
+
+        // dot product over the nonzero features only
+        for (int k=0; k<nnz; k++){
+
+            output[i] = Add(
+                output[i],
+                Mul(weightRow[cols[k]], input[k], graphStack),
+                graphStack
+            );
+        }
+    }
+
+    return output;
+}
+
+/**
+ * @note ForwardSparseRow() performs the forward pass of an mlp on one row of a SparseBatch. The first layer uses
+ * MultiplyWeightsSparse(), the rest of the network is the usual dense ForwardLayer().
+ * @dev the nonzero features are wrapped in input Values pushed to the mlp's graph stack, as with ForwardRow()
+ * @dev gradient checkpointing is not supported on the sparse path
+ * @param mlp the mlp to run, its input size must be batch->numCols
+ * @param batch the SparseBatch
+ * @param row the row of the batch to run
+ * @returns an array of Value struct pointers representing the final output of the network
+*/
+Value** ForwardSparseRow(MLP* mlp, SparseBatch* batch, int row){
+    assert(mlp != NULL && batch != NULL);
+    assert(batch->numCols == mlp->inputLayer->inputSize);
+    assert(mlp->checkpointInterval == NO_CHECKPOINTING);
+
+    PROFILE_BEGIN(PHASE_FORWARD);
+
+    int64_t start = batch->rowPtr[row];
+    int nnz = rowNonzeros(batch, row);
+
+    for (int k=0; k<nnz; k++){
+
+        mlp->inputRow[k] = newConstant(batch->values[start + k], "input");
+        pushGraphStack(mlp->graphStack, mlp->inputRow[k]);
+    }
+
+    // sparse first layer
+    Layer* layer = mlp->inputLayer;
+    Value** output = MultiplyWeightsSparse(layer, batch->colIdx + start, mlp->inputRow, nnz, mlp->graphStack);
+    output = AddBias(layer, output, mlp->graphStack);
+    output = ApplyReLU(layer, output, mlp->graphStack);
+
+    // dense remainder
+    for (layer = layer->next; layer != NULL; layer = layer->next){
+        output = ForwardLayer(layer, output, mlp->graphStack);
+    }
+
+    PROFILE_END(PHASE_FORWARD);
+
+    return output;
+}
+
+/**
+ * @note StepSparse() is Step() after a ForwardSparseRow() pass: the first layer's weights are only updated in the
+ * columns of the row's nonzero features, as every other column has a zero gradient. Biases and later layers are
+ * updated as in Step().
+ * @param mlp a ptr to an MLP struct to apply gradient descent to
+ * @param lr the learning rate to use in the update rule
+ * @param cols column indices of the row's nonzero features, ie: batch->colIdx + batch->rowPtr[row]
+ * @param nnz number of nonzero features
+*/
+void StepSparse(MLP* mlp, double lr, const int32_t* cols, int nnz){
+    assert(mlp != NULL);
+
+    PROFILE_BEGIN(PHASE_STEP);
+
+    Layer* layer = mlp->inputLayer;
+
+    // sparse weight update of the first layer, same rule as Step()
+    for (int i=0; i<layer->outputSize; i++){
+
+        Value** weightRow = layer->weights + (size_t)i * layer->inputSize;
+        for (int k=0; k<nnz; k++){
+            weightRow[cols[k]]->value -= lr * weightRow[cols[k]]->grad;
+        }
+    }
+
+    for (int i=0; i<layer->outputSize; i++){
+        layer->biases[i]->value -= lr * layer->biases[i]->grad;
+    }
+
+    // dense update of the rest
+    for (layer = layer->next; layer != NULL; layer = layer->next){
+        StepLayer(layer, lr);
+    }
+
+    PROFILE_END(PHASE_STEP);
+}
+
+/**
+ * @note ZeroGradSparse() is ZeroGrad() after a ForwardSparseRow() pass, only zeroing the first layer's weight columns
+ * of the row's nonzero features. The computational graph is released as in ZeroGrad().
+ * @param mlp a pointer to an MLP struct to zero the gradient of
+ * @param cols column indices of the row's nonzero features
+ * @param nnz number of nonzero features
+*/
+void ZeroGradSparse(MLP* mlp, const int32_t* cols, int nnz){
+    assert(mlp != NULL);
+
+    PROFILE_BEGIN(PHASE_ZERO_GRAD);
+
+    Layer* layer = mlp->inputLayer;
+
+    for (int i=0; i<layer->outputSize; i++){
+
+        Value** weightRow = layer->weights + (size_t)i * layer->inputSize;
+        for (int k=0; k<nnz; k++){
+            weightRow[cols[k]]->grad = 0;
+        }
+        layer->biases[i]->grad = 0;
+    }
+
+    for (layer = layer->next; layer != NULL; layer = layer->next){
+
+        for (int i=0; i<(layer->inputSize * layer->outputSize); i++){
+            layer->weights[i]->grad = 0;
+        }
+        for (int i=0; i<layer->outputSize; i++){
+            layer->biases[i]->grad = 0;
+        }
+    }
+
+    releaseGraph(mlp->graphStack);
+
+    PROFILE_END(PHASE_ZERO_GRAD);
+}
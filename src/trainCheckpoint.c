@@ -0,0 +1,293 @@
+#include "lib.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// trainCheckpoint.c
+
+_Static_assert(sizeof(TrainHeader) == 64, "TrainHeader must stay 64 bytes");
+
+// ---------------------------------------------------------------------------------------------------------------------- Write/Read
+
+/**
+ * @note initTrainHeader() fills a TrainHeader from a TrainState for a model image of modelBytes bytes
+*/
+void initTrainHeader(TrainHeader* header, const TrainState* state, uint64_t modelBytes){
+
+    memset(header, 0, sizeof(TrainHeader));
+    memcpy(header->magic, TRAIN_MAGIC, 4);
+    header->version = TRAIN_VERSION;
+    header->step = state->step;
+    header->lr = state->lr;
+    header->optimizer = state->optimizer;
+    header->epoch = state->position.epoch;
+    header->batch = state->position.batch;
+    header->loaderSeed = state->loaderSeed;
+    header->modelOffset = sizeof(TrainHeader);
+    header->modelBytes = modelBytes;
+}
+
+/**
+ * @note syncParentDir() flushes the directory entry of a path to disk, so a rename into it survives a power loss
+ * @return 1 on success, 0 otherwise
+*/
+int syncParentDir(const char* path){
+
+    const char* slash = strrchr(path, '/');
+    size_t dirLen = slash == NULL ? 1 : (slash == path ? 1 : (size_t)(slash - path));
+
+    char* dir = (char*)malloc(dirLen + 1);
+    assert(dir != NULL);
+    memcpy(dir, slash == NULL ? "." : path, dirLen);
+    dir[dirLen] = '\0';
+
+    int fd = open(dir, O_RDONLY);
+    int ok = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0){
+        close(fd);
+    }
+
+    free(dir);
+    return ok;
+}
+
+/**
+ * @note writeTrainCheckpoint() writes a header and a snapshot's model file image to path + ".tmp", then renames it to 
+ * path
+ * @dev the temporary file is flushed and fsync()ed before the rename and the directory after it, so the rename never 
+ * reaches the disk ahead of the data it points to
+ * @return 1 on success, 0 if the file could not be written
+*/
+int writeTrainCheckpoint(const TrainHeader* header, InferenceModel* snapshot, const char* path){
+
+    size_t pathLen = strlen(path);
+    char* tmpPath = (char*)malloc(pathLen + 5);
+    assert(tmpPath != NULL);
+    memcpy(tmpPath, path, pathLen);
+    memcpy(tmpPath + pathLen, ".tmp", 5);
+
+    FILE* file = fopen(tmpPath, "wb");
+    int ok = file != NULL;
+
+    if (ok){
+
+        ok = fwrite(header, sizeof(TrainHeader), 1, file) == 1 &&
+            fwrite(snapshot->params, 1, snapshot->imageBytes, file) == snapshot->imageBytes &&
+            fflush(file) == 0 &&
+            fsync(fileno(file)) == 0;
+        ok = (fclose(file) == 0) && ok;
+        ok = ok && rename(tmpPath, path) == 0;
+        ok = ok && syncParentDir(path);
+    }
+
+    if (!ok){
+        printf("Error: could not write %s\n", path);
+        remove(tmpPath);
+    }
+
+    free(tmpPath);
+    return ok;
+}
+
+/**
+ * @note saveTrainCheckpoint() writes a training checkpoint on the calling thread
+ * @param mlp the mlp being trained
+ * @param state the training loop state
+ * @param path the checkpoint file
+ * @return 1 on success, 0 if the file could not be written
+*/
+int saveTrainCheckpoint(MLP* mlp, const TrainState* state, const char* path){
+    assert(mlp != NULL && state != NULL && path != NULL);
+
+    InferenceModel* snapshot = newInferenceModel(mlp);
+
+    TrainHeader header;
+    initTrainHeader(&header, state, snapshot->imageBytes);
+    int ok = writeTrainCheckpoint(&header, snapshot, path);
+
+    freeInferenceModel(&snapshot);
+    return ok;
+}
+
+/**
+ * @note loadTrainCheckpoint() reads a training checkpoint back into a new mlp and the training loop state
+ * @dev resume with newDataLoaderAt(dataset, batchSize, numEpochs, shuffle, state->loaderSeed, state->position)
+ * @param path the checkpoint file
+ * @param state filled with the training loop state
+ * @return the MLP, or NULL if the file could not be opened or is not a valid checkpoint
+*/
+MLP* loadTrainCheckpoint(const char* path, TrainState* state){
+    assert(path != NULL && state != NULL);
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL){
+        printf("Error: could not open %s\n", path);
+        return NULL;
+    }
+
+    off_t endOffset = fseeko(file, 0, SEEK_END) == 0 ? ftello(file) : -1;
+    if (endOffset < 0 || fseeko(file, 0, SEEK_SET) != 0){
+        printf("Error: could not read the size of %s\n", path);
+        fclose(file);
+        return NULL;
+    }
+    uint64_t fileSize = (uint64_t)endOffset;
+
+    TrainHeader header;
+    int valid = fread(&header, sizeof(TrainHeader), 1, file) == 1 &&
+        memcmp(header.magic, TRAIN_MAGIC, 4) == 0 &&
+        header.version == TRAIN_VERSION &&
+        header.optimizer == TRAIN_OPTIMIZER_SGD &&
+        header.epoch >= 0 && header.batch >= 0 &&
+        header.modelOffset <= fileSize &&
+        header.modelBytes <= fileSize - header.modelOffset;
+
+    MLP* mlp = NULL;
+    if (valid){
+        mlp = readMLP(file, header.modelOffset, header.modelBytes, path);
+    }else{
+        printf("Error: %s is not a valid training checkpoint\n", path);
+    }
+
+    fclose(file);
+
+    if (mlp != NULL){
+
+        state->step = header.step;
+        state->lr = header.lr;
+        state->optimizer = header.optimizer;
+        state->loaderSeed = header.loaderSeed;
+        state->position.epoch = header.epoch;
+        state->position.batch = header.batch;
+    }
+
+    return mlp;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Background Writer
+
+/**
+ * @note checkpointThread() is the pthread body of a CheckpointWriter, it writes each handed over snapshot and frees it
+*/
+void* checkpointThread(void* arg){
+
+    CheckpointWriter* writer = (CheckpointWriter*)arg;
+
+    pthread_mutex_lock(&writer->lock);
+
+    while (1){
+
+        while (!writer->pending && !writer->stop){
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        }
+        if (!writer->pending){
+            break;
+        }
+
+        // write outside the lock, the training thread only touches the handover fields while pending is set
+        pthread_mutex_unlock(&writer->lock);
+        int status = writeTrainCheckpoint(&writer->header, writer->snapshot, writer->path);
+        freeInferenceModel(&writer->snapshot);
+        free(writer->path);
+        pthread_mutex_lock(&writer->lock);
+
+        writer->path = NULL;
+        writer->status = status;
+        writer->numWritten++;
+        writer->pending = 0;
+        pthread_cond_broadcast(&writer->cond);
+    }
+
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+/**
+ * @note newCheckpointWriter() starts a background checkpoint writer thread
+*/
+CheckpointWriter* newCheckpointWriter(void){
+
+    CheckpointWriter* writer = (CheckpointWriter*)calloc(1, sizeof(CheckpointWriter));
+    assert(writer != NULL);
+
+    writer->status = 1;
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+
+    int status = pthread_create(&writer->thread, NULL, checkpointThread, writer);
+    assert(status == 0);
+
+    return writer;
+}
+
+/**
+ * @note saveTrainCheckpointAsync() snapshots the parameters of an mlp on the calling thread and hands the snapshot to 
+ * the writer thread. Training can go on as soon as it returns.
+ * @dev blocks only while a previous checkpoint is still being written
+ * @param writer the CheckpointWriter
+ * @param mlp the mlp being trained
+ * @param state the training loop state, copied
+ * @param path the checkpoint file, copied
+*/
+void saveTrainCheckpointAsync(CheckpointWriter* writer, MLP* mlp, const TrainState* state, const char* path){
+    assert(writer != NULL && mlp != NULL && state != NULL && path != NULL);
+
+    InferenceModel* snapshot = newInferenceModel(mlp);
+
+    char* pathCopy = (char*)malloc(strlen(path) + 1);
+    assert(pathCopy != NULL);
+    strcpy(pathCopy, path);
+
+    pthread_mutex_lock(&writer->lock);
+
+    while (writer->pending){
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+
+    writer->snapshot = snapshot;
+    writer->path = pathCopy;
+    initTrainHeader(&writer->header, state, snapshot->imageBytes);
+    writer->pending = 1;
+    pthread_cond_broadcast(&writer->cond);
+
+    pthread_mutex_unlock(&writer->lock);
+}
+
+/**
+ * @note waitCheckpointWriter() blocks until the checkpoint in flight, if any, has been written
+ * @return 1 if the last checkpoint was written, 0 if writing it failed
+*/
+int waitCheckpointWriter(CheckpointWriter* writer){
+    assert(writer != NULL);
+
+    pthread_mutex_lock(&writer->lock);
+
+    while (writer->pending){
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+    int status = writer->status;
+
+    pthread_mutex_unlock(&writer->lock);
+
+    return status;
+}
+
+/**
+ * @note freeCheckpointWriter() finishes the checkpoint in flight, stops the writer thread and frees the writer
+ * @param writer ptr to a CheckpointWriter ptr, set to NULL
+*/
+void freeCheckpointWriter(CheckpointWriter** writer){
+    assert(writer != NULL && *writer != NULL);
+
+    pthread_mutex_lock(&(*writer)->lock);
+    (*writer)->stop = 1;
+    pthread_cond_broadcast(&(*writer)->cond);
+    pthread_mutex_unlock(&(*writer)->lock);
+
+    pthread_join((*writer)->thread, NULL);
+
+    pthread_mutex_destroy(&(*writer)->lock);
+    pthread_cond_destroy(&(*writer)->cond);
+
+    free(*writer);
+    *writer = NULL;
+}
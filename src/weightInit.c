@@ -0,0 +1,203 @@
+#include "lib.h"
+#include <pthread.h>
+#include <unistd.h>
+
+// weightInit.c
+
+// ---------------------------------------------------------------------------------------------------------------------- Blocks
+
+/**
+ * @note seedInitLanes() seeds the lanes of one block, lane k of block b being stream b * INIT_LANES + k of the array
+*/
+void seedInitLanes(InitLanes* lanes, uint64_t arraySeed, uint64_t block){
+
+    for (int k=0; k<INIT_LANES; k++){
+
+        Rng rng;
+        seedRngStream(&rng, arraySeed, block * INIT_LANES + k);
+
+        for (int j=0; j<4; j++){
+            lanes->s[j][k] = rng.s[j];
+        }
+    }
+}
+
+/**
+ * @note nextInitUniforms() advances every lane once and writes one double uniformly distributed in [0, 1) per lane,
+ * the same step as rngNext() and rngUniform()
+*/
+void nextInitUniforms(InitLanes* lanes, double* out){
+
+    uint64_t (*s)[INIT_LANES] = lanes->s;
+
+    for (int k=0; k<INIT_LANES; k++){
+
+        uint64_t x = s[1][k] * 5;
+        uint64_t result = ((x << 7) | (x >> 57)) * 9;
+        uint64_t t = s[1][k] << 17;
+
+        s[2][k] ^= s[0][k];
+        s[3][k] ^= s[1][k];
+        s[1][k] ^= s[2][k];
+        s[0][k] ^= s[3][k];
+        s[2][k] ^= t;
+        s[3][k] = (s[3][k] << 45) | (s[3][k] >> 19);
+
+        out[k] = (result >> 11) * 0x1.0p-53;
+    }
+}
+
+/**
+ * @note fillInitBlock() fills one block of an array
+ * @dev normal samples come in pairs from Marsaglia's polar method, which rejects about a fifth of the uniform pairs but
+ * needs no cos() or sin(). The draws of a block only depend on its lanes, so rejections do not move other blocks.
+*/
+void fillInitBlock(InitJob* job, uint64_t block){
+
+    size_t first = block * INIT_BLOCK_VALUES;
+    size_t n = job->count - first < INIT_BLOCK_VALUES ? job->count - first : INIT_BLOCK_VALUES;
+    double* out = job->values + first;
+    double scale = job->scale;
+
+    InitLanes lanes;
+    seedInitLanes(&lanes, job->arraySeed, block);
+
+    if (job->scheme == INIT_HE){
+
+        double draws[INIT_LANES];
+        int used = INIT_LANES;
+
+        for (size_t i=0; i<n; i+=2){
+
+            double x, y, s;
+            do {
+                if (used == INIT_LANES){
+                    nextInitUniforms(&lanes, draws);
+                    used = 0;
+                }
+                x = 2.0 * draws[used] - 1.0;
+                y = 2.0 * draws[used + 1] - 1.0;
+                used += 2;
+
+                s = x * x + y * y;
+            } while (s >= 1.0 || s == 0.0);
+
+            double factor = scale * sqrt(-2.0 * log(s) / s);
+
+            out[i] = x * factor;
+            if (i + 1 < n){
+                out[i + 1] = y * factor;
+            }
+        }
+
+    }else{
+
+        // whole lane steps into a buffer first, so the generator loop runs without branches
+        double uniforms[INIT_BLOCK_VALUES];
+        size_t numUniforms = (n + INIT_LANES - 1) / INIT_LANES * INIT_LANES;
+
+        for (size_t i=0; i<numUniforms; i+=INIT_LANES){
+            nextInitUniforms(&lanes, uniforms + i);
+        }
+
+        for (size_t i=0; i<n; i++){
+            out[i] = scale * (2.0 * uniforms[i] - 1.0);
+        }
+    }
+}
+
+/**
+ * @note initThread() is the pthread body of initWeights(), it fills blocks until there are none left
+*/
+void* initThread(void* arg){
+
+    InitJob* job = (InitJob*)arg;
+
+    while (1){
+
+        uint64_t block = atomic_fetch_add(&job->nextBlock, 1);
+        if (block >= job->numBlocks){
+            break;
+        }
+
+        fillInitBlock(job, block);
+    }
+
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Initializers
+
+/**
+ * @note initScale() returns the bound of a uniform scheme or the standard deviation of a normal scheme
+ * @dev INIT_UNIFORM is [-1, 1) as newMLP() always initialized, INIT_XAVIER is Glorot uniform with bound
+ * sqrt(6 / (fanIn + fanOut)) and INIT_HE is He normal with standard deviation sqrt(2 / fanIn)
+*/
+double initScale(int scheme, int fanIn, int fanOut){
+    assert(fanIn > 0 && fanOut > 0);
+
+    switch (scheme){
+        case INIT_UNIFORM:
+            return 1.0;
+        case INIT_XAVIER:
+            return sqrt(6.0 / (fanIn + fanOut));
+        case INIT_HE:
+            return sqrt(2.0 / fanIn);
+        default:
+            assert(0);
+            return 0;
+    }
+}
+
+/**
+ * @note initWeights() fills a contiguous array of parameters according to an init scheme
+ * @param values count doubles to fill
+ * @param scheme INIT_UNIFORM, INIT_XAVIER or INIT_HE
+ * @param fanIn/fanOut inputs and outputs of the layer the parameters belong to
+ * @param seed seed shared by every array of a model
+ * @param stream distinguishes the arrays of a model, ie: one per layer
+ * @param numThreads threads filling the array, the caller included, or INIT_AUTO_THREADS for one per online cpu. Does
+ * not change the result.
+*/
+void initWeights(double* values, size_t count, int scheme, int fanIn, int fanOut, uint64_t seed, uint64_t stream, int numThreads){
+    assert(values != NULL || count == 0);
+    assert(numThreads >= 0);
+
+    InitJob job;
+    job.values = values;
+    job.count = count;
+    job.scheme = scheme;
+    job.scale = initScale(scheme, fanIn, fanOut);
+    job.numBlocks = (count + INIT_BLOCK_VALUES - 1) / INIT_BLOCK_VALUES;
+    atomic_init(&job.nextBlock, 0);
+
+    Rng rng;
+    seedRngStream(&rng, seed, stream);
+    job.arraySeed = rngNext(&rng);
+
+    if (numThreads == INIT_AUTO_THREADS){
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = cores > 0 ? (int)cores : 1;
+    }
+
+    // no more threads than blocks
+    if ((uint64_t)numThreads > job.numBlocks){
+        numThreads = job.numBlocks > 0 ? (int)job.numBlocks : 1;
+    }
+
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * numThreads);
+    assert(threads != NULL);
+
+    for (int t=1; t<numThreads; t++){
+        int status = pthread_create(&threads[t], NULL, initThread, &job);
+        assert(status == 0);
+    }
+
+    initThread(&job);
+
+    for (int t=1; t<numThreads; t++){
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+}
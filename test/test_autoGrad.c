@@ -513,6 +513,53 @@ void test_Backward(void){
     printf("PASS!\n");
 }
 
+/**
+ * @test test_requiresGrad() checks that constants fold, are left out of the sorted graph and receive no gradient
+*/
+void test_requiresGrad(void){
+
+    printf("test_requiresGrad()...");
+
+    GraphStack* opStack = newGraphStack();
+
+    Value* w1 = newValue(2, NULL, NO_ANCESTORS, "w1");
+    Value* w2 = newValue(-3, NULL, NO_ANCESTORS, "w2");
+    Value* x1 = newConstant(5, "x1");
+    Value* x2 = newConstant(7, "x2");
+    assert(w1->requiresGrad == REQUIRES_GRAD && x1->requiresGrad == NO_GRAD);
+
+    // operations on constants only fold into constants without edges
+    Value* folded = ReLU(Add(x1, Mul(x1, x2, opStack), opStack), opStack);
+    assert(folded->value == 40);
+    assert(folded->requiresGrad == NO_GRAD);
+    assert(folded->ancestors == NULL && folded->Backward == NULL);
+
+    // a dot product of parameters with constant inputs requires grad
+    Value* y = Add(Mul(w1, x1, opStack), Mul(x2, w2, opStack), opStack);
+    y = Add(y, folded, opStack);
+    assert(y->value == 29);
+    assert(y->requiresGrad == REQUIRES_GRAD);
+
+    // the sort only holds y, the two products, the sum and the two weights
+    GraphStack* sortStack = newGraphStack();
+    reverseTopologicalSort(y, &sortStack);
+    assert(sortStack->len - 1 == 6);
+    graphPreservingStackRelease(&sortStack);
+
+    Backward(y, NULL, NULL);
+
+    assert(w1->grad == 5 && w2->grad == 7);
+    assert(x1->grad == 0 && x2->grad == 0 && folded->grad == 0);
+
+    releaseGraph(opStack);
+    freeValue(&w1);
+    freeValue(&w2);
+    freeValue(&x1);
+    freeValue(&x2);
+
+    printf("PASS!\n");
+}
+
 /**
  * @test test_ZeroGrad() tests that the ZeroGrad() function both zeros the gradient and releases the computaitonal graph
 */
@@ -600,5 +647,6 @@ int main(void){
     test_depthFirstSearch();
     test_reverseTopologicalSort();
     test_Backward(); 
+    test_requiresGrad();
     test_ZeroGrad();
 }
\ No newline at end of file
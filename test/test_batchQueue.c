@@ -0,0 +1,173 @@
+#include "lib.h"
+
+#define TEST_QUEUE_CLIENTS 8
+#define TEST_QUEUE_REQUESTS 300
+#define TEST_QUEUE_FEATURES 6
+#define TEST_QUEUE_CLASSES 4
+
+/**
+ * @note QueueClient is one client thread of test_concurrentClients() and the rows it submits
+*/
+typedef struct {
+    BatchQueue* queue;
+    const float* features;
+    int32_t labels[TEST_QUEUE_REQUESTS];
+    double probs[TEST_QUEUE_REQUESTS][TEST_QUEUE_CLASSES];
+} QueueClient;
+
+/**
+ * @note queueClientThread() submits the client's rows one at a time, waiting for each, asking for probabilities on 
+ * every other row
+*/
+void* queueClientThread(void* arg){
+
+    QueueClient* client = (QueueClient*)arg;
+
+    for (int i=0; i<TEST_QUEUE_REQUESTS; i++){
+
+        double* probs = i % 2 ? client->probs[i] : NULL;
+        client->labels[i] = predictQueued(client->queue, client->features + i * TEST_QUEUE_FEATURES, probs);
+    }
+
+    return NULL;
+}
+
+/**
+ * @note newQueueModel() snapshots a small random mlp for the tests
+*/
+InferenceModel* newQueueModel(void){
+
+    int layerSizes[] = {16, TEST_QUEUE_CLASSES};
+    MLP* mlp = newMLP(TEST_QUEUE_FEATURES, layerSizes, 2);
+    InferenceModel* model = newInferenceModel(mlp);
+    freeMLP(&mlp);
+
+    return model;
+}
+
+/**
+ * @test test_concurrentClients() checks that rows submitted by many threads at once get exactly the predictions of 
+ * predictRow(), whichever batches they end up in
+*/
+void test_concurrentClients(void){
+
+    printf("test_concurrentClients()...");
+
+    InferenceModel* model = newQueueModel();
+    InferencePool* pool = newInferencePool(2);
+    BatchQueue* queue = newBatchQueue(pool, model, 16, 200000);
+
+    Rng rng;
+    seedRng(&rng, 4);
+
+    int numRows = TEST_QUEUE_CLIENTS * TEST_QUEUE_REQUESTS;
+    float* features = malloc(sizeof(float) * numRows * TEST_QUEUE_FEATURES);
+    for (int i=0; i<numRows * TEST_QUEUE_FEATURES; i++){
+        features[i] = (float)rngNormal(&rng);
+    }
+
+    QueueClient* clients = malloc(sizeof(QueueClient) * TEST_QUEUE_CLIENTS);
+    pthread_t threads[TEST_QUEUE_CLIENTS];
+
+    for (int c=0; c<TEST_QUEUE_CLIENTS; c++){
+
+        clients[c].queue = queue;
+        clients[c].features = features + c * TEST_QUEUE_REQUESTS * TEST_QUEUE_FEATURES;
+        assert(pthread_create(&threads[c], NULL, queueClientThread, &clients[c]) == 0);
+    }
+    for (int c=0; c<TEST_QUEUE_CLIENTS; c++){
+        pthread_join(threads[c], NULL);
+    }
+
+    assert(queue->numRequests == (uint64_t)numRows);
+    assert(queue->numBatches >= (uint64_t)numRows / 16);
+
+    // every request's latency was recorded
+    LatencyHistogram* latencies = malloc(sizeof(LatencyHistogram));
+    getQueueLatencies(queue, latencies);
+    assert(latencies->count == (uint64_t)numRows && latencies->min > 0);
+    free(latencies);
+
+    double* scratch = malloc(sizeof(double) * (2 * model->maxWidth + model->outputSize));
+
+    for (int c=0; c<TEST_QUEUE_CLIENTS; c++){
+        for (int i=0; i<TEST_QUEUE_REQUESTS; i++){
+
+            int32_t label;
+            double probs[TEST_QUEUE_CLASSES];
+            predictRow(model, clients[c].features + i * TEST_QUEUE_FEATURES, scratch, &label, probs);
+
+            assert(clients[c].labels[i] == label);
+            if (i % 2){
+                assert(memcmp(clients[c].probs[i], probs, sizeof(probs)) == 0);
+            }
+        }
+    }
+
+    freeBatchQueue(&queue);
+    assert(queue == NULL);
+    freeInferencePool(&pool);
+    freeInferenceModel(&model);
+    free(scratch);
+    free(features);
+    free(clients);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_batchTriggers() checks that full batches are dispatched without waiting for their deadline, that a lone 
+ * row is dispatched at its deadline and that freeing the queue predicts the rows still queued
+*/
+void test_batchTriggers(void){
+
+    printf("test_batchTriggers()...");
+
+    InferenceModel* model = newQueueModel();
+    InferencePool* pool = newInferencePool(1);
+
+    float row[TEST_QUEUE_FEATURES] = {0.5f, -1, 2, 0.25f, 1, -0.75f};
+    PredictFuture futures[8];
+
+    // a deadline far in the future, so only full batches are dispatched
+    BatchQueue* queue = newBatchQueue(pool, model, 4, 1000000000000LL);
+    for (int i=0; i<8; i++){
+        submitPrediction(queue, row, NULL, &futures[i]);
+    }
+    for (int i=0; i<8; i++){
+        waitPrediction(&futures[i]);
+    }
+    assert(queue->numBatches == 2 && queue->numRequests == 8);
+
+    // queued rows are predicted on free
+    for (int i=0; i<3; i++){
+        submitPrediction(queue, row, NULL, &futures[i]);
+    }
+    freeBatchQueue(&queue);
+
+    int32_t expected = futures[0].label;
+    for (int i=0; i<3; i++){
+        assert(waitPrediction(&futures[i]) == expected);
+    }
+
+    // a 1ms deadline
+    queue = newBatchQueue(pool, model, 64, 1000000);
+    long long start = profileNow();
+    assert(predictQueued(queue, row, NULL) == expected);
+    assert(profileNow() - start >= 1000000);
+    assert(queue->numBatches == 1);
+    freeBatchQueue(&queue);
+
+    freeInferencePool(&pool);
+    freeInferenceModel(&model);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_concurrentClients();
+    test_batchTriggers();
+
+    return 0;
+}
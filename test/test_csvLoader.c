@@ -0,0 +1,307 @@
+#include "lib.h"
+
+#define TEST_CSV_PATH "/tmp/nnc_test_loader.csv"
+
+/**
+ * @test test_csvSchema() checks header detection, column kinds and the string label dictionary. Hex fields are not 
+ * numbers to parseDecimal(), so a hex column is a string column.
+*/
+void test_csvSchema(void){
+
+    printf("test_csvSchema()...");
+
+    FILE* file = fopen(TEST_CSV_PATH, "w");
+    fprintf(file, "a,b,id,class\n");
+    fprintf(file, "1.5,2,0x1A,cat\r\n");
+    fprintf(file, "-3,4e1,0x2,dog\n");
+    fprintf(file, "0.25, 7 ,0xff, cat\n");
+    fprintf(file, "\n");
+    fprintf(file, "8,,0x10,bird");
+    fclose(file);
+
+    CsvStream* stream = openCsvStream(TEST_CSV_PATH, NULL);
+    assert(stream != NULL);
+    assert(stream->options.hasHeader == 1);
+    assert(stream->numColumns == 4);
+    assert(stream->labelColumn == 3);
+    assert(stream->labelsAreNumeric == 0);
+
+    // the string column that is not the label is dropped
+    assert(stream->columnKinds[0] == CSV_NUMERIC);
+    assert(stream->columnKinds[1] == CSV_NUMERIC);
+    assert(stream->columnKinds[2] == CSV_IGNORED);
+    assert(stream->numFeatures == 2);
+
+    // read across two batches, the blank line is skipped
+    float features[6];
+    int32_t labels[3];
+    assert(nextCsvBatch(stream, features, labels, 3) == 3);
+
+    assert(features[0] == 1.5f && features[1] == 2.0f);
+    assert(features[2] == -3.0f && features[3] == 40.0f);
+    assert(features[4] == 0.25f && features[5] == 7.0f);
+    assert(labels[0] == 0 && labels[1] == 1 && labels[2] == 0);
+
+    // last line has no newline and a missing value
+    assert(nextCsvBatch(stream, features, labels, 3) == 1);
+    assert(features[0] == 8.0f && features[1] == 0.0f);
+    assert(labels[0] == 2);
+    assert(nextCsvBatch(stream, features, labels, 3) == 0);
+
+    assert(stream->numClasses == 3);
+    assert(strcmp(labelName(stream, 0), "cat") == 0);
+    assert(strcmp(labelName(stream, 1), "dog") == 0);
+    assert(strcmp(labelName(stream, 2), "bird") == 0);
+
+    // ids are stable after a rewind
+    rewindCsvStream(stream);
+    assert(nextCsvBatch(stream, features, labels, 3) == 3);
+    assert(features[0] == 1.5f);
+    assert(labels[1] == 1);
+    assert(stream->labels.numLabels == 3);
+
+    closeCsvStream(&stream);
+    assert(stream == NULL);
+    remove(TEST_CSV_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_csvChunks() streams a file several times larger than the read chunk with integer labels
+*/
+void test_csvChunks(void){
+
+    printf("test_csvChunks()...");
+
+    int numRows = 100000;
+
+    FILE* file = fopen(TEST_CSV_PATH, "w");
+    for (int row=0; row<numRows; row++){
+        fprintf(file, "%d,%d.5,%d\n", row, row % 1000, row % 7);
+    }
+    fclose(file);
+
+    CsvStream* stream = openCsvStream(TEST_CSV_PATH, NULL);
+    assert(stream != NULL);
+    assert(stream->options.hasHeader == 0);
+    assert(stream->labelsAreNumeric == 1);
+    assert(stream->numFeatures == 2);
+    assert(labelName(stream, 0) == NULL);
+
+    // batch size that does not divide the row count
+    int batchSize = 333;
+    float features[333 * 2];
+    int32_t labels[333];
+
+    int row = 0, numRead;
+    while ((numRead = nextCsvBatch(stream, features, labels, batchSize)) > 0){
+
+        for (int i=0; i<numRead; i++, row++){
+            assert(features[i * 2] == (float)row);
+            assert(features[i * 2 + 1] == (float)(row % 1000) + 0.5f);
+            assert(labels[i] == row % 7);
+        }
+    }
+
+    assert(row == numRows);
+    assert(stream->rowsRead == numRows);
+    assert(stream->numClasses == 7);
+
+    // memory is bounded by the chunk, not the file
+    assert(stream->capacity == CSV_CHUNK_BYTES);
+
+    closeCsvStream(&stream);
+    remove(TEST_CSV_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_parseDecimal() checks the fast parser against strtod
+*/
+void test_parseDecimal(void){
+
+    printf("test_parseDecimal()...");
+
+    const char* inputs[] = {
+        "0", "-0", "1", "-12.375", "+3.5", "0.001", "5.1", "4e1", "1.5E-3", " 7", "123456789012345678901234",
+        "0.1234567890123456789012", "6.02214076e23", "1e-30", ".5", "5.", "nan", "inf", "-1e400"
+    };
+    int numInputs = sizeof(inputs) / sizeof(inputs[0]);
+
+    for (int i=0; i<numInputs; i++){
+
+        const char* end = inputs[i] + strlen(inputs[i]);
+        const char* next;
+        double parsed = parseDecimal(inputs[i], end, &next);
+
+        char* expectedNext;
+        double expected = strtod(inputs[i], &expectedNext);
+
+        assert(next == expectedNext);
+        if (isnan(expected)){
+            assert(isnan(parsed));
+        }else{
+            assert(parsed == expected || fabs(parsed - expected) <= 1e-15 * fabs(expected));
+        }
+
+        // the single precision value read into datasets is exact
+        assert(isnan(expected) || (float)parsed == strtof(inputs[i], NULL));
+    }
+
+    // the parser stops at the end of its input, not at a terminator
+    const char* field = "12.5,7";
+    assert(parseDecimal(field, field + 2, NULL) == 12.0);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_loadCsvDatasetThreads() checks that every thread count stitches the same dataset as streaming
+*/
+void test_loadCsvDatasetThreads(void){
+
+    printf("test_loadCsvDatasetThreads()...");
+
+    const char* names[] = {"red", "green", "blue", "cyan", "magenta"};
+    int numRows = 40000;
+
+    // header, string labels, blank lines, CRLF line endings and no final newline
+    FILE* file = fopen(TEST_CSV_PATH, "w");
+    fprintf(file, "x,y,z,color\n");
+    for (int row=0; row<numRows; row++){
+
+        fprintf(file, "%d.%d,-%de-2,%d,%s%s", row, row % 10, row % 977, row % 3, names[(row / 7) % 5], row % 2 ? "\r\n" : "\n");
+        if (row % 1000 == 0){
+            fprintf(file, "\n");
+        }
+    }
+    fprintf(file, "1,2,3,black");
+    fclose(file);
+
+    // reference from the streaming reader
+    CsvStream* stream = openCsvStream(TEST_CSV_PATH, NULL);
+    float* features = malloc(sizeof(float) * (numRows + 1) * 3);
+    int32_t* labels = malloc(sizeof(int32_t) * (numRows + 1));
+    assert(nextCsvBatch(stream, features, labels, numRows + 1) == numRows + 1);
+
+    for (int numThreads = 1; numThreads <= 8; numThreads++){
+
+        DenseDataset* dataset = loadCsvDatasetThreads(TEST_CSV_PATH, NULL, numThreads);
+        assert(dataset != NULL);
+        assert(dataset->numRows == (uint64_t)numRows + 1);
+        assert(dataset->numFeatures == 3);
+        assert(dataset->numClasses == 6);
+
+        assert(memcmp(dataset->features, features, sizeof(float) * (numRows + 1) * 3) == 0);
+        assert(memcmp(dataset->labels, labels, sizeof(int32_t) * (numRows + 1)) == 0);
+
+        freeDenseDataset(&dataset);
+    }
+
+    closeCsvStream(&stream);
+    free(features);
+    free(labels);
+    remove(TEST_CSV_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_malformedRows() checks that a wrong field count, text in a numeric column and labels that are not class ids
+ * are rejected with the line they are on, by the streaming and the threaded reader
+*/
+void test_malformedRows(void){
+
+    printf("test_malformedRows()...");
+
+    const char* badRows[] = {"1,2", "1,2,0,4", "1,x,0", "1,2.5.3,0", "1,2,-1", "1,2,2.5", "1,2,abc", "1,2,"};
+    int numBad = sizeof(badRows) / sizeof(badRows[0]);
+    int numRows = 20000, badRow = 15000;
+
+    float features[2 * 64];
+    int32_t labels[64];
+
+    for (int i=0; i<numBad; i++){
+
+        // far enough in that the schema sample and the first chunks of the threaded reader are all valid
+        FILE* file = fopen(TEST_CSV_PATH, "w");
+        fprintf(file, "a,b,label\n");
+        for (int row=0; row<numRows; row++){
+            if (row == badRow){
+                fprintf(file, "%s\n", badRows[i]);
+            }else{
+                fprintf(file, "%d.125,%d,%d\n", row, row % 89, row % 3);
+            }
+        }
+        fclose(file);
+
+        CsvStream* stream = openCsvStream(TEST_CSV_PATH, NULL);
+        assert(stream != NULL && stream->labelsAreNumeric && stream->numFeatures == 2);
+
+        int numRead, total = 0;
+        while ((numRead = nextCsvBatch(stream, features, labels, 64)) > 0){
+            total += numRead;
+        }
+
+        // the header is line 1, so the bad row is on line badRow + 2, and stays an error
+        assert(numRead == CSV_BAD_ROW);
+        assert(stream->lineNumber == badRow + 2);
+        assert(total <= badRow);
+        assert(nextCsvBatch(stream, features, labels, 64) == CSV_BAD_ROW);
+
+        closeCsvStream(&stream);
+
+        for (int numThreads = 1; numThreads <= 4; numThreads += 3){
+            assert(loadCsvDatasetThreads(TEST_CSV_PATH, NULL, numThreads) == NULL);
+        }
+    }
+
+    remove(TEST_CSV_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_loadCsvDataset() loads the Iris dataset, skipping the id column
+*/
+void test_loadCsvDataset(void){
+
+    printf("test_loadCsvDataset()...");
+
+    CsvOptions options;
+    defaultCsvOptions(&options);
+    options.ignoreColumn = 0;
+
+    DenseDataset* dataset = loadCsvDataset("data/Iris.csv", &options);
+    assert(dataset != NULL);
+    assert(dataset->mapping == NULL);
+    assert(dataset->numRows == 150);
+    assert(dataset->numFeatures == 4);
+    assert(dataset->numClasses == 3);
+
+    // first row: 1,5.1,3.5,1.4,0.2,Iris-setosa
+    const float* row = getFeatureRow(dataset, 0);
+    assert(row[0] == 5.1f && row[1] == 3.5f && row[2] == 1.4f && row[3] == 0.2f);
+    assert(dataset->labels[0] == 0);
+    assert(dataset->labels[149] == 2);
+
+    freeDenseDataset(&dataset);
+
+    assert(loadCsvDataset("data/missing.csv", NULL) == NULL);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_csvSchema();
+    test_csvChunks();
+    test_parseDecimal();
+    test_loadCsvDatasetThreads();
+    test_malformedRows();
+    test_loadCsvDataset();
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+#include "lib.h"
+
+#define TEST_LOADER_CSV_PATH "/tmp/nnc_test_dataLoader.csv"
+
+/**
+ * @note newIndexDataset() creates a dataset whose row i has features {i, -i} and label i % numClasses, so the row a 
+ * batch entry came from can be recovered from its features
+*/
+DenseDataset* newIndexDataset(uint64_t numRows, int numClasses){
+
+    DenseDataset* dataset = newDenseDataset(numRows, 2, numClasses);
+
+    for (uint64_t row=0; row<numRows; row++){
+        dataset->features[row * 2] = (float)row;
+        dataset->features[row * 2 + 1] = -(float)row;
+        dataset->labels[row] = row % numClasses;
+    }
+
+    return dataset;
+}
+
+/**
+ * @note consumeEpoch() drains one epoch from a loader, checks every row is intact and records the order rows came in
+ * @return number of rows in the epoch
+*/
+int consumeEpoch(DataLoader* loader, int epoch, int numClasses, int* seen, int* order){
+
+    Batch* batch;
+    int numRows = 0;
+
+    while ((batch = nextBatch(loader)) != NULL){
+
+        assert(batch->epoch == epoch);
+        for (int i=0; i<batch->numRows; i++){
+
+            int row = (int)batch->features[i * 2];
+            assert(batch->features[i * 2 + 1] == -(float)row);
+            assert(batch->labels[i] == row % numClasses);
+
+            seen[row]++;
+            order[numRows++] = row;
+        }
+
+        releaseBatch(loader);
+    }
+
+    return numRows;
+}
+
+/**
+ * @test test_datasetLoader() checks that every epoch of an in memory dataset delivers each row exactly once, in a new
+ * order every epoch, reproducibly from the seed
+*/
+void test_datasetLoader(void){
+
+    printf("test_datasetLoader()...");
+
+    int numRows = 1000, numClasses = 3, numEpochs = 3;
+    DenseDataset* dataset = newIndexDataset(numRows, numClasses);
+
+    int* seen = calloc(numRows, sizeof(int));
+    int orders[2][3][1000];
+
+    for (int run=0; run<2; run++){
+
+        DataLoader* loader = newDataLoader(dataset, 64, numEpochs, LOADER_SHUFFLE, 42);
+
+        for (int epoch=0; epoch<numEpochs; epoch++){
+
+            memset(seen, 0, numRows * sizeof(int));
+            assert(consumeEpoch(loader, epoch, numClasses, seen, orders[run][epoch]) == numRows);
+
+            for (int row=0; row<numRows; row++){
+                assert(seen[row] == 1);
+            }
+        }
+
+        // every epoch has been delivered
+        assert(nextBatch(loader) == NULL);
+        freeDataLoader(&loader);
+        assert(loader == NULL);
+    }
+
+    // shuffled, differently per epoch, and the same for the same seed
+    int inOrder = 1;
+    for (int row=0; row<numRows; row++){
+        inOrder &= orders[0][0][row] == row;
+    }
+    assert(!inOrder);
+    assert(memcmp(orders[0][0], orders[0][1], sizeof(orders[0][0])) != 0);
+    assert(memcmp(orders[0], orders[1], sizeof(orders[0])) == 0);
+
+    // without shuffling rows come in order
+    DataLoader* loader = newDataLoader(dataset, 64, 1, LOADER_NO_SHUFFLE, 42);
+    consumeEpoch(loader, 0, numClasses, seen, orders[0][0]);
+    for (int row=0; row<numRows; row++){
+        assert(orders[0][0][row] == row);
+    }
+    freeDataLoader(&loader);
+
+    // stopping mid epoch while the producer waits on a full ring
+    loader = newDataLoader(dataset, 16, 100, LOADER_SHUFFLE, 1);
+    Batch* batch = nextBatch(loader);
+    assert(batch != NULL && batch->numRows == 16);
+    freeDataLoader(&loader);
+
+    free(seen);
+    freeDenseDataset(&dataset);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_streamLoader() checks that a streamed CSV passes through the shuffle buffer with every row delivered once 
+ * per epoch
+*/
+void test_streamLoader(void){
+
+    printf("test_streamLoader()...");
+
+    int numRows = 5000, numClasses = 4, numEpochs = 2;
+
+    FILE* file = fopen(TEST_LOADER_CSV_PATH, "w");
+    for (int row=0; row<numRows; row++){
+        fprintf(file, "%d,%d,%d\n", row, -row, row % numClasses);
+    }
+    fclose(file);
+
+    CsvStream* stream = openCsvStream(TEST_LOADER_CSV_PATH, NULL);
+    assert(stream != NULL);
+
+    int* seen = calloc(numRows, sizeof(int));
+    int* order = malloc(sizeof(int) * numRows);
+
+    DataLoader* loader = newStreamLoader(stream, 100, 256, numEpochs, 7);
+
+    for (int epoch=0; epoch<numEpochs; epoch++){
+
+        memset(seen, 0, numRows * sizeof(int));
+        assert(consumeEpoch(loader, epoch, numClasses, seen, order) == numRows);
+        assert(getLoaderStatus(loader) == LOADER_END_OF_EPOCH);
+
+        int inOrder = 1;
+        for (int row=0; row<numRows; row++){
+            assert(seen[row] == 1);
+            inOrder &= order[row] == row;
+        }
+        assert(!inOrder);
+    }
+
+    assert(nextBatch(loader) == NULL);
+    assert(getLoaderStatus(loader) == LOADER_DONE);
+    freeDataLoader(&loader);
+
+    closeCsvStream(&stream);
+    remove(TEST_LOADER_CSV_PATH);
+    free(seen);
+    free(order);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_streamLoaderBadRow() checks that a malformed streamed row stops the loader with LOADER_BAD_ROW and its 
+ * line, instead of ending the epoch early as if the file were shorter
+*/
+void test_streamLoaderBadRow(void){
+
+    printf("test_streamLoaderBadRow()...");
+
+    int numRows = 5000, badRow = 3000;
+
+    FILE* file = fopen(TEST_LOADER_CSV_PATH, "w");
+    for (int row=0; row<numRows; row++){
+        fprintf(file, row == badRow ? "%d,oops,%d\n" : "%d,%d,%d\n", row, -row, row % 4);
+    }
+    fclose(file);
+
+    CsvStream* stream = openCsvStream(TEST_LOADER_CSV_PATH, NULL);
+    assert(stream != NULL);
+
+    DataLoader* loader = newStreamLoader(stream, 100, 256, 2, 7);
+
+    Batch* batch;
+    int numDelivered = 0;
+    while ((batch = nextBatch(loader)) != NULL){
+
+        assert(getLoaderStatus(loader) == LOADER_OK && batch->epoch == 0);
+        numDelivered += batch->numRows;
+        releaseBatch(loader);
+    }
+
+    // rows after the bad one are never delivered, and it is not reported as an end of epoch
+    assert(numDelivered < badRow);
+    assert(getLoaderStatus(loader) == LOADER_BAD_ROW);
+    assert(loader->badLine == badRow + 1);
+
+    // and stays stopped
+    assert(nextBatch(loader) == NULL);
+    assert(getLoaderStatus(loader) == LOADER_BAD_ROW);
+
+    freeDataLoader(&loader);
+    closeCsvStream(&stream);
+    remove(TEST_LOADER_CSV_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @note collectRows() drains a loader and records every row it delivers, with the loader position before each batch
+ * @return number of rows delivered
+*/
+int collectRows(DataLoader* loader, int numEpochs, int* rows, LoaderPosition* positions){
+
+    int numRows = 0;
+
+    for (int epoch=getLoaderPosition(loader).epoch; epoch<numEpochs; epoch++){
+
+        Batch* batch;
+        while ((positions[numRows] = getLoaderPosition(loader), batch = nextBatch(loader)) != NULL){
+
+            for (int i=0; i<batch->numRows; i++){
+                positions[numRows + i] = positions[numRows];
+                rows[numRows + i] = (int)batch->features[i * 2];
+            }
+            numRows += batch->numRows;
+
+            releaseBatch(loader);
+        }
+    }
+
+    return numRows;
+}
+
+/**
+ * @test test_resumeLoader() checks that loaders started at a position taken mid epoch from another loader deliver 
+ * exactly the rows the original delivered from there, for in memory and streamed sources
+*/
+void test_resumeLoader(void){
+
+    printf("test_resumeLoader()...");
+
+    int numRows = 300, numEpochs = 3, batchSize = 16;
+    DenseDataset* dataset = newIndexDataset(numRows, 5);
+
+    FILE* file = fopen(TEST_LOADER_CSV_PATH, "w");
+    for (int row=0; row<numRows; row++){
+        fprintf(file, "%d,%d,%d\n", row, -row, row % 5);
+    }
+    fclose(file);
+
+    int* rows = malloc(sizeof(int) * numRows * numEpochs);
+    int* resumedRows = malloc(sizeof(int) * numRows * numEpochs);
+    LoaderPosition* positions = malloc(sizeof(LoaderPosition) * (numRows * numEpochs + 1));
+    LoaderPosition* resumedPositions = malloc(sizeof(LoaderPosition) * (numRows * numEpochs + 1));
+
+    for (int source=0; source<2; source++){
+
+        CsvStream* stream = source == 1 ? openCsvStream(TEST_LOADER_CSV_PATH, NULL) : NULL;
+        DataLoader* loader = source == 0 ? 
+            newDataLoader(dataset, batchSize, numEpochs, LOADER_SHUFFLE, 9) : 
+            newStreamLoader(stream, batchSize, 64, numEpochs, 9);
+
+        assert(collectRows(loader, numEpochs, rows, positions) == numRows * numEpochs);
+        freeDataLoader(&loader);
+
+        // resume in the middle of the second epoch
+        int offset = numRows + 5 * batchSize;
+        LoaderPosition start = positions[offset];
+        assert(start.epoch == 1 && start.batch == 5);
+
+        if (stream != NULL){
+            rewindCsvStream(stream);
+        }
+        loader = source == 0 ? 
+            newDataLoaderAt(dataset, batchSize, numEpochs, LOADER_SHUFFLE, 9, start) : 
+            newStreamLoaderAt(stream, batchSize, 64, numEpochs, 9, start);
+
+        int numResumed = collectRows(loader, numEpochs, resumedRows, resumedPositions);
+        assert(numResumed == numRows * numEpochs - offset);
+        assert(memcmp(resumedRows, rows + offset, sizeof(int) * numResumed) == 0);
+        freeDataLoader(&loader);
+
+        if (stream != NULL){
+            closeCsvStream(&stream);
+        }
+    }
+
+    remove(TEST_LOADER_CSV_PATH);
+    free(rows);
+    free(resumedRows);
+    free(positions);
+    free(resumedPositions);
+    freeDenseDataset(&dataset);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_datasetLoader();
+    test_streamLoader();
+    test_streamLoaderBadRow();
+    test_resumeLoader();
+
+    return 0;
+}
@@ -0,0 +1,475 @@
+#include "lib.h"
+#include <unistd.h>
+
+#define TEST_DATASET_PATH "/tmp/nnc_test_dataset.bin"
+
+/**
+ * @test test_initDatasetHeader() checks the header fields and that both data blocks are aligned
+*/
+void test_initDatasetHeader(void){
+
+    printf("test_initDatasetHeader()...");
+
+    DatasetHeader header;
+    initDatasetHeader(&header, 10, 3, 4);
+
+    assert(memcmp(header.magic, DATASET_MAGIC, 4) == 0);
+    assert(header.version == DATASET_VERSION);
+    assert(header.numRows == 10);
+    assert(header.numFeatures == 3);
+    assert(header.numClasses == 4);
+    assert(header.dtype == DTYPE_FLOAT32);
+
+    // 64 byte header, 10*3 floats = 120 bytes -> labels at 64 + 128
+    assert(header.featuresOffset == 64);
+    assert(header.labelsOffset == 192);
+    assert(header.labelsOffset % DATASET_ALIGNMENT == 0);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_datasetWriter() writes a dataset in two blocks and reads the file back with stdio
+*/
+void test_datasetWriter(void){
+
+    printf("test_datasetWriter()...");
+
+    int numRows = 5, numFeatures = 3;
+    float features[15];
+    int32_t labels[5];
+
+    for (int i=0; i<numRows * numFeatures; i++){
+        features[i] = i * 0.5f;
+    }
+    for (int i=0; i<numRows; i++){
+        labels[i] = i % 2;
+    }
+
+    // write in two blocks
+    DatasetWriter* writer = newDatasetWriter(TEST_DATASET_PATH, numRows, numFeatures, 2);
+    writeDatasetRows(writer, features, labels, 2);
+    writeDatasetRows(writer, features + 2 * numFeatures, labels + 2, 3);
+    closeDatasetWriter(&writer);
+    assert(writer == NULL);
+
+    // read back
+    FILE* file = fopen(TEST_DATASET_PATH, "rb");
+    assert(file != NULL);
+
+    DatasetHeader header;
+    assert(readDatasetHeader(file, &header) == 1);
+    assert(header.numRows == 5);
+
+    float readFeatures[15];
+    int32_t readLabels[5];
+
+    fseeko(file, header.featuresOffset, SEEK_SET);
+    assert(fread(readFeatures, sizeof(float), 15, file) == 15);
+    fseeko(file, header.labelsOffset, SEEK_SET);
+    assert(fread(readLabels, sizeof(int32_t), 5, file) == 5);
+
+    assert(memcmp(readFeatures, features, sizeof(features)) == 0);
+    assert(memcmp(readLabels, labels, sizeof(labels)) == 0);
+
+    fclose(file);
+
+    // a file without the magic is rejected
+    file = fopen(TEST_DATASET_PATH, "rb+");
+    fputc('X', file);
+    rewind(file);
+    assert(readDatasetHeader(file, &header) == 0);
+    fclose(file);
+
+    remove(TEST_DATASET_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_openDenseDataset() checks that a mapped dataset exposes the rows and labels that were written
+*/
+void test_openDenseDataset(void){
+
+    printf("test_openDenseDataset()...");
+
+    int numRows = 100, numFeatures = 7, numClasses = 3;
+    float* features = malloc(sizeof(float) * numRows * numFeatures);
+    int32_t* labels = malloc(sizeof(int32_t) * numRows);
+
+    for (int i=0; i<numRows * numFeatures; i++){
+        features[i] = (float)i;
+    }
+    for (int i=0; i<numRows; i++){
+        labels[i] = i % numClasses;
+    }
+
+    DatasetWriter* writer = newDatasetWriter(TEST_DATASET_PATH, numRows, numFeatures, numClasses);
+    writeDatasetRows(writer, features, labels, numRows);
+    closeDatasetWriter(&writer);
+
+    DenseDataset* dataset = openDenseDataset(TEST_DATASET_PATH);
+    assert(dataset != NULL);
+    assert(dataset->mapping != NULL);
+    assert(dataset->numRows == 100);
+    assert(dataset->numFeatures == 7);
+    assert(dataset->numClasses == 3);
+
+    // rows are read in place from the mapping
+    for (int row=0; row<numRows; row++){
+
+        const float* featureRow = getFeatureRow(dataset, row);
+        assert(memcmp(featureRow, features + row * numFeatures, sizeof(float) * numFeatures) == 0);
+        assert(dataset->labels[row] == labels[row]);
+    }
+
+    freeDenseDataset(&dataset);
+    assert(dataset == NULL);
+
+    // a truncated file is rejected
+    truncate(TEST_DATASET_PATH, 100);
+    assert(openDenseDataset(TEST_DATASET_PATH) == NULL);
+
+    remove(TEST_DATASET_PATH);
+    free(features);
+    free(labels);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @note openCorrupted() writes a valid 10 row dataset, corrupts its header or labels with kind, opens and verifies it
+ * @return 0 if openDenseDataset() returned NULL, 1 if verifyDenseDataset() accepted the file, 2 if it did not
+*/
+int openCorrupted(int kind){
+
+    float features[10 * 4] = {0};
+    int32_t labels[10] = {0, 1, 2, 0, 1, 2, 0, 1, 2, 0};
+
+    DatasetWriter* writer = newDatasetWriter(TEST_DATASET_PATH, 10, 4, 3);
+    writeDatasetRows(writer, features, labels, 10);
+    closeDatasetWriter(&writer);
+
+    DatasetHeader header;
+    FILE* file = fopen(TEST_DATASET_PATH, "rb+");
+    assert(fread(&header, sizeof(DatasetHeader), 1, file) == 1);
+    uint64_t labelsOffset = header.labelsOffset;
+
+    switch (kind){
+        case 1: header.numRows = 1ULL << 62; break;              // feature and label sizes wrap around to 0
+        case 2: header.labelsOffset = UINT64_MAX - 8; break;    // the end of the labels wraps around
+        case 3: header.numFeatures = 0; break;
+        case 4: header.numClasses = 0; break;
+        case 5: header.labelsOffset += 2; break;                // misaligned labels
+        case 6: labels[7] = -1; break;
+        case 7: labels[9] = 3; break;
+        case 8: header.numFeatures = 1U << 31; break;           // negative as an int
+        case 9: header.numClasses = UINT32_MAX; break;
+    }
+
+    rewind(file);
+    fwrite(&header, sizeof(DatasetHeader), 1, file);
+    fseek(file, labelsOffset, SEEK_SET);
+    fwrite(labels, sizeof(int32_t), 10, file);
+    fclose(file);
+
+    DenseDataset* dataset = openDenseDataset(TEST_DATASET_PATH);
+    if (dataset == NULL){
+        return 0;
+    }
+
+    int verified = verifyDenseDataset(dataset);
+    freeDenseDataset(&dataset);
+
+    return verified ? 1 : 2;
+}
+
+/**
+ * @test test_openInvalidDataset() checks that headers whose sizes overflow, that have no features or classes, more than
+ * INT32_MAX of either or that misalign the labels are rejected on open, and that labels outside [0, numClasses) open
+ * but fail verifyDenseDataset()
+*/
+void test_openInvalidDataset(void){
+
+    printf("test_openInvalidDataset()...");
+
+    // the uncorrupted file opens
+    assert(openCorrupted(0) == 1);
+
+    for (int kind=1; kind<=9; kind++){
+        assert(openCorrupted(kind) == (kind == 6 || kind == 7 ? 2 : 0));
+    }
+
+    remove(TEST_DATASET_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_gatherBatch() checks the alignment of an owned DenseDataset and gathers rows out of order
+*/
+void test_gatherBatch(void){
+
+    printf("test_gatherBatch()...");
+
+    DenseDataset* dataset = newDenseDataset(10, 3, 5);
+    assert(dataset->mapping == NULL);
+    assert((uintptr_t)dataset->features % DATASET_ALIGNMENT == 0);
+    assert((uintptr_t)dataset->labels % DATASET_ALIGNMENT == 0);
+
+    for (int i=0; i<30; i++){
+        dataset->features[i] = (float)i;
+    }
+    for (int i=0; i<10; i++){
+        dataset->labels[i] = i % 5;
+    }
+
+    uint64_t rows[4] = {7, 0, 9, 7};
+    float features[12];
+    int32_t labels[4];
+    gatherBatch(dataset, rows, 4, features, labels);
+
+    for (int i=0; i<4; i++){
+
+        assert(memcmp(features + i * 3, getFeatureRow(dataset, rows[i]), sizeof(float) * 3) == 0);
+        assert(labels[i] == (int32_t)rows[i] % 5);
+    }
+
+    freeDenseDataset(&dataset);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_quantizeRow() round trips random rows through both quantized types, checking that every value comes back
+ * within half a quantization step. 13 features cover the vector loop and the scalar tail of dequantizeRow().
+*/
+void test_quantizeRow(void){
+
+    printf("test_quantizeRow()...");
+
+    int numRows = 50, numFeatures = 13;
+    float* features = malloc(sizeof(float) * numRows * numFeatures);
+    float scale[13], offset[13], out[13];
+    int16_t codes[13];
+
+    Rng rng;
+    seedRng(&rng, 7);
+    for (int i=0; i<numRows * numFeatures; i++){
+        features[i] = (float)((i % numFeatures) * rngNormal(&rng));
+    }
+
+    int dtypes[2] = {DTYPE_UINT8, DTYPE_INT16};
+    for (int d=0; d<2; d++){
+
+        computeQuantParams(features, numRows, numFeatures, dtypes[d], scale, offset);
+
+        for (int row=0; row<numRows; row++){
+
+            const float* x = features + row * numFeatures;
+            quantizeRow(x, numFeatures, dtypes[d], scale, offset, codes);
+            dequantizeRow(codes, numFeatures, dtypes[d], scale, offset, out);
+
+            for (int j=0; j<numFeatures; j++){
+                assert(fabsf(out[j] - x[j]) <= scale[j] * 0.5f + 1e-5f * (1 + fabsf(x[j])));
+            }
+        }
+    }
+
+    // column 0 is constant, it still has to come back exactly
+    assert(out[0] == features[0]);
+
+    // values outside the sampled range are clamped to it
+    float wide[13];
+    for (int j=0; j<numFeatures; j++){
+        wide[j] = 1e6f;
+    }
+    computeQuantParams(features, numRows, numFeatures, DTYPE_UINT8, scale, offset);
+    quantizeRow(wide, numFeatures, DTYPE_UINT8, scale, offset, codes);
+    assert(((uint8_t*)codes)[5] == UINT8_MAX);
+
+    free(features);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_quantizedDataset() writes a uint8 dataset, checks its size, then maps it and gathers dequantized rows
+*/
+void test_quantizedDataset(void){
+
+    printf("test_quantizedDataset()...");
+
+    int numRows = 200, numFeatures = 20, numClasses = 4;
+    float* features = malloc(sizeof(float) * numRows * numFeatures);
+    int32_t* labels = malloc(sizeof(int32_t) * numRows);
+
+    for (int i=0; i<numRows * numFeatures; i++){
+        features[i] = (float)(i % 97) / 10 - 3;
+    }
+    for (int i=0; i<numRows; i++){
+        labels[i] = i % numClasses;
+    }
+
+    float scale[20], offset[20];
+    computeQuantParams(features, numRows, numFeatures, DTYPE_UINT8, scale, offset);
+
+    // written in two blocks to reuse the quantization buffer
+    DatasetWriter* writer = newQuantizedDatasetWriter(TEST_DATASET_PATH, numRows, numFeatures, numClasses, DTYPE_UINT8, scale, offset);
+    writeDatasetRows(writer, features, labels, 150);
+    writeDatasetRows(writer, features + 150 * numFeatures, labels + 150, 50);
+    closeDatasetWriter(&writer);
+
+    DatasetHeader header;
+    FILE* file = fopen(TEST_DATASET_PATH, "rb");
+    assert(readDatasetHeader(file, &header) == 1);
+    fclose(file);
+    assert(header.dtype == DTYPE_UINT8);
+    assert(header.quantOffset % DATASET_ALIGNMENT == 0 && header.featuresOffset % DATASET_ALIGNMENT == 0);
+    assert(header.labelsOffset - header.featuresOffset < (uint64_t)numRows * numFeatures * sizeof(float) / 3);
+
+    DenseDataset* dataset = openDenseDataset(TEST_DATASET_PATH);
+    assert(dataset != NULL);
+    assert(dataset->dtype == DTYPE_UINT8 && dataset->features == NULL);
+    assert(memcmp(dataset->scale, scale, sizeof(scale)) == 0);
+    assert(memcmp(dataset->offset, offset, sizeof(offset)) == 0);
+
+    uint64_t rows[3] = {199, 0, 151};
+    float batch[60];
+    int32_t batchLabels[3];
+    gatherBatch(dataset, rows, 3, batch, batchLabels);
+
+    for (int i=0; i<3; i++){
+
+        for (int j=0; j<numFeatures; j++){
+            float x = features[rows[i] * numFeatures + j];
+            assert(fabsf(batch[i * numFeatures + j] - x) <= scale[j] * 0.5f + 1e-5f);
+        }
+        assert(batchLabels[i] == labels[rows[i]]);
+    }
+
+    freeDenseDataset(&dataset);
+    remove(TEST_DATASET_PATH);
+    free(features);
+    free(labels);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @note trainDatasetAccuracy() trains a fresh mlp on the first numTrain rows of a dataset file for two epochs and
+ * returns its accuracy on the float rows that follow them, so models trained on quantized copies are scored on the
+ * same inputs
+*/
+double trainDatasetAccuracy(const char* path, const float* features, const int32_t* labels, int numTrain, int numRows){
+
+    DenseDataset* dataset = openDenseDataset(path);
+    assert(dataset != NULL);
+
+    int numFeatures = dataset->numFeatures, numClasses = dataset->numClasses;
+    int layerSizes[] = {8, 3};
+    MLP* mlp = newMLPInit(numFeatures, layerSizes, 2, INIT_XAVIER, 7);
+
+    float row[4];
+    int32_t label;
+
+    for (int epoch=0; epoch<2; epoch++){
+        for (uint64_t i=0; i<(uint64_t)numTrain; i++){
+
+            gatherBatch(dataset, &i, 1, row, &label);
+
+            Value** output = ForwardRow(mlp, row);
+            double* softmax = Softmax(output, numClasses);
+            Value* loss = sparseCategoricalCrossEntropy(output, label, softmax, numClasses, mlp->graphStack);
+
+            BackwardSparse(loss, softmax, label);
+            Step(mlp, 0.05);
+            ZeroGrad(mlp);
+        }
+    }
+
+    InferenceModel* model = newInferenceModel(mlp);
+    double scratch[2 * 8 + 3], probs[3];
+    int numCorrect = 0;
+
+    for (int i=numTrain; i<numRows; i++){
+
+        int32_t prediction;
+        predictRow(model, features + i * numFeatures, scratch, &prediction, probs);
+        numCorrect += prediction == labels[i];
+    }
+
+    freeInferenceModel(&model);
+    freeMLP(&mlp);
+    freeDenseDataset(&dataset);
+
+    return (double)numCorrect / (numRows - numTrain);
+}
+
+/**
+ * @test test_quantizedTraining() trains the same model on float32, uint8 and int16 copies of an overlapping 3 class
+ * dataset and checks that quantizing the training rows costs at most a point of held out accuracy
+*/
+void test_quantizedTraining(void){
+
+    printf("test_quantizedTraining()...");
+
+    int numRows = 1500, numTrain = 1000, numFeatures = 4, numClasses = 3;
+    float* features = malloc(sizeof(float) * numRows * numFeatures);
+    int32_t* labels = malloc(sizeof(int32_t) * numRows);
+
+    // centers drawn as gen_dataset does with separability 2, the classes overlap enough to keep accuracy well below 1
+    Rng rng;
+    seedRng(&rng, 3);
+    double centers[12];
+    for (int i=0; i<numClasses * numFeatures; i++){
+        centers[i] = 2.0 * rngNormal(&rng);
+    }
+    for (int i=0; i<numRows; i++){
+
+        labels[i] = (int32_t)rngBelow(&rng, numClasses);
+        for (int j=0; j<numFeatures; j++){
+            features[i * numFeatures + j] = (float)(centers[labels[i] * numFeatures + j] + rngNormal(&rng));
+        }
+    }
+
+    DatasetWriter* writer = newDatasetWriter(TEST_DATASET_PATH, numRows, numFeatures, numClasses);
+    writeDatasetRows(writer, features, labels, numRows);
+    closeDatasetWriter(&writer);
+    double accuracy = trainDatasetAccuracy(TEST_DATASET_PATH, features, labels, numTrain, numRows);
+    assert(accuracy > 0.6);
+
+    int dtypes[2] = {DTYPE_UINT8, DTYPE_INT16};
+    for (int k=0; k<2; k++){
+
+        float scale[4], offset[4];
+        computeQuantParams(features, numRows, numFeatures, dtypes[k], scale, offset);
+
+        writer = newQuantizedDatasetWriter(TEST_DATASET_PATH, numRows, numFeatures, numClasses, dtypes[k], scale, offset);
+        writeDatasetRows(writer, features, labels, numRows);
+        closeDatasetWriter(&writer);
+
+        double quantizedAccuracy = trainDatasetAccuracy(TEST_DATASET_PATH, features, labels, numTrain, numRows);
+        assert(fabs(quantizedAccuracy - accuracy) <= 0.01);
+    }
+
+    remove(TEST_DATASET_PATH);
+    free(features);
+    free(labels);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_initDatasetHeader();
+    test_datasetWriter();
+    test_openDenseDataset();
+    test_openInvalidDataset();
+    test_gatherBatch();
+    test_quantizeRow();
+    test_quantizedDataset();
+    test_quantizedTraining();
+
+    return 0;
+}
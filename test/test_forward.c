@@ -239,6 +239,52 @@ void test_repeatedBackward(void){
     printf("PASS!\n");
 }
 
+/**
+ * @test test_ForwardRow() checks that a forward pass on a float row matches Forward() on the same inputs as Values
+*/
+void test_ForwardRow(void){
+
+    printf("test_ForwardRow()...");
+
+    int inputSize = 3;
+    int layerSizes[] = {16, 8, 4, 2};
+    int numLayers = 4;
+    MLP* mlp = newMLP(inputSize, layerSizes, numLayers);
+
+    // reference pass on Values
+    Value** input = newOutputVector(inputSize);
+    input[0]->value = 1;
+    input[1]->value = 2.5;
+    input[2]->value = -3;
+
+    Value** output = Forward(mlp, input);
+    double expected[2] = {output[0]->value, output[1]->value};
+    releaseGraph(mlp->graphStack);
+
+    for (int i=0; i<inputSize; i++){
+        freeValue(&input[i]);
+    }
+    free(input);
+
+    // the same pass on a row, twice to check the input Values are released with the graph
+    float row[3] = {1, 2.5f, -3};
+    for (int pass=0; pass<2; pass++){
+
+        output = ForwardRow(mlp, row);
+        assert(output[0]->value == expected[0]);
+        assert(output[1]->value == expected[1]);
+
+        Value* sum = Add(output[0], output[1], mlp->graphStack);
+        Backward(sum, NULL, NULL);
+        releaseGraph(mlp->graphStack);
+        assert(mlp->graphStack->len == 1);
+    }
+
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
 int main(void){
 
     test_newOutputVector();
@@ -247,6 +293,7 @@ int main(void){
     test_ApplyReLU();
     test_Forward();
     test_repeatedBackward();
+    test_ForwardRow();
 
     return 0;
 }
\ No newline at end of file
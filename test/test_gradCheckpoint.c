@@ -0,0 +1,165 @@
+#include "lib.h"
+
+/**
+ * @helper collectGrads() copies the weight and bias grads of an mlp into a flat array of doubles
+*/
+double* collectGrads(MLP* mlp, int* numGrads){
+
+    int count = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+        count += layer->inputSize * layer->outputSize + layer->outputSize;
+    }
+
+    double* grads = malloc(sizeof(double) * count);
+    assert(grads != NULL);
+
+    int idx = 0;
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+
+        for (int i=0; i<(layer->inputSize * layer->outputSize); i++){
+            grads[idx++] = layer->weights[i]->grad;
+        }
+        for (int i=0; i<layer->outputSize; i++){
+            grads[idx++] = layer->biases[i]->grad;
+        }
+    }
+
+    *numGrads = count;
+    return grads;
+}
+
+/**
+ * @helper sumOutputs() reduces an mlp output vector to a single Value for Backward()
+*/
+Value* sumOutputs(Value** output, int outputSize, GraphStack* graphStack){
+
+    Value* sum = output[0];
+    for (int i=1; i<outputSize; i++){
+        sum = Add(sum, output[i], graphStack);
+    }
+
+    return sum;
+}
+
+/**
+ * @test test_sqrtCheckpointInterval() checks the segment length chosen for a few depths
+*/
+void test_sqrtCheckpointInterval(void){
+
+    printf("test_sqrtCheckpointInterval()...");
+
+    assert(sqrtCheckpointInterval(1) == 1);
+    assert(sqrtCheckpointInterval(4) == 2);
+    assert(sqrtCheckpointInterval(9) == 3);
+    assert(sqrtCheckpointInterval(10) == 4);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_setCheckpointInterval() checks that enabling and disabling checkpointing sets up the mlp's segments
+*/
+void test_setCheckpointInterval(void){
+
+    printf("test_setCheckpointInterval()...");
+
+    int inputSize = 3;
+    int layerSizes[] = {8, 8, 8, 8, 8, 8, 8, 2};
+    int numLayers = 8;
+    MLP* mlp = newMLP(inputSize, layerSizes, numLayers);
+
+    // disabled by default
+    assert(mlp->checkpointInterval == NO_CHECKPOINTING);
+    assert(mlp->segmentInputs == NULL);
+
+    // 8 layers w/ segments of 3 layers -> 3 segments
+    setCheckpointInterval(mlp, 3);
+    assert(mlp->checkpointInterval == 3);
+    assert(mlp->numSegments == 3);
+    assert(mlp->checkpointStack != NULL);
+
+    // sqrt(8) rounds up to 3 as well
+    setCheckpointInterval(mlp, CHECKPOINT_SQRT);
+    assert(mlp->checkpointInterval == 3);
+
+    setCheckpointInterval(mlp, NO_CHECKPOINTING);
+    assert(mlp->numSegments == 0);
+    assert(mlp->segmentInputs == NULL);
+    assert(mlp->checkpointStack == NULL);
+
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_CheckpointBackward() checks that a checkpointed forward/backward pass keeps a smaller graph alive and 
+ * produces the same parameter gradients as an uncheckpointed pass
+*/
+void test_CheckpointBackward(void){
+
+    printf("test_CheckpointBackward()...");
+
+    int inputSize = 3;
+    int layerSizes[] = {8, 8, 8, 8, 8, 8, 8, 2};
+    int numLayers = 8;
+    MLP* mlp = newMLP(inputSize, layerSizes, numLayers);
+
+    // keep activations alive so gradients reach every layer
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+        for (int i=0; i<layer->outputSize; i++){
+            layer->biases[i]->value = 1;
+        }
+    }
+
+    Value** input = newOutputVector(inputSize);
+    input[0]->value = 1;
+    input[1]->value = 2;
+    input[2]->value = 3;
+
+    // reference pass without checkpointing
+    Value** output = Forward(mlp, input);
+    int fullGraphLen = mlp->graphStack->len;
+    Backward(sumOutputs(output, 2, mlp->graphStack), NULL, NULL);
+
+    int numGrads = 0;
+    double* expected = collectGrads(mlp, &numGrads);
+    ZeroGrad(mlp);
+
+    // checkpointed pass
+    setCheckpointInterval(mlp, CHECKPOINT_SQRT);
+
+    output = Forward(mlp, input);
+    assert(mlp->graphStack->len < fullGraphLen);
+    Backward(sumOutputs(output, 2, mlp->graphStack), NULL, NULL);
+    CheckpointBackward(mlp);
+
+    double* actual = collectGrads(mlp, &numGrads);
+    for (int i=0; i<numGrads; i++){
+        assert(fabs(expected[i] - actual[i]) <= 1e-9 * (1 + fabs(expected[i])));
+    }
+
+    // ZeroGrad() releases the boundaries along with the graph
+    ZeroGrad(mlp);
+    assert(mlp->checkpointStack->len == 1);
+
+    // cleanup
+    free(expected);
+    free(actual);
+    for (int i=0; i<inputSize; i++){
+        freeValue(&input[i]);
+    }
+    free(input);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_sqrtCheckpointInterval();
+    test_setCheckpointInterval();
+    test_CheckpointBackward();
+
+    return 0;
+}
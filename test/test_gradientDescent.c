@@ -33,15 +33,17 @@ void test_Step(void){
     Step(mlp, lr);
 
 
-    // check that all weights are now zero
+    // check that all weights and biases are now zero and the gradients untouched
     layer = mlp->inputLayer;
     while (layer != NULL){
 
         for (int i=0; i< (layer->inputSize * layer->outputSize); i++){
-            assert(layer->weights[i]->grad == 0);
+            assert(layer->weights[i]->value == 0);
+            assert(layer->weights[i]->grad == 1);
         }
         for (int i=0; i<layer->outputSize; i++){
-            assert(layer->weights[i]->grad == 0);
+            assert(layer->biases[i]->value == 0);
+            assert(layer->biases[i]->grad == 1);
         }
 
         layer = layer->next;
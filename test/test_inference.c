@@ -0,0 +1,239 @@
+#include "lib.h"
+
+#define TEST_MODEL_PATH "/tmp/nnc_test_inference.bin"
+
+// the allocator is interposed to count heap calls while countAllocations is set, forwarding to glibc's
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t num, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void* ptr);
+
+int countAllocations = 0;
+long long numAllocations = 0;
+
+void* malloc(size_t size){
+    numAllocations += countAllocations;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size){
+    numAllocations += countAllocations;
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size){
+    numAllocations += countAllocations;
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size){
+    numAllocations += countAllocations;
+    return __libc_memalign(alignment, size);
+}
+
+void free(void* ptr){
+    numAllocations += countAllocations && ptr != NULL;
+    __libc_free(ptr);
+}
+
+/**
+ * @test test_openInferenceModel() maps a saved model and checks that its layers point into the mapping and that its 
+ * graph free forward pass matches Forward() on the original mlp
+*/
+void test_openInferenceModel(void){
+
+    printf("test_openInferenceModel()...");
+
+    int layerSizes[] = {16, 8, 3};
+    MLP* mlp = newMLP(5, layerSizes, 3);
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+
+    InferenceModel* model = openInferenceModel(TEST_MODEL_PATH);
+    assert(model != NULL);
+    assert(model->numLayers == 3 && model->inputSize == 5 && model->outputSize == 3);
+    assert(model->maxWidth == 16);
+    assert(model->params == NULL);
+    assert(verifyInferenceModel(model) == 1);
+
+    // zero copy: the parameters are read in place from the mapping
+    for (int i=0; i<model->numLayers; i++){
+
+        const char* weights = (const char*)model->layers[i].weights;
+        assert(weights >= (char*)model->mapping && weights < (char*)model->mapping + model->mapLen);
+        assert((uintptr_t)weights % MODEL_ALIGNMENT == 0);
+    }
+
+    double* scratch = malloc(sizeof(double) * 2 * model->maxWidth);
+    double output[3];
+
+    float rows[3][5] = {{0.5f, -1, 2, 0.25f, 1}, {0, 0, 0, 0, 0}, {-3, 1.5f, 0.75f, 2, -0.5f}};
+    for (int r=0; r<3; r++){
+
+        forwardInference(model, rows[r], scratch, output);
+
+        Value** expected = ForwardRow(mlp, rows[r]);
+        for (int i=0; i<3; i++){
+            assert(fabs(output[i] - expected[i]->value) < 1e-12);
+        }
+        ZeroGrad(mlp);
+    }
+
+    free(scratch);
+    freeInferenceModel(&model);
+    assert(model == NULL);
+    freeMLP(&mlp);
+
+    // not a model file
+    FILE* file = fopen(TEST_MODEL_PATH, "wb");
+    fputs("not a model", file);
+    fclose(file);
+    assert(openInferenceModel(TEST_MODEL_PATH) == NULL);
+
+    remove(TEST_MODEL_PATH);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_newInferenceModel() snapshots an mlp and checks the snapshot is independent of later updates to it
+*/
+void test_newInferenceModel(void){
+
+    printf("test_newInferenceModel()...");
+
+    int layerSizes[] = {7, 2};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+
+    InferenceModel* model = newInferenceModel(mlp);
+    assert(model->mapping == NULL && model->params != NULL);
+    assert(model->outputSize == 2 && model->maxWidth == 7);
+    assert(verifyInferenceModel(model) == 1);
+
+    float row[3] = {1, -2, 0.5f};
+    double scratch[14], before[2], after[2];
+    forwardInference(model, row, scratch, before);
+
+    Value** expected = ForwardRow(mlp, row);
+    for (int i=0; i<2; i++){
+        assert(fabs(before[i] - expected[i]->value) < 1e-12);
+    }
+    ZeroGrad(mlp);
+
+    // the snapshot does not see changes to the mlp
+    mlp->outputLayer->biases[0]->value += 100;
+    forwardInference(model, row, scratch, after);
+    assert(before[0] == after[0] && before[1] == after[1]);
+
+    freeInferenceModel(&model);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_inferenceContext() checks that once a context (or a pool) has been created, running rows through it 
+ * gives the outputs of forwardInference() without a single call to the allocator, with per call latencies recorded
+*/
+void test_inferenceContext(void){
+
+    printf("test_inferenceContext()...");
+
+    int layerSizes[] = {24, 40, 6};
+    MLP* mlp = newMLP(10, layerSizes, 3);
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+
+    InferenceModel* models[2] = {newInferenceModel(mlp), openInferenceModel(TEST_MODEL_PATH)};
+    assert(models[1] != NULL);
+
+    Rng rng;
+    seedRng(&rng, 12);
+
+    int numRows = 300;
+    float* rows = malloc(sizeof(float) * numRows * 10);
+    for (int i=0; i<numRows * 10; i++){
+        rows[i] = (float)rngNormal(&rng);
+    }
+
+    double* expected = malloc(sizeof(double) * numRows * 6);
+    double* outputs = malloc(sizeof(double) * numRows * 6);
+    int32_t* labels = malloc(sizeof(int32_t) * numRows);
+    double* scratch = malloc(sizeof(double) * 2 * 40);
+    for (int row=0; row<numRows; row++){
+        forwardInference(models[0], rows + row * 10, scratch, expected + row * 6);
+    }
+
+    for (int m=0; m<2; m++){
+
+        InferenceContext* context = newInferenceContext(models[m]);
+        assert(context->pong == context->ping + 40 && context->output == context->ping + 80);
+        assert((uintptr_t)context->ping % MODEL_ALIGNMENT == 0);
+
+        enableContextLatency(context);
+
+        InferencePool* pool = newInferencePool(2);
+        predictBatch(pool, models[m], rows, numRows, labels, NULL);
+
+        countAllocations = 1;
+        numAllocations = 0;
+
+        int32_t batchLabels[300];
+        predictBatch(pool, models[m], rows, numRows, batchLabels, NULL);
+
+        for (int row=0; row<numRows; row++){
+
+            const double* output = forwardContext(context, rows + row * 10);
+            assert(output == context->output);
+            memcpy(outputs + row * 6, output, sizeof(double) * 6);
+
+            double probs[6];
+            labels[row] = predictContext(context, rows + row * 10, probs);
+        }
+
+        countAllocations = 0;
+        assert(numAllocations == 0);
+
+        assert(memcmp(outputs, expected, sizeof(double) * numRows * 6) == 0);
+        assert(memcmp(labels, batchLabels, sizeof(int32_t) * numRows) == 0);
+
+        // one value per forwardContext() and predictContext() call, merged with a context that records nothing
+        InferenceContext* contexts[2] = {context, newInferenceContext(models[m])};
+        LatencyHistogram merged;
+        mergeContextLatencies(contexts, 2, &merged);
+        assert(merged.count == 2 * (uint64_t)numRows && merged.count == context->latency->count);
+        assert(merged.max > 0 && merged.min <= merged.max);
+        freeInferenceContext(&contexts[1]);
+
+        freeInferencePool(&pool);
+        freeInferenceContext(&context);
+        assert(context == NULL);
+    }
+
+    // the interposer does see allocations, ie: those of the graph building forward pass
+    countAllocations = 1;
+    ForwardRow(mlp, rows);
+    countAllocations = 0;
+    assert(numAllocations > 0);
+    ZeroGrad(mlp);
+
+    remove(TEST_MODEL_PATH);
+    free(rows);
+    free(expected);
+    free(outputs);
+    free(labels);
+    free(scratch);
+    freeInferenceModel(&models[0]);
+    freeInferenceModel(&models[1]);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_openInferenceModel();
+    test_newInferenceModel();
+    test_inferenceContext();
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "lib.h"
+
+/**
+ * @note newRandomRows() fills a row major numRows x numFeatures matrix with normally distributed features
+*/
+float* newRandomRows(int64_t numRows, int numFeatures, uint64_t seed){
+
+    Rng rng;
+    seedRng(&rng, seed);
+
+    float* features = malloc(sizeof(float) * numRows * numFeatures);
+    assert(features != NULL);
+    for (int64_t i=0; i<numRows * numFeatures; i++){
+        features[i] = (float)rngNormal(&rng);
+    }
+
+    return features;
+}
+
+/**
+ * @test test_predictRow() checks the argmax and probabilities of a row against Forward() and Softmax() on the mlp
+*/
+void test_predictRow(void){
+
+    printf("test_predictRow()...");
+
+    int layerSizes[] = {12, 4};
+    MLP* mlp = newMLP(6, layerSizes, 2);
+    InferenceModel* model = newInferenceModel(mlp);
+
+    float* features = newRandomRows(20, 6, 3);
+    double* scratch = malloc(sizeof(double) * (2 * model->maxWidth + model->outputSize));
+
+    for (int row=0; row<20; row++){
+
+        int32_t label;
+        double probs[4];
+        predictRow(model, features + row * 6, scratch, &label, probs);
+
+        Value** output = ForwardRow(mlp, features + row * 6);
+        double* softmax = Softmax(output, 4);
+
+        double probSum = 0;
+        for (int i=0; i<4; i++){
+            assert(fabs(probs[i] - softmax[i]) < 1e-9);
+            assert(output[i]->value <= output[label]->value);
+            probSum += probs[i];
+        }
+        assert(fabs(probSum - 1) < 1e-12);
+
+        // ties go to the lowest class
+        for (int i=0; i<label; i++){
+            assert(output[i]->value < output[label]->value);
+        }
+
+        freeSoftmax(&softmax);
+        ZeroGrad(mlp);
+    }
+
+    free(scratch);
+    free(features);
+    freeInferenceModel(&model);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_predictBatch() checks that pools of different sizes predict exactly what predictRow() does row by row, 
+ * over several batches and models of different widths on the same pool
+*/
+void test_predictBatch(void){
+
+    printf("test_predictBatch()...");
+
+    int narrowSizes[] = {8, 5}, wideSizes[] = {64, 32, 5};
+    MLP* narrow = newMLP(10, narrowSizes, 2);
+    MLP* wide = newMLP(10, wideSizes, 3);
+    InferenceModel* models[2] = {newInferenceModel(narrow), newInferenceModel(wide)};
+
+    // not a multiple of PREDICT_CHUNK_ROWS
+    int64_t numRows = 3 * PREDICT_CHUNK_ROWS + 17;
+    float* features = newRandomRows(numRows, 10, 8);
+
+    int32_t* labels = malloc(sizeof(int32_t) * numRows);
+    int32_t* expectedLabels = malloc(sizeof(int32_t) * numRows);
+    double* probs = malloc(sizeof(double) * numRows * 5);
+    double* expectedProbs = malloc(sizeof(double) * numRows * 5);
+    double* scratch = malloc(sizeof(double) * (2 * 64 + 5));
+
+    int numThreads[3] = {1, 3, 0};
+    for (int p=0; p<3; p++){
+
+        InferencePool* pool = newInferencePool(numThreads[p]);
+        assert(pool->numWorkers >= 1);
+
+        for (int m=0; m<2; m++){
+
+            for (int64_t row=0; row<numRows; row++){
+                predictRow(models[m], features + row * 10, scratch, expectedLabels + row, expectedProbs + row * 5);
+            }
+
+            memset(labels, 0xff, sizeof(int32_t) * numRows);
+            memset(probs, 0, sizeof(double) * numRows * 5);
+            predictBatch(pool, models[m], features, numRows, labels, probs);
+
+            assert(memcmp(labels, expectedLabels, sizeof(int32_t) * numRows) == 0);
+            assert(memcmp(probs, expectedProbs, sizeof(double) * numRows * 5) == 0);
+
+            // labels only, then an empty batch
+            memset(labels, 0xff, sizeof(int32_t) * numRows);
+            predictBatch(pool, models[m], features, numRows, labels, NULL);
+            assert(memcmp(labels, expectedLabels, sizeof(int32_t) * numRows) == 0);
+            predictBatch(pool, models[m], NULL, 0, labels, NULL);
+        }
+
+        freeInferencePool(&pool);
+        assert(pool == NULL);
+    }
+
+    free(features);
+    free(labels);
+    free(expectedLabels);
+    free(probs);
+    free(expectedProbs);
+    free(scratch);
+    freeInferenceModel(&models[0]);
+    freeInferenceModel(&models[1]);
+    freeMLP(&narrow);
+    freeMLP(&wide);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_predictRow();
+    test_predictBatch();
+
+    return 0;
+}
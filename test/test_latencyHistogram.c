@@ -0,0 +1,150 @@
+#include "lib.h"
+
+#define TEST_LATENCY_PATH "/tmp/nnc_test_latencies.txt"
+
+/**
+ * @test test_latencyBucket() checks that the buckets tile the value range without gaps, that every value lands in the 
+ * bucket that contains it and that no bucket is wider than 1/32 of its values
+*/
+void test_latencyBucket(void){
+
+    printf("test_latencyBucket()...");
+
+    for (int bucket=0; bucket<LATENCY_NUM_BUCKETS; bucket++){
+
+        uint64_t lower = bucketLowerBound(bucket), upper = bucketUpperBound(bucket);
+        assert(lower <= upper);
+        assert(latencyBucket(lower) == bucket && latencyBucket(upper) == bucket);
+        assert((upper - lower + 1) * LATENCY_SUB_BUCKETS <= (lower > LATENCY_SUB_BUCKETS ? lower : LATENCY_SUB_BUCKETS));
+
+        if (bucket + 1 < LATENCY_NUM_BUCKETS){
+            assert(bucketLowerBound(bucket + 1) == upper + 1);
+        }
+    }
+
+    // exact below LATENCY_SUB_BUCKETS, clamped from 2^LATENCY_MAX_EXPONENT
+    assert(latencyBucket(0) == 0 && latencyBucket(31) == 31);
+    assert(bucketUpperBound(LATENCY_NUM_BUCKETS - 1) == (1ULL << LATENCY_MAX_EXPONENT) - 1);
+    assert(latencyBucket(1ULL << LATENCY_MAX_EXPONENT) == LATENCY_NUM_BUCKETS - 1);
+    assert(latencyBucket(UINT64_MAX) == LATENCY_NUM_BUCKETS - 1);
+
+    Rng rng;
+    seedRng(&rng, 6);
+    for (int i=0; i<100000; i++){
+
+        uint64_t ns = rngNext(&rng) >> (28 + rngBelow(&rng, 36));
+        int bucket = latencyBucket(ns);
+        assert(bucketLowerBound(bucket) <= ns && ns <= bucketUpperBound(bucket));
+    }
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_latencyPercentile() checks percentiles against a known distribution and that merging two histograms is 
+ * the same as recording into one
+*/
+void test_latencyPercentile(void){
+
+    printf("test_latencyPercentile()...");
+
+    LatencyHistogram* all = malloc(sizeof(LatencyHistogram));
+    LatencyHistogram* evens = malloc(sizeof(LatencyHistogram));
+    LatencyHistogram* odds = malloc(sizeof(LatencyHistogram));
+    resetLatencyHistogram(all);
+    resetLatencyHistogram(evens);
+    resetLatencyHistogram(odds);
+
+    assert(latencyPercentile(all, 99) == 0 && latencyMean(all) == 0);
+
+    for (uint64_t ns=1; ns<=100000; ns++){
+        recordLatency(all, ns);
+        recordLatency(ns % 2 ? odds : evens, ns);
+    }
+
+    assert(all->count == 100000 && all->min == 1 && all->max == 100000);
+    assert(latencyMean(all) == 50000.5);
+
+    // never below the true percentile, at most one bucket width above it
+    double ps[4] = {50, 90, 99, 99.9};
+    uint64_t exact[4] = {50000, 90000, 99000, 99900};
+    for (int i=0; i<4; i++){
+
+        uint64_t value = latencyPercentile(all, ps[i]);
+        assert(value >= exact[i] && value <= exact[i] + exact[i] / LATENCY_SUB_BUCKETS);
+    }
+    assert(latencyPercentile(all, 100) == 100000);
+    assert(latencyPercentile(all, 0) == 1);
+
+    mergeLatencyHistogram(evens, odds);
+    assert(memcmp(evens, all, sizeof(LatencyHistogram)) == 0);
+
+    free(all);
+    free(evens);
+    free(odds);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_batchLatencies() checks the batch size classes and that a pool with latencies enabled records every 
+ * predictBatch() call in the class of its batch size, and writes them out
+*/
+void test_batchLatencies(void){
+
+    printf("test_batchLatencies()...");
+
+    assert(batchSizeClass(1) == 0 && batchSizeClass(2) == 1 && batchSizeClass(3) == 1);
+    assert(batchSizeClass(256) == 8 && batchSizeClass(1LL << 40) == LATENCY_BATCH_CLASSES - 1);
+
+    int layerSizes[] = {8, 3};
+    MLP* mlp = newMLP(4, layerSizes, 2);
+    InferenceModel* model = newInferenceModel(mlp);
+    InferencePool* pool = newInferencePool(2);
+
+    float* features = calloc(256 * 4, sizeof(float));
+    int32_t* labels = malloc(sizeof(int32_t) * 256);
+
+    // not recorded before enabling
+    predictBatch(pool, model, features, 256, labels, NULL);
+    enablePoolLatencies(pool);
+
+    predictBatch(pool, model, features, 1, labels, NULL);
+    predictBatch(pool, model, features, 100, labels, NULL);
+    predictBatch(pool, model, features, 127, labels, NULL);
+    predictBatch(pool, model, features, 256, labels, NULL);
+
+    assert(pool->latencies->classes[0].count == 1);
+    assert(pool->latencies->classes[6].count == 2);
+    assert(pool->latencies->classes[8].count == 1);
+    assert(pool->latencies->classes[8].min > 0);
+
+    assert(writeBatchLatencies(pool->latencies, TEST_LATENCY_PATH) == 1);
+
+    FILE* file = fopen(TEST_LATENCY_PATH, "r");
+    char line[256];
+    int numSummaries = 0;
+    while (fgets(line, sizeof(line), file) != NULL){
+        numSummaries += line[0] == '#';
+    }
+    fclose(file);
+    assert(numSummaries == 3);
+
+    remove(TEST_LATENCY_PATH);
+    freeInferencePool(&pool);
+    freeInferenceModel(&model);
+    freeMLP(&mlp);
+    free(features);
+    free(labels);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_latencyBucket();
+    test_latencyPercentile();
+    test_batchLatencies();
+
+    return 0;
+}
@@ -88,10 +88,90 @@ void test_categoricalCrossEntropy(void){
     printf("PASS!\n");
 }
 
+/**
+ * @test test_newOneHotTargets() checks that the target table holds a one hot vector per class label
+*/
+void test_newOneHotTargets(void){
+
+    printf("test_newOneHotTargets()...");
+
+    int numClasses = 4;
+    Value*** targets = newOneHotTargets(numClasses);
+
+    for (int label=0; label<numClasses; label++){
+        for (int class=0; class<numClasses; class++){
+            assert(targets[label][class]->value == (class == label));
+        }
+    }
+
+    freeOneHotTargets(&targets, numClasses);
+    assert(targets == NULL);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_sparseCategoricalCrossEntropy() checks that the index based loss and its gradient match 
+ * categoricalCrossEntropy() with the equivalent one hot target vector
+*/
+void test_sparseCategoricalCrossEntropy(void){
+
+    printf("test_sparseCategoricalCrossEntropy()...");
+
+    int numClasses = 5, label = 3;
+    double logits[5] = {0.5, -1.0, 2.0, 1.5, 0.0};
+
+    Value*** targets = newOneHotTargets(numClasses);
+    Value* denseOutputs[5];
+    Value* sparseOutputs[5];
+
+    for (int i=0; i<numClasses; i++){
+        denseOutputs[i] = newValue(logits[i], NULL, NO_ANCESTORS, "value");
+        sparseOutputs[i] = newValue(logits[i], NULL, NO_ANCESTORS, "value");
+    }
+
+    GraphStack* graphStack = newGraphStack();
+
+    // dense reference
+    double* softmax = Softmax(denseOutputs, numClasses);
+    Value* denseLoss = categoricalCrossEntropy(denseOutputs, targets[label], softmax, numClasses, graphStack);
+    Backward(denseLoss, softmax, targets[label]);
+
+    // index based
+    softmax = Softmax(sparseOutputs, numClasses);
+    Value* sparseLoss = sparseCategoricalCrossEntropy(sparseOutputs, label, softmax, numClasses, graphStack);
+    assert(fabs(sparseLoss->value - denseLoss->value) < 1e-12);
+
+    // gradient of softmax cross entropy: softmax - onehot
+    double expected[5];
+    for (int i=0; i<numClasses; i++){
+        expected[i] = softmax[i] - (i == label);
+    }
+
+    BackwardSparse(sparseLoss, softmax, label);
+
+    for (int i=0; i<numClasses; i++){
+        assert(fabs(sparseOutputs[i]->grad - expected[i]) < 1e-12);
+        assert(fabs(sparseOutputs[i]->grad - denseOutputs[i]->grad) < 1e-12);
+    }
+
+    releaseGraph(graphStack);
+    graphPreservingStackRelease(&graphStack);
+    for (int i=0; i<numClasses; i++){
+        freeValue(&denseOutputs[i]);
+        freeValue(&sparseOutputs[i]);
+    }
+    freeOneHotTargets(&targets, numClasses);
+
+    printf("PASS!\n");
+}
+
 int main(void){
 
     test_Softmax();
     test_categoricalCrossEntropy();
+    test_newOneHotTargets();
+    test_sparseCategoricalCrossEntropy();
 
     return 0;
 }
\ No newline at end of file
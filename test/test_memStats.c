@@ -0,0 +1,135 @@
+#include "lib.h"
+
+/**
+ * @test test_valueAccounting() checks that creating and freeing Value structs is reflected in the MEM_VALUES counter
+*/
+void test_valueAccounting(void){
+
+    printf("test_valueAccounting()...");
+
+    MemStats before, during, after;
+    getMemStats(&before);
+
+    Value* a = newValue(1, NULL, NO_ANCESTORS, "a");
+    Value* b = newValue(2, NULL, NO_ANCESTORS, "b");
+    Value* c = newValue(3, (Value*[]){a, b}, 2, "c");
+
+    getMemStats(&during);
+    assert(during.categories[MEM_VALUES].count == before.categories[MEM_VALUES].count + 3);
+    assert(during.categories[MEM_VALUES].bytes == 
+        before.categories[MEM_VALUES].bytes + (long long)(valueBytes(a) + valueBytes(b) + valueBytes(c)));
+    assert(valueBytes(c) == sizeof(Value) + 2 * sizeof(Value*) + 2);
+
+    freeValue(&a);
+    freeValue(&b);
+    freeValue(&c);
+
+    getMemStats(&after);
+    assert(after.categories[MEM_VALUES].count == before.categories[MEM_VALUES].count);
+    assert(after.categories[MEM_VALUES].bytes == before.categories[MEM_VALUES].bytes);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_parameterAccounting() checks that the Value structs owned by an mlp are counted as parameters, and that 
+ * freeMLP() returns every counter to where it started
+*/
+void test_parameterAccounting(void){
+
+    printf("test_parameterAccounting()...");
+
+    MemStats before, during, after;
+    getMemStats(&before);
+
+    int inputSize = 4;
+    int layerSizes[] = {16, 8, 3};
+    int numLayers = 3;
+    MLP* mlp = newMLP(inputSize, layerSizes, numLayers);
+
+    // 4*16+16 + 16*8+8 + 8*3+3
+    int numParams = 243;
+
+    getMemStats(&during);
+    assert(during.categories[MEM_PARAMETERS].count == before.categories[MEM_PARAMETERS].count + numParams);
+    assert(during.categories[MEM_VALUES].count == before.categories[MEM_VALUES].count);
+
+    freeMLP(&mlp);
+
+    getMemStats(&after);
+    for (int i=0; i<NUM_MEM_CATEGORIES; i++){
+        assert(after.categories[i].count == before.categories[i].count);
+        assert(after.categories[i].bytes == before.categories[i].bytes);
+    }
+    assert(after.totalBytes == before.totalBytes);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_graphAccounting() checks the graph counters across a training step: they grow during Forward(), peak 
+ * during Backward() and return to their starting point after ZeroGrad()
+*/
+void test_graphAccounting(void){
+
+    printf("test_graphAccounting()...");
+
+    int inputSize = 3;
+    int layerSizes[] = {16, 8, 4, 2};
+    int numLayers = 4;
+    MLP* mlp = newMLP(inputSize, layerSizes, numLayers);
+
+    Value** input = newOutputVector(inputSize);
+
+    MemStats before, afterForward, afterBackward, after;
+    resetMemPeaks();
+    getMemStats(&before);
+
+    Value** output = Forward(mlp, input);
+    Value* sum = Add(output[0], output[1], mlp->graphStack);
+
+    getMemStats(&afterForward);
+    assert(afterForward.categories[MEM_VALUES].count > before.categories[MEM_VALUES].count);
+    assert(afterForward.categories[MEM_GRAPH_NODES].count == 
+        before.categories[MEM_GRAPH_NODES].count + mlp->graphStack->len - 1);
+
+    Backward(sum, NULL, NULL);
+
+    // the sort stack and visited hash table are released by Backward() but show up in the peaks
+    getMemStats(&afterBackward);
+    assert(afterBackward.categories[MEM_HASH_BUCKETS].count == before.categories[MEM_HASH_BUCKETS].count);
+    assert(afterBackward.categories[MEM_HASH_BUCKETS].peakCount > before.categories[MEM_HASH_BUCKETS].count);
+    assert(afterBackward.categories[MEM_GRAPH_NODES].peakCount > afterForward.categories[MEM_GRAPH_NODES].count);
+
+    ZeroGrad(mlp);
+
+    getMemStats(&after);
+    for (int i=0; i<NUM_MEM_CATEGORIES; i++){
+        assert(after.categories[i].count == before.categories[i].count);
+        assert(after.categories[i].bytes == before.categories[i].bytes);
+    }
+    assert(after.peakTotalBytes > after.totalBytes);
+
+    // peaks can be reset per step
+    resetMemPeaks();
+    getMemStats(&after);
+    assert(after.peakTotalBytes == after.totalBytes);
+
+    // cleanup
+    for (int i=0; i<inputSize; i++){
+        freeValue(&input[i]);
+    }
+    free(input);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_valueAccounting();
+    test_parameterAccounting();
+    test_graphAccounting();
+
+    return 0;
+}
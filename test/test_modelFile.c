@@ -0,0 +1,167 @@
+#include "lib.h"
+#include <unistd.h>
+
+#define TEST_MODEL_PATH "/tmp/nnc_test_model.bin"
+
+/**
+ * @test test_initModelHeader() checks the header fields and that every parameter blob is aligned
+*/
+void test_initModelHeader(void){
+
+    printf("test_initModelHeader()...");
+
+    int layerSizes[] = {5, 3};
+    ModelHeader header;
+    ModelLayerInfo layers[2];
+    initModelHeader(&header, layers, 4, layerSizes, 2);
+
+    assert(memcmp(header.magic, MODEL_MAGIC, 4) == 0);
+    assert(header.version == MODEL_VERSION);
+    assert(header.numLayers == 2 && header.inputSize == 4);
+    assert(header.dtype == MODEL_DTYPE_FLOAT64);
+    assert(header.numParams == (4 * 5 + 5) + (5 * 3 + 3));
+
+    // 64 byte header + 32 byte table -> first blob at 128, 25 doubles = 200 bytes -> second blob at 128 + 256
+    assert(header.paramsOffset == 128);
+    assert(layers[0].offset == 128 && layers[1].offset == 384);
+    assert(layers[0].outputSize == 5 && layers[1].activation == MODEL_ACTIVATION_RELU);
+
+    assert(validateModelHeader(&header, 384 + 18 * sizeof(double)) == 1);
+    assert(validateModelLayers(&header, layers, 384 + 18 * sizeof(double)) == 1);
+
+    // a file that ends inside the last blob
+    assert(validateModelLayers(&header, layers, 384 + 17 * sizeof(double)) == 0);
+
+    // a layer table that does not match the layer sizes
+    layers[1].offset += 8;
+    assert(validateModelLayers(&header, layers, 1 << 20) == 0);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_saveLoadMLP() round trips an mlp through a model file and checks that every parameter and the forward 
+ * pass are bit identical, and that loading draws nothing from rand()
+*/
+void test_saveLoadMLP(void){
+
+    printf("test_saveLoadMLP()...");
+
+    int layerSizes[] = {16, 8, 3};
+    MLP* mlp = newMLP(4, layerSizes, 3);
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+
+    srand(9);
+    int expectedRand = rand();
+    srand(9);
+
+    MLP* loaded = loadMLP(TEST_MODEL_PATH);
+    assert(loaded != NULL);
+    assert(rand() == expectedRand);
+    assert(loaded->numLayers == 3);
+    assert(loaded->inputLayer->inputSize == 4);
+
+    for (Layer *a = mlp->inputLayer, *b = loaded->inputLayer; a != NULL; a = a->next, b = b->next){
+
+        assert(b != NULL && a->inputSize == b->inputSize && a->outputSize == b->outputSize);
+
+        for (int i=0; i<a->inputSize * a->outputSize; i++){
+            assert(a->weights[i]->value == b->weights[i]->value);
+        }
+        for (int i=0; i<a->outputSize; i++){
+            assert(a->biases[i]->value == b->biases[i]->value);
+        }
+    }
+
+    float row[4] = {0.5f, -1.0f, 2.0f, 0.25f};
+    Value** expected = ForwardRow(mlp, row);
+    Value** output = ForwardRow(loaded, row);
+    for (int i=0; i<3; i++){
+        assert(expected[i]->value == output[i]->value);
+    }
+
+    ZeroGrad(mlp);
+    ZeroGrad(loaded);
+    freeMLP(&mlp);
+    freeMLP(&loaded);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_loadCorruptedMLP() checks that files with a flipped parameter bit, a bad magic, a truncated blob or sizes
+ * beyond an int or whose blob size overflows are rejected
+*/
+void test_loadCorruptedMLP(void){
+
+    printf("test_loadCorruptedMLP()...");
+
+    int layerSizes[] = {6, 2};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+
+    ModelHeader header;
+    ModelLayerInfo layers[2];
+    initModelHeader(&header, layers, 3, layerSizes, 2);
+
+    // flip a bit of the first bias of the last layer
+    FILE* file = fopen(TEST_MODEL_PATH, "rb+");
+    unsigned char byte;
+    fseeko(file, layers[1].offset + 12 * sizeof(double), SEEK_SET);
+    assert(fread(&byte, 1, 1, file) == 1);
+    byte ^= 0x10;
+    fseeko(file, layers[1].offset + 12 * sizeof(double), SEEK_SET);
+    fwrite(&byte, 1, 1, file);
+    fclose(file);
+    assert(loadMLP(TEST_MODEL_PATH) == NULL);
+
+    // bad magic
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+    file = fopen(TEST_MODEL_PATH, "rb+");
+    fwrite("XXXX", 1, 4, file);
+    fclose(file);
+    assert(loadMLP(TEST_MODEL_PATH) == NULL);
+
+    // truncated
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+    truncate(TEST_MODEL_PATH, layers[1].offset + 8);
+    assert(loadMLP(TEST_MODEL_PATH) == NULL);
+
+    // inputSize of 2^31, negative as an int
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+    file = fopen(TEST_MODEL_PATH, "rb+");
+    ModelHeader crafted = header;
+    crafted.inputSize = 1U << 31;
+    fwrite(&crafted, sizeof(ModelHeader), 1, file);
+    fclose(file);
+    assert(loadMLP(TEST_MODEL_PATH) == NULL);
+
+    // one layer of 2^30 outputs after 2^31 - 1 inputs, whose (in + 1) * out * 8 bytes wrap around to exactly 0
+    ModelHeader wideHeader;
+    ModelLayerInfo wideLayer;
+    int wideSize = 1 << 30;
+    initModelHeader(&wideHeader, &wideLayer, INT32_MAX, &wideSize, 1);
+    assert(saveMLP(mlp, TEST_MODEL_PATH) == 1);
+    file = fopen(TEST_MODEL_PATH, "rb+");
+    fwrite(&wideHeader, sizeof(ModelHeader), 1, file);
+    fwrite(&wideLayer, sizeof(ModelLayerInfo), 1, file);
+    fclose(file);
+    assert(loadMLP(TEST_MODEL_PATH) == NULL);
+    assert(openInferenceModel(TEST_MODEL_PATH) == NULL);
+
+    assert(loadMLP("/tmp/nnc_no_such_model.bin") == NULL);
+
+    remove(TEST_MODEL_PATH);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_initModelHeader();
+    test_saveLoadMLP();
+    test_loadCorruptedMLP();
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "lib.h"
+#include <sys/wait.h>
+
+#define TEST_SCORE_MODEL_PATH "/tmp/nnc_test_score_model.bin"
+#define TEST_SCORE_INPUT_PATH "/tmp/nnc_test_score_input"
+#define TEST_SCORE_OUTPUT_PATH "/tmp/nnc_test_score_output.txt"
+#define TEST_SCORE_FEATURES 5
+
+// SCORE_SLOTS * SCORE_CHUNK_ROWS of tools/nncScore.c, the rows of one trip around its ring
+#define TEST_SCORE_RING_ROWS (4 * 4096)
+
+/**
+ * @note runScore() runs bin/nnc_score on the test model and input with extra arguments, stdout to the output file
+ * @return the exit code of nnc_score
+*/
+int runScore(const char* args){
+
+    char command[512];
+    snprintf(command, sizeof(command), "./bin/nnc_score --model %s --input %s %s > %s 2> /dev/null",
+        TEST_SCORE_MODEL_PATH, TEST_SCORE_INPUT_PATH, args, TEST_SCORE_OUTPUT_PATH);
+
+    int status = system(command);
+    assert(status != -1 && WIFEXITED(status));
+
+    return WEXITSTATUS(status);
+}
+
+/**
+ * @note testRow() fills the features of row i of the test input, spanning a few orders of magnitude
+*/
+void testRow(int i, float* row){
+
+    for (int j=0; j<TEST_SCORE_FEATURES; j++){
+        row[j] = (float)(((i * 7 + j * 13) % 101) - 50) / (j + 1) + (float)(i % 17) * 0.125f;
+    }
+}
+
+/**
+ * @note checkScores() compares the output file with predictRow() of every test row
+ * @param writeProbs 1 if the output holds softmax probabilities, 0 if it holds classes
+*/
+void checkScores(InferenceModel* model, int numRows, int writeProbs){
+
+    double* scratch = malloc(sizeof(double) * (2 * model->maxWidth + model->outputSize));
+    double* probs = malloc(sizeof(double) * model->outputSize);
+    float row[TEST_SCORE_FEATURES];
+
+    FILE* output = fopen(TEST_SCORE_OUTPUT_PATH, "r");
+    assert(output != NULL);
+
+    for (int i=0; i<numRows; i++){
+
+        testRow(i, row);
+        int32_t label;
+        predictRow(model, row, scratch, &label, probs);
+
+        if (!writeProbs){
+
+            int32_t scored;
+            assert(fscanf(output, "%d", &scored) == 1);
+            assert(scored == label);
+            continue;
+        }
+
+        for (int k=0; k<model->outputSize; k++){
+
+            double scored;
+            assert(fscanf(output, k == 0 ? "%lf" : ",%lf", &scored) == 1);
+            assert(fabs(scored - probs[k]) <= 1e-5 * probs[k] + 1e-300);
+        }
+    }
+
+    // nothing after the last row
+    int extra;
+    assert(fscanf(output, "%d", &extra) == EOF);
+
+    fclose(output);
+    free(scratch);
+    free(probs);
+}
+
+/**
+ * @note writeCsvInput() writes numRows test rows as csv with a header, a label column, blanks around the separators,
+ * CRLF endings and blank lines. The row at badRow, if not -1, has a non numeric feature.
+*/
+void writeCsvInput(int numRows, int badRow){
+
+    FILE* file = fopen(TEST_SCORE_INPUT_PATH, "w");
+    fprintf(file, "a,b,c,d,e,label\n");
+
+    float row[TEST_SCORE_FEATURES];
+    for (int i=0; i<numRows; i++){
+
+        testRow(i, row);
+        if (i == badRow){
+            fprintf(file, "%.9g,%.9g,oops,%.9g,%.9g,0\n", row[0], row[1], row[3], row[4]);
+            continue;
+        }
+
+        fprintf(file, i % 3 ? "%.9g,%.9g,%.9g,%.9g,%.9g,%d\n" : "%.9g , %.9g,\t%.9g ,%.9g,%.9g,%d\r\n",
+            row[0], row[1], row[2], row[3], row[4], i % 3);
+        if (i % 1000 == 999){
+            fprintf(file, "\n");
+        }
+    }
+    fclose(file);
+}
+
+/**
+ * @note writeF32Input() writes numRows test rows as raw float32, cut extraBytes into a further row
+*/
+void writeF32Input(int numRows, int extraBytes){
+
+    FILE* file = fopen(TEST_SCORE_INPUT_PATH, "wb");
+
+    float row[TEST_SCORE_FEATURES];
+    for (int i=0; i<numRows; i++){
+        testRow(i, row);
+        fwrite(row, sizeof(float), TEST_SCORE_FEATURES, file);
+    }
+    fwrite(row, 1, extraBytes, file);
+    fclose(file);
+}
+
+/**
+ * @test test_scoreCsv() scores csv inputs that go around the ring with a short last chunk and that end exactly on a
+ * chunk boundary, and checks that every row comes out in order with the class predictRow() gives it
+*/
+void test_scoreCsv(InferenceModel* model){
+
+    printf("test_scoreCsv()...");
+
+    int sizes[] = {TEST_SCORE_RING_ROWS + 4096 + 123, TEST_SCORE_RING_ROWS + 4096, 7};
+
+    for (int i=0; i<3; i++){
+
+        writeCsvInput(sizes[i], -1);
+        assert(runScore("--threads 3") == 0);
+        checkScores(model, sizes[i], 0);
+    }
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_scoreF32() scores raw float32 input with softmax probabilities output
+*/
+void test_scoreF32(InferenceModel* model){
+
+    printf("test_scoreF32()...");
+
+    int sizes[] = {TEST_SCORE_RING_ROWS + 4096 + 123, TEST_SCORE_RING_ROWS};
+
+    for (int i=0; i<2; i++){
+
+        writeF32Input(sizes[i], 0);
+        assert(runScore("--format f32 --output probs --threads 2") == 0);
+        checkScores(model, sizes[i], 1);
+    }
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_scoreMalformed() checks that a non numeric feature or a truncated float32 row exits with 1, after the rows
+ * before it have been scored
+*/
+void test_scoreMalformed(InferenceModel* model){
+
+    printf("test_scoreMalformed()...");
+
+    writeCsvInput(TEST_SCORE_RING_ROWS, 9000);
+    assert(runScore("") == 1);
+    checkScores(model, 9000, 0);
+
+    writeF32Input(5000, 6);
+    assert(runScore("--format f32") == 1);
+    checkScores(model, 5000, 0);
+
+    // unknown options
+    assert(runScore("--format tsv") == 1);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    int layerSizes[] = {16, 4};
+    MLP* mlp = newMLPInit(TEST_SCORE_FEATURES, layerSizes, 2, INIT_HE, 21);
+    assert(saveMLP(mlp, TEST_SCORE_MODEL_PATH) == 1);
+    freeMLP(&mlp);
+
+    InferenceModel* model = openInferenceModel(TEST_SCORE_MODEL_PATH);
+    assert(model != NULL);
+
+    test_scoreCsv(model);
+    test_scoreF32(model);
+    test_scoreMalformed(model);
+
+    freeInferenceModel(&model);
+    remove(TEST_SCORE_MODEL_PATH);
+    remove(TEST_SCORE_INPUT_PATH);
+    remove(TEST_SCORE_OUTPUT_PATH);
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "lib.h"
+
+/**
+ * @test test_seedRng() checks that equal seeds give equal streams and different seeds give different streams
+*/
+void test_seedRng(void){
+
+    printf("test_seedRng()...");
+
+    Rng a, b, c;
+    seedRng(&a, 1234);
+    seedRng(&b, 1234);
+    seedRng(&c, 1235);
+
+    int sameAsC = 1;
+    for (int i=0; i<100; i++){
+
+        uint64_t x = rngNext(&a);
+        assert(x == rngNext(&b));
+
+        if (x != rngNext(&c)){
+            sameAsC = 0;
+        }
+    }
+    assert(sameAsC == 0);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_rngDistributions() checks the range of rngUniform() and the first two moments of rngNormal()
+*/
+void test_rngDistributions(void){
+
+    printf("test_rngDistributions()...");
+
+    Rng rng;
+    seedRng(&rng, 7);
+
+    int n = 100000;
+    double sum = 0, sumSq = 0;
+
+    for (int i=0; i<n; i++){
+
+        double u = rngUniform(&rng);
+        assert(u >= 0 && u < 1);
+
+        double z = rngNormal(&rng);
+        sum += z;
+        sumSq += z * z;
+    }
+
+    double mean = sum / n;
+    double variance = sumSq / n - mean * mean;
+    assert(fabs(mean) < 0.02);
+    assert(fabs(variance - 1) < 0.03);
+
+    // rngBelow() stays in range and hits every value
+    int counts[7] = {0};
+    for (int i=0; i<7000; i++){
+
+        uint64_t k = rngBelow(&rng, 7);
+        assert(k < 7);
+        counts[k]++;
+    }
+    for (int k=0; k<7; k++){
+        assert(counts[k] > 800 && counts[k] < 1200);
+    }
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_seedRng();
+    test_rngDistributions();
+
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include "lib.h"
+#include <sched.h>
+
+#define TEST_SERVING_READERS 4
+#define TEST_SERVING_VERSIONS 300
+#define TEST_SERVING_CYCLES 200
+
+/**
+ * @note setVersionWeights() sets every parameter of an mlp to a value derived from a version, so the version a 
+ * snapshot was published as can be read back from any of its parameters
+*/
+void setVersionWeights(MLP* mlp, uint64_t version){
+
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+
+        for (int i=0; i<layer->inputSize * layer->outputSize; i++){
+            layer->weights[i]->value = version * 0.001;
+        }
+        for (int i=0; i<layer->outputSize; i++){
+            layer->biases[i]->value = version * 0.001;
+        }
+    }
+}
+
+/**
+ * @test test_publishReclaim() checks that a snapshot held by a reader survives later publishes and is reclaimed once 
+ * released
+*/
+void test_publishReclaim(void){
+
+    printf("test_publishReclaim()...");
+
+    int layerSizes[] = {4, 2};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+    setVersionWeights(mlp, 1);
+
+    ServingModel* serving = newServingModel(mlp);
+    int reader = registerServingReader(serving);
+    int idle = registerServingReader(serving);
+    assert(reader == 0 && idle == 1);
+
+    ModelSnapshot* held = acquireSnapshot(serving, reader);
+    assert(held->version == 1 && held->model->layers[0].weights[0] == 0.001);
+
+    // the reader keeps version 1 while two newer versions are published
+    setVersionWeights(mlp, 2);
+    assert(publishModel(serving, mlp) == 2);
+    setVersionWeights(mlp, 3);
+    assert(publishModel(serving, mlp) == 3);
+    assert(serving->numRetired == 2);
+    assert(held->model->layers[1].biases[1] == 0.001);
+
+    // an idle reader acquires the newest version
+    ModelSnapshot* latest = acquireSnapshot(serving, idle);
+    assert(latest->version == 3 && latest->model->layers[0].weights[0] == 0.003);
+    releaseSnapshot(serving, idle);
+
+    releaseSnapshot(serving, reader);
+    assert(reclaimSnapshots(serving) == 0);
+
+    freeServingModel(&serving);
+    assert(serving == NULL);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @note ServingReader is one reader thread of test_concurrentPublish()
+*/
+typedef struct {
+    ServingModel* serving;
+    _Atomic int* done;
+    _Atomic int* started;
+    uint64_t numAcquired;
+} ServingReader;
+
+/**
+ * @note servingReaderThread() acquires snapshots in a loop until publishing is done, checking that every parameter 
+ * and the forward pass of each snapshot belong to its version and that versions never go backwards
+*/
+void* servingReaderThread(void* arg){
+
+    ServingReader* reader = (ServingReader*)arg;
+    int slot = registerServingReader(reader->serving);
+
+    float row[3] = {1, 1, 1};
+    double scratch[2 * 8], output[2];
+    uint64_t lastVersion = 0;
+
+    while (!atomic_load(reader->done)){
+
+        ModelSnapshot* snapshot = acquireSnapshot(reader->serving, slot);
+        InferenceModel* model = snapshot->model;
+
+        assert(snapshot->version >= lastVersion);
+        lastVersion = snapshot->version;
+
+        double value = snapshot->version * 0.001;
+        for (int l=0; l<model->numLayers; l++){
+            for (int i=0; i<model->layers[l].inputSize * model->layers[l].outputSize; i++){
+                assert(model->layers[l].weights[i] == value);
+            }
+        }
+
+        // 3 inputs of 1 -> 8 hidden of 3v + v -> 2 outputs of 8 * 4v * v + v
+        forwardInference(model, row, scratch, output);
+        assert(fabs(output[0] - (32 * value * value + value)) < 1e-12);
+
+        releaseSnapshot(reader->serving, slot);
+        if (reader->numAcquired++ == 0){
+            atomic_fetch_add(reader->started, 1);
+        }
+    }
+
+    unregisterServingReader(reader->serving, slot);
+
+    return NULL;
+}
+
+/**
+ * @test test_concurrentPublish() publishes versions while reader threads run inference on whatever is current, and 
+ * checks that no reader ever sees a freed or partially published snapshot and that everything is reclaimed
+*/
+void test_concurrentPublish(void){
+
+    printf("test_concurrentPublish()...");
+
+    int layerSizes[] = {8, 2};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+    setVersionWeights(mlp, 1);
+
+    ServingModel* serving = newServingModel(mlp);
+    _Atomic int done = 0, started = 0;
+
+    pthread_t threads[TEST_SERVING_READERS];
+    ServingReader readers[TEST_SERVING_READERS];
+
+    for (int i=0; i<TEST_SERVING_READERS; i++){
+
+        readers[i] = (ServingReader){serving, &done, &started, 0};
+        assert(pthread_create(&threads[i], NULL, servingReaderThread, &readers[i]) == 0);
+    }
+
+    // publish once every reader is running
+    while (atomic_load(&started) < TEST_SERVING_READERS){
+        sched_yield();
+    }
+
+    for (uint64_t version=2; version<=TEST_SERVING_VERSIONS; version++){
+
+        setVersionWeights(mlp, version);
+        assert(publishModel(serving, mlp) == version);
+    }
+
+    atomic_store(&done, 1);
+    for (int i=0; i<TEST_SERVING_READERS; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(reclaimSnapshots(serving) == 0);
+    assert(atomic_load(&serving->current)->version == TEST_SERVING_VERSIONS);
+    assert(atomic_load(&serving->numReaders) == 0);
+
+    freeServingModel(&serving);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @note churnReaderThread() registers, acquires one snapshot and unregisters TEST_SERVING_CYCLES times, so a reader 
+ * thread that comes and goes holds a slot only while it runs
+*/
+void* churnReaderThread(void* arg){
+
+    ServingModel* serving = (ServingModel*)arg;
+    uint64_t lastVersion = 0;
+
+    for (int i=0; i<TEST_SERVING_CYCLES; i++){
+
+        int slot = registerServingReader(serving);
+        assert(slot >= 0 && slot < SERVING_MAX_READERS);
+
+        ModelSnapshot* snapshot = acquireSnapshot(serving, slot);
+        assert(snapshot->version >= lastVersion);
+        assert(snapshot->model->layers[0].weights[0] == snapshot->version * 0.001);
+        lastVersion = snapshot->version;
+        releaseSnapshot(serving, slot);
+
+        unregisterServingReader(serving, slot);
+    }
+
+    return NULL;
+}
+
+/**
+ * @test test_reuseReaderSlots() checks that unregistered slots are handed out again, so more than 
+ * SERVING_MAX_READERS readers can register over the life of a ServingModel, also while snapshots are being published
+*/
+void test_reuseReaderSlots(void){
+
+    printf("test_reuseReaderSlots()...");
+
+    int layerSizes[] = {4, 2};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+    setVersionWeights(mlp, 1);
+
+    ServingModel* serving = newServingModel(mlp);
+
+    // every slot registered at once
+    int readers[SERVING_MAX_READERS];
+    for (int i=0; i<SERVING_MAX_READERS; i++){
+        readers[i] = registerServingReader(serving);
+        assert(readers[i] == i);
+    }
+    assert(atomic_load(&serving->numReaders) == SERVING_MAX_READERS);
+
+    // freed slots are reused, lowest first
+    unregisterServingReader(serving, readers[40]);
+    unregisterServingReader(serving, readers[7]);
+    assert(registerServingReader(serving) == 7);
+    assert(registerServingReader(serving) == 40);
+
+    // a reader holding a snapshot in a reused slot still keeps it from being reclaimed
+    ModelSnapshot* held = acquireSnapshot(serving, 40);
+    assert(held->version == 1);
+    setVersionWeights(mlp, 2);
+    publishModel(serving, mlp);
+    assert(serving->numRetired == 1);
+    releaseSnapshot(serving, 40);
+    assert(reclaimSnapshots(serving) == 0);
+
+    for (int i=0; i<SERVING_MAX_READERS; i++){
+        unregisterServingReader(serving, readers[i]);
+    }
+    assert(atomic_load(&serving->numReaders) == 0);
+
+    // TEST_SERVING_READERS * TEST_SERVING_CYCLES registrations, far more than there are slots, during publishes
+    pthread_t threads[TEST_SERVING_READERS];
+    for (int i=0; i<TEST_SERVING_READERS; i++){
+        assert(pthread_create(&threads[i], NULL, churnReaderThread, serving) == 0);
+    }
+    for (uint64_t version=3; version<=TEST_SERVING_VERSIONS; version++){
+
+        setVersionWeights(mlp, version);
+        assert(publishModel(serving, mlp) == version);
+    }
+    for (int i=0; i<TEST_SERVING_READERS; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(atomic_load(&serving->numReaders) == 0);
+    assert(reclaimSnapshots(serving) == 0);
+
+    freeServingModel(&serving);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_publishReclaim();
+    test_concurrentPublish();
+    test_reuseReaderSlots();
+
+    return 0;
+}
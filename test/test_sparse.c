@@ -0,0 +1,131 @@
+#include "lib.h"
+
+/**
+ * @test test_denseToSparse() checks the CSR layout of a small dense batch
+*/
+void test_denseToSparse(void){
+
+    printf("test_denseToSparse()...");
+
+    float features[3 * 4] = {
+        0, 1.5f, 0, 0,
+        0, 0, 0, 0,
+        2, 0, 0, -3
+    };
+
+    // capacity 1 forces growth
+    SparseBatch* batch = newSparseBatch(3, 4, 1);
+    denseToSparse(batch, features, 3);
+
+    assert(batch->numRows == 3);
+    assert(batch->nnz == 3);
+    assert(batch->rowPtr[0] == 0 && batch->rowPtr[1] == 1 && batch->rowPtr[2] == 1 && batch->rowPtr[3] == 3);
+    assert(batch->colIdx[0] == 1 && batch->values[0] == 1.5f);
+    assert(batch->colIdx[1] == 0 && batch->values[1] == 2.0f);
+    assert(batch->colIdx[2] == 3 && batch->values[2] == -3.0f);
+    assert(rowNonzeros(batch, 0) == 1 && rowNonzeros(batch, 1) == 0 && rowNonzeros(batch, 2) == 2);
+
+    freeSparseBatch(&batch);
+    assert(batch == NULL);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_ForwardSparseRow() checks that the sparse first layer gives the same outputs and gradients as the dense 
+ * forward pass, and that the sparse update and zeroing match Step() and ZeroGrad(), moving the weights of nonzero 
+ * features only
+*/
+void test_ForwardSparseRow(void){
+
+    printf("test_ForwardSparseRow()...");
+
+    int inputSize = 50, numClasses = 3;
+    int layerSizes[] = {8, 4, numClasses};
+
+    // two mlps with identical parameters
+    srand(3);
+    MLP* dense = newMLP(inputSize, layerSizes, 3);
+    srand(3);
+    MLP* sparse = newMLP(inputSize, layerSizes, 3);
+
+    // a row with 3 nonzeros out of 50
+    float row[50] = {0};
+    row[4] = 0.5f, row[17] = -1.25f, row[49] = 2.0f;
+
+    SparseBatch* batch = newSparseBatch(1, inputSize, 4);
+    denseToSparse(batch, row, 1);
+
+    Value** denseOutput = ForwardRow(dense, row);
+    Value** sparseOutput = ForwardSparseRow(sparse, batch, 0);
+
+    for (int i=0; i<numClasses; i++){
+        assert(fabs(denseOutput[i]->value - sparseOutput[i]->value) < 1e-12);
+    }
+
+    // backpropagate the same loss through both
+    int label = 1;
+    double* softmax = Softmax(denseOutput, numClasses);
+    BackwardSparse(sparseCategoricalCrossEntropy(denseOutput, label, softmax, numClasses, dense->graphStack), softmax, label);
+    softmax = Softmax(sparseOutput, numClasses);
+    BackwardSparse(sparseCategoricalCrossEntropy(sparseOutput, label, softmax, numClasses, sparse->graphStack), softmax, label);
+
+    // identical gradients, the sparse path never touched the zero columns
+    for (int i=0; i<inputSize * layerSizes[0]; i++){
+
+        assert(fabs(dense->inputLayer->weights[i]->grad - sparse->inputLayer->weights[i]->grad) < 1e-12);
+        if (row[i % inputSize] == 0){
+            assert(sparse->inputLayer->weights[i]->grad == 0);
+        }
+    }
+
+    // a weight of an active neuron on a nonzero feature, and one on a zero feature
+    Value** weights = sparse->inputLayer->weights;
+    int touchedIndex = -1;
+    for (int i=0; i<layerSizes[0] && touchedIndex < 0; i++){
+        if (weights[i * inputSize + 4]->grad != 0){
+            touchedIndex = i * inputSize + 4;
+        }
+    }
+    assert(touchedIndex >= 0);
+    double touched = weights[touchedIndex]->value;
+    double untouched = weights[touchedIndex - 4]->value;
+
+    // the sparse update and zeroing leave both mlps in the same state
+    Step(dense, 0.1);
+    StepSparse(sparse, 0.1, batch->colIdx, rowNonzeros(batch, 0));
+
+    for (Layer* d = dense->inputLayer, *s = sparse->inputLayer; d != NULL; d = d->next, s = s->next){
+        for (int i=0; i<d->inputSize * d->outputSize; i++){
+            assert(d->weights[i]->grad == s->weights[i]->grad && d->weights[i]->value == s->weights[i]->value);
+        }
+    }
+
+    assert(weights[touchedIndex]->value == touched - 0.1 * weights[touchedIndex]->grad);
+    assert(weights[touchedIndex]->value != touched);
+    assert(weights[touchedIndex - 4]->value == untouched);
+
+    ZeroGrad(dense);
+    ZeroGradSparse(sparse, batch->colIdx, rowNonzeros(batch, 0));
+
+    assert(sparse->graphStack->len == 1);
+    for (Layer* s = sparse->inputLayer; s != NULL; s = s->next){
+        for (int i=0; i<s->inputSize * s->outputSize; i++){
+            assert(s->weights[i]->grad == 0);
+        }
+    }
+
+    freeSparseBatch(&batch);
+    freeMLP(&dense);
+    freeMLP(&sparse);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_denseToSparse();
+    test_ForwardSparseRow();
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "lib.h"
+#include <unistd.h>
+
+#define TEST_TRAIN_CHECKPOINT_PATH "/tmp/nnc_test_train_checkpoint.bin"
+#define TEST_TRAIN_MAX_STEPS 1024
+
+/**
+ * @note newCheckpointDataset() creates a small 3 feature, 3 class dataset with deterministic features
+*/
+DenseDataset* newCheckpointDataset(uint64_t numRows){
+
+    DenseDataset* dataset = newDenseDataset(numRows, 3, 3);
+
+    for (uint64_t row=0; row<numRows; row++){
+        dataset->features[row * 3] = (float)row / numRows;
+        dataset->features[row * 3 + 1] = (float)(row % 7) - 3.0f;
+        dataset->features[row * 3 + 2] = row % 2 ? 0.5f : -0.5f;
+        dataset->labels[row] = row % 3;
+    }
+
+    return dataset;
+}
+
+/**
+ * @note copyParams() copies the value of every weight and bias of an mlp, layer by layer
+ * @return number of parameters copied
+*/
+int copyParams(MLP* mlp, double* params){
+
+    int numParams = 0;
+
+    for (Layer* layer = mlp->inputLayer; layer != NULL; layer = layer->next){
+
+        for (int i=0; i<layer->inputSize * layer->outputSize; i++){
+            params[numParams++] = layer->weights[i]->value;
+        }
+        for (int i=0; i<layer->outputSize; i++){
+            params[numParams++] = layer->biases[i]->value;
+        }
+    }
+
+    return numParams;
+}
+
+/**
+ * @note trainSteps() runs the training loop from the loader's position to the end, recording the loss and label of 
+ * every step. When checkpointStep is reached, a checkpoint is handed to the writer after that step's batch and the 
+ * parameters it holds are copied to checkpointParams.
+ * @return number of steps taken
+*/
+int trainSteps(MLP* mlp, DataLoader* loader, TrainState* state, int numEpochs, double* losses, int32_t* labels, 
+    CheckpointWriter* writer, uint64_t checkpointStep, double* checkpointParams){
+
+    int numSteps = 0;
+
+    for (int epoch=getLoaderPosition(loader).epoch; epoch<numEpochs; epoch++){
+
+        Batch* batch;
+        while ((batch = nextBatch(loader)) != NULL){
+
+            for (int example=0; example<batch->numRows; example++){
+
+                int32_t label = batch->labels[example];
+                Value** output = ForwardRow(mlp, batch->features + example * 3);
+                double* softmax = Softmax(output, 3);
+                Value* loss = sparseCategoricalCrossEntropy(output, label, softmax, 3, mlp->graphStack);
+
+                assert(numSteps < TEST_TRAIN_MAX_STEPS);
+                losses[numSteps] = loss->value;
+                labels[numSteps++] = label;
+
+                BackwardSparse(loss, softmax, label);
+                Step(mlp, state->lr);
+                ZeroGrad(mlp);
+                state->step++;
+            }
+
+            releaseBatch(loader);
+
+            if (writer != NULL && state->step == checkpointStep){
+                state->position = getLoaderPosition(loader);
+                saveTrainCheckpointAsync(writer, mlp, state, TEST_TRAIN_CHECKPOINT_PATH);
+                copyParams(mlp, checkpointParams);
+            }
+        }
+    }
+
+    return numSteps;
+}
+
+/**
+ * @test test_saveLoadTrainCheckpoint() round trips the training state and parameters through a checkpoint file and 
+ * checks that truncated files are rejected
+*/
+void test_saveLoadTrainCheckpoint(void){
+
+    printf("test_saveLoadTrainCheckpoint()...");
+
+    int layerSizes[] = {6, 3};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+
+    TrainState state = {.step = 1234, .lr = 0.05, .optimizer = TRAIN_OPTIMIZER_SGD, .loaderSeed = 99};
+    state.position = (LoaderPosition){2, 17};
+    assert(saveTrainCheckpoint(mlp, &state, TEST_TRAIN_CHECKPOINT_PATH) == 1);
+
+    // the temporary file has been renamed over the target
+    assert(access(TEST_TRAIN_CHECKPOINT_PATH ".tmp", F_OK) != 0);
+
+    TrainState loadedState;
+    MLP* loaded = loadTrainCheckpoint(TEST_TRAIN_CHECKPOINT_PATH, &loadedState);
+    assert(loaded != NULL);
+    assert(loadedState.step == 1234 && loadedState.lr == 0.05 && loadedState.optimizer == TRAIN_OPTIMIZER_SGD);
+    assert(loadedState.loaderSeed == 99);
+    assert(loadedState.position.epoch == 2 && loadedState.position.batch == 17);
+
+    for (Layer *a = mlp->inputLayer, *b = loaded->inputLayer; a != NULL; a = a->next, b = b->next){
+
+        assert(b != NULL && a->inputSize == b->inputSize && a->outputSize == b->outputSize);
+
+        for (int i=0; i<a->inputSize * a->outputSize; i++){
+            assert(a->weights[i]->value == b->weights[i]->value);
+        }
+        for (int i=0; i<a->outputSize; i++){
+            assert(a->biases[i]->value == b->biases[i]->value);
+        }
+    }
+    freeMLP(&loaded);
+
+    // cut off inside the parameters
+    FILE* file = fopen(TEST_TRAIN_CHECKPOINT_PATH, "rb+");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    assert(truncate(TEST_TRAIN_CHECKPOINT_PATH, size - 8) == 0);
+    assert(loadTrainCheckpoint(TEST_TRAIN_CHECKPOINT_PATH, &loadedState) == NULL);
+
+    remove(TEST_TRAIN_CHECKPOINT_PATH);
+    freeMLP(&mlp);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_resumeTraining() checkpoints a run mid epoch from the background writer, resumes a second run from the 
+ * checkpoint and checks that it holds the parameters the first run had trained to at that step and takes exactly the 
+ * steps the first run took from there, with bit identical losses
+*/
+void test_resumeTraining(void){
+
+    printf("test_resumeTraining()...");
+
+    int numRows = 100, numEpochs = 3, batchSize = 8;
+    uint64_t seed = 5, checkpointStep = 5 * batchSize;
+    DenseDataset* dataset = newCheckpointDataset(numRows);
+
+    double* losses = malloc(sizeof(double) * TEST_TRAIN_MAX_STEPS);
+    double* resumedLosses = malloc(sizeof(double) * TEST_TRAIN_MAX_STEPS);
+    int32_t* labels = malloc(sizeof(int32_t) * TEST_TRAIN_MAX_STEPS);
+    int32_t* resumedLabels = malloc(sizeof(int32_t) * TEST_TRAIN_MAX_STEPS);
+
+    // the original run, checkpointed after its 5th batch while training goes on
+    int layerSizes[] = {8, 3};
+    MLP* mlp = newMLP(3, layerSizes, 2);
+    DataLoader* loader = newDataLoader(dataset, batchSize, numEpochs, LOADER_SHUFFLE, seed);
+    CheckpointWriter* writer = newCheckpointWriter();
+
+    double initialParams[59], checkpointParams[59], loadedParams[59];
+    assert(copyParams(mlp, initialParams) == 59);
+
+    TrainState state = {.step = 0, .lr = 0.01, .optimizer = TRAIN_OPTIMIZER_SGD, .loaderSeed = seed};
+    int numSteps = trainSteps(mlp, loader, &state, numEpochs, losses, labels, writer, checkpointStep, checkpointParams);
+    assert(numSteps == numRows * numEpochs);
+
+    assert(waitCheckpointWriter(writer) == 1);
+    assert(writer->numWritten == 1);
+    freeCheckpointWriter(&writer);
+    assert(writer == NULL);
+    freeDataLoader(&loader);
+    freeMLP(&mlp);
+
+    // the resumed run
+    TrainState resumedState;
+    MLP* resumed = loadTrainCheckpoint(TEST_TRAIN_CHECKPOINT_PATH, &resumedState);
+    assert(resumed != NULL);
+    assert(resumedState.step == checkpointStep);
+    assert(resumedState.position.epoch == 0 && resumedState.position.batch == 5);
+
+    // the checkpoint holds the trained parameters of that step, not the initial ones
+    assert(copyParams(resumed, loadedParams) == 59);
+    assert(memcmp(loadedParams, checkpointParams, sizeof(loadedParams)) == 0);
+    assert(memcmp(loadedParams, initialParams, sizeof(loadedParams)) != 0);
+
+    loader = newDataLoaderAt(dataset, batchSize, numEpochs, LOADER_SHUFFLE, resumedState.loaderSeed, resumedState.position);
+    int resumedSteps = trainSteps(resumed, loader, &resumedState, numEpochs, resumedLosses, resumedLabels, NULL, 0, NULL);
+
+    assert(resumedSteps == numSteps - (int)checkpointStep);
+    assert(resumedState.step == state.step);
+    assert(memcmp(resumedLabels, labels + checkpointStep, sizeof(int32_t) * resumedSteps) == 0);
+    assert(memcmp(resumedLosses, losses + checkpointStep, sizeof(double) * resumedSteps) == 0);
+
+    remove(TEST_TRAIN_CHECKPOINT_PATH);
+    freeDataLoader(&loader);
+    freeMLP(&resumed);
+    freeDenseDataset(&dataset);
+    free(losses);
+    free(resumedLosses);
+    free(labels);
+    free(resumedLabels);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_saveLoadTrainCheckpoint();
+    test_resumeTraining();
+
+    return 0;
+}
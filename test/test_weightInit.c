@@ -0,0 +1,154 @@
+#include "lib.h"
+
+#define TEST_INIT_VALUES (37 * INIT_BLOCK_VALUES + 123)
+
+/**
+ * @test test_initThreadCount() checks that every scheme fills an array identically on 1, 3, 8 and every core, including
+ * a short last block of odd length
+*/
+void test_initThreadCount(void){
+
+    printf("test_initThreadCount()...");
+
+    double* expected = (double*)malloc(sizeof(double) * TEST_INIT_VALUES);
+    double* values = (double*)malloc(sizeof(double) * TEST_INIT_VALUES);
+    assert(expected != NULL && values != NULL);
+
+    int schemes[] = {INIT_UNIFORM, INIT_XAVIER, INIT_HE};
+    int threads[] = {3, 8, INIT_AUTO_THREADS};
+
+    for (int s=0; s<3; s++){
+
+        initWeights(expected, TEST_INIT_VALUES, schemes[s], 300, 200, 42, 5, 1);
+
+        for (int t=0; t<3; t++){
+
+            memset(values, 0, sizeof(double) * TEST_INIT_VALUES);
+            initWeights(values, TEST_INIT_VALUES, schemes[s], 300, 200, 42, 5, threads[t]);
+            assert(memcmp(values, expected, sizeof(double) * TEST_INIT_VALUES) == 0);
+        }
+
+        // another stream of the same seed differs
+        initWeights(values, TEST_INIT_VALUES, schemes[s], 300, 200, 42, 6, 1);
+        assert(memcmp(values, expected, sizeof(double) * TEST_INIT_VALUES) != 0);
+    }
+
+    free(expected);
+    free(values);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_initDistributions() checks the range of the uniform schemes and the first two moments of every scheme
+*/
+void test_initDistributions(void){
+
+    printf("test_initDistributions()...");
+
+    double* values = (double*)malloc(sizeof(double) * TEST_INIT_VALUES);
+    assert(values != NULL);
+
+    int fanIn = 300, fanOut = 200;
+    int schemes[] = {INIT_UNIFORM, INIT_XAVIER, INIT_HE};
+
+    for (int s=0; s<3; s++){
+
+        initWeights(values, TEST_INIT_VALUES, schemes[s], fanIn, fanOut, 7, 0, INIT_AUTO_THREADS);
+
+        double scale = initScale(schemes[s], fanIn, fanOut);
+        double sum = 0, sumSq = 0;
+
+        for (int i=0; i<TEST_INIT_VALUES; i++){
+
+            if (schemes[s] != INIT_HE){
+                assert(values[i] >= -scale && values[i] < scale);
+            }
+            sum += values[i];
+            sumSq += values[i] * values[i];
+        }
+
+        // uniform in [-a, a) has variance a^2 / 3, He normal has variance scale^2
+        double mean = sum / TEST_INIT_VALUES;
+        double variance = sumSq / TEST_INIT_VALUES - mean * mean;
+        double expectedVariance = schemes[s] == INIT_HE ? scale * scale : scale * scale / 3;
+
+        assert(fabs(mean) < 0.01 * scale);
+        assert(fabs(variance / expectedVariance - 1) < 0.02);
+    }
+
+    assert(fabs(initScale(INIT_XAVIER, fanIn, fanOut) - sqrt(6.0 / 500)) < 1e-15);
+    assert(fabs(initScale(INIT_HE, fanIn, fanOut) - sqrt(2.0 / 300)) < 1e-15);
+
+    free(values);
+
+    printf("PASS!\n");
+}
+
+/**
+ * @test test_newMLPInit() checks that newMLPInit() is reproducible from its seed, zeroes the biases of He init and that
+ * newMLP() is still reproducible through srand()
+*/
+void test_newMLPInit(void){
+
+    printf("test_newMLPInit()...");
+
+    int layerSizes[] = {64, 32, 3};
+
+    MLP* a = newMLPInit(100, layerSizes, 3, INIT_HE, 11);
+    MLP* b = newMLPInit(100, layerSizes, 3, INIT_HE, 11);
+    MLP* c = newMLPInit(100, layerSizes, 3, INIT_HE, 12);
+
+    int sameAsC = 1;
+    for (Layer* la = a->inputLayer, *lb = b->inputLayer, *lc = c->inputLayer; la != NULL; la = la->next, lb = lb->next, lc = lc->next){
+
+        for (int i=0; i<la->inputSize * la->outputSize; i++){
+
+            assert(la->weights[i]->value == lb->weights[i]->value);
+            if (la->weights[i]->value != lc->weights[i]->value){
+                sameAsC = 0;
+            }
+        }
+        for (int i=0; i<la->outputSize; i++){
+            assert(la->biases[i]->value == 0);
+        }
+    }
+    assert(sameAsC == 0);
+
+    // the layers of one model draw from different streams
+    assert(a->inputLayer->weights[0]->value != a->inputLayer->next->weights[0]->value);
+
+    freeMLP(&a);
+    freeMLP(&b);
+    freeMLP(&c);
+
+    srand(3);
+    MLP* d = newMLP(100, layerSizes, 3);
+    srand(3);
+    MLP* e = newMLP(100, layerSizes, 3);
+
+    for (Layer* ld = d->inputLayer, *le = e->inputLayer; ld != NULL; ld = ld->next, le = le->next){
+
+        for (int i=0; i<ld->inputSize * ld->outputSize; i++){
+            assert(ld->weights[i]->value == le->weights[i]->value);
+            assert(ld->weights[i]->value >= -1 && ld->weights[i]->value < 1);
+        }
+        for (int i=0; i<ld->outputSize; i++){
+            assert(ld->biases[i]->value == le->biases[i]->value);
+        }
+    }
+
+    freeMLP(&d);
+    freeMLP(&e);
+
+    printf("PASS!\n");
+}
+
+int main(void){
+
+    test_initThreadCount();
+    test_initDistributions();
+    test_newMLPInit();
+
+    return 0;
+}
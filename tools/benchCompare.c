@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+// benchCompare.c
+
+/**
+ * @note benchCompare diffs two result files written by bench_nnc --json/--csv and flags every benchmark whose median 
+ * time per operation got slower than the baseline by more than a threshold, and every baseline benchmark missing from
+ * the current results, ie: renamed or deleted
+ * @dev usage: bench_compare baseline current [--threshold percent] [--allow-missing]
+ * @dev exits with 1 if any benchmark regressed or is missing (unless --allow-missing), so it can gate upgrades in 
+ * scripts, and with 2 on bad arguments or input files, including files of more than MAX_RESULTS results
+*/
+
+#define MAX_RESULTS 256
+#define MAX_NAME_LEN 96
+
+/**
+ * @note MedianResult is the name and median ns/op of a single benchmark
+*/
+typedef struct {
+    char name[MAX_NAME_LEN];
+    double median;
+} MedianResult;
+
+/**
+ * @note parseJsonLine() extracts the name and median from a result line of the JSON format, one object per line
+ * @return 1 if the line held a result
+*/
+int parseJsonLine(char* line, MedianResult* result){
+
+    char* name = strstr(line, "\"name\": \"");
+    char* median = strstr(line, "\"median_ns\": ");
+    if (name == NULL || median == NULL){
+        return 0;
+    }
+
+    name += strlen("\"name\": \"");
+    int len = (int)strcspn(name, "\"");
+    if (len >= MAX_NAME_LEN){
+        len = MAX_NAME_LEN - 1;
+    }
+    memcpy(result->name, name, len);
+    result->name[len] = '\0';
+
+    result->median = atof(median + strlen("\"median_ns\": "));
+    return 1;
+}
+
+/**
+ * @note parseCsvLine() extracts the name and median from a row of the CSV format, skipping metadata and the header
+ * @return 1 if the line held a result
+*/
+int parseCsvLine(char* line, MedianResult* result){
+
+    if (line[0] == '#' || strncmp(line, "name,", 5) == 0 || line[0] == '\n'){
+        return 0;
+    }
+
+    // name,reps,ops_per_rep,median_ns,...
+    char* field = strtok(line, ",");
+    if (field == NULL){
+        return 0;
+    }
+    snprintf(result->name, MAX_NAME_LEN, "%s", field);
+
+    for (int column=1; column<=3; column++){
+        field = strtok(NULL, ",");
+        if (field == NULL){
+            return 0;
+        }
+    }
+
+    result->median = atof(field);
+    return 1;
+}
+
+/**
+ * @note loadResults() reads a JSON or CSV result file, the format is detected from its first character
+ * @dev exits with 2 if the file holds more than MAX_RESULTS results, rather than comparing a truncated list
+ * @return number of results read
+*/
+int loadResults(const char* path, MedianResult* results){
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL){
+        printf("Error: could not open %s\n", path);
+        exit(2);
+    }
+
+    int isJson = (fgetc(file) == '{');
+    rewind(file);
+
+    int numResults = 0;
+    char line[512];
+    MedianResult extra;
+
+    while (fgets(line, sizeof(line), file) != NULL){
+
+        MedianResult* result = numResults < MAX_RESULTS ? &results[numResults] : &extra;
+        int parsed = isJson ? parseJsonLine(line, result) : parseCsvLine(line, result);
+
+        if (parsed && numResults == MAX_RESULTS){
+            printf("Error: %s holds more than %d results\n", path, MAX_RESULTS);
+            exit(2);
+        }
+        numResults += parsed;
+    }
+
+    fclose(file);
+    return numResults;
+}
+
+int main(int argc, char** argv){
+
+    double threshold = 10.0;
+    int allowMissing = 0;
+    int validArgs = argc >= 3;
+
+    for (int i=3; i<argc && validArgs; i++){
+
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc){
+            threshold = atof(argv[++i]);
+        }else if (strcmp(argv[i], "--allow-missing") == 0){
+            allowMissing = 1;
+        }else{
+            validArgs = 0;
+        }
+    }
+
+    if (!validArgs){
+        printf("usage: %s baseline current [--threshold percent] [--allow-missing]\n", argv[0]);
+        return 2;
+    }
+
+    MedianResult* baseline = malloc(sizeof(MedianResult) * MAX_RESULTS);
+    MedianResult* current = malloc(sizeof(MedianResult) * MAX_RESULTS);
+    assert(baseline != NULL && current != NULL);
+
+    int numBaseline = loadResults(argv[1], baseline);
+    int numCurrent = loadResults(argv[2], current);
+
+    printf("%-44s %14s %14s %9s\n", "benchmark", "baseline ns/op", "current ns/op", "change");
+
+    int numRegressions = 0;
+
+    for (int i=0; i<numCurrent; i++){
+
+        // find the matching baseline result
+        MedianResult* base = NULL;
+        for (int j=0; j<numBaseline; j++){
+            if (strcmp(baseline[j].name, current[i].name) == 0){
+                base = &baseline[j];
+                break;
+            }
+        }
+
+        if (base == NULL){
+            printf("%-44s %14s %14.1lf %9s\n", current[i].name, "-", current[i].median, "new");
+            continue;
+        }
+
+        double change = base->median > 0 ? 100.0 * (current[i].median - base->median) / base->median : 0;
+        int regressed = change > threshold;
+        numRegressions += regressed;
+
+        printf("%-44s %14.1lf %14.1lf %+8.1lf%%%s\n", 
+            current[i].name, base->median, current[i].median, change, regressed ? "  REGRESSION" : "");
+    }
+
+    // baseline results with no current result, ie: a renamed or deleted benchmark
+    int numMissing = 0;
+
+    for (int j=0; j<numBaseline; j++){
+
+        int found = 0;
+        for (int i=0; i<numCurrent && !found; i++){
+            found = strcmp(baseline[j].name, current[i].name) == 0;
+        }
+
+        if (!found){
+            printf("%-44s %14.1lf %14s %9s\n", baseline[j].name, baseline[j].median, "-", "missing");
+            numMissing++;
+        }
+    }
+
+    printf("\n%d regression(s) beyond %.1lf%%, %d missing%s\n", numRegressions, threshold, numMissing, 
+        numMissing > 0 && allowMissing ? " (allowed)" : "");
+
+    free(baseline);
+    free(current);
+
+    return numRegressions > 0 || (numMissing > 0 && !allowMissing) ? 1 : 0;
+}
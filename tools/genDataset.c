@@ -0,0 +1,238 @@
+#include "lib.h"
+
+// genDataset.c
+
+/**
+ * @note genDataset writes a synthetic classification dataset for scaling tests and benchmarks. Each class gets a 
+ * random center drawn from N(0, separability^2) per feature, and each row is its class center plus N(0, 1) noise. 
+ * A fraction of features (sparsity) is then set to exactly zero. The same seed always produces the same file.
+ * @dev usage: gen_dataset --rows N --features F --classes C [--separability S] [--sparsity P] [--seed X] 
+ *             [--bin path] [--csv path] [--quantize u8|i16]
+ * @dev rows are generated and written in chunks, so memory use does not depend on --rows (up to 10^8 and beyond)
+ * @dev --quantize stores the binary features as uint8 or int16 with per column scales and offsets computed from the
+ * range of every row, and reports the reconstruction error over the whole file. The range comes from a first pass that
+ * generates the rows from a copy of the rng, so quantizing costs twice the generation time but no extra memory.
+*/
+
+#define GEN_CHUNK_ROWS 4096
+
+/**
+ * @note GenConfig holds the command line options of genDataset
+*/
+typedef struct {
+    long long numRows;
+    int numFeatures;
+    int numClasses;
+    double separability;
+    double sparsity;
+    uint64_t seed;
+    const char* binPath;
+    const char* csvPath;
+    int dtype;
+} GenConfig;
+
+/**
+ * @note generateChunk() fills a chunk of rows and labels
+*/
+void generateChunk(GenConfig* config, Rng* rng, double* centers, float* features, int32_t* labels, int numRows){
+
+    for (int row=0; row<numRows; row++){
+
+        int label = (int)(rngUniform(rng) * config->numClasses);
+        labels[row] = label;
+
+        for (int j=0; j<config->numFeatures; j++){
+
+            double x = centers[label * config->numFeatures + j] + rngNormal(rng);
+
+            if (config->sparsity > 0 && rngUniform(rng) < config->sparsity){
+                x = 0;
+            }
+
+            features[row * config->numFeatures + j] = (float)x;
+        }
+    }
+}
+
+/**
+ * @note writeCsvChunk() appends a chunk of rows to a csv file as f0,...,fn,label
+*/
+void writeCsvChunk(FILE* file, GenConfig* config, float* features, int32_t* labels, int numRows){
+
+    for (int row=0; row<numRows; row++){
+
+        for (int j=0; j<config->numFeatures; j++){
+
+            float x = features[row * config->numFeatures + j];
+
+            // sparse zeros are written without a fraction to keep sparse files small
+            if (x == 0){
+                fputs("0,", file);
+            }else{
+                fprintf(file, "%.6g,", x);
+            }
+        }
+        fprintf(file, "%d\n", labels[row]);
+    }
+}
+
+int main(int argc, char** argv){
+
+    GenConfig config = {0};
+    config.separability = 2.0;
+    config.seed = 42;
+
+    for (int i=1; i + 1 < argc; i += 2){
+
+        if (strcmp(argv[i], "--rows") == 0){
+            config.numRows = atoll(argv[i + 1]);
+        }else if (strcmp(argv[i], "--features") == 0){
+            config.numFeatures = atoi(argv[i + 1]);
+        }else if (strcmp(argv[i], "--classes") == 0){
+            config.numClasses = atoi(argv[i + 1]);
+        }else if (strcmp(argv[i], "--separability") == 0){
+            config.separability = atof(argv[i + 1]);
+        }else if (strcmp(argv[i], "--sparsity") == 0){
+            config.sparsity = atof(argv[i + 1]);
+        }else if (strcmp(argv[i], "--seed") == 0){
+            config.seed = strtoull(argv[i + 1], NULL, 10);
+        }else if (strcmp(argv[i], "--bin") == 0){
+            config.binPath = argv[i + 1];
+        }else if (strcmp(argv[i], "--csv") == 0){
+            config.csvPath = argv[i + 1];
+        }else if (strcmp(argv[i], "--quantize") == 0){
+            config.dtype = strcmp(argv[i + 1], "u8") == 0 ? DTYPE_UINT8 : (strcmp(argv[i + 1], "i16") == 0 ? DTYPE_INT16 : -1);
+        }
+    }
+
+    if (config.numRows <= 0 || config.numFeatures <= 0 || config.numClasses <= 0 || config.dtype < 0 ||
+        (config.binPath == NULL && config.csvPath == NULL)){
+
+        printf("usage: %s --rows N --features F --classes C [--separability S] [--sparsity P] [--seed X] "
+               "[--bin path] [--csv path] [--quantize u8|i16]\n", argv[0]);
+        return 1;
+    }
+
+    Rng rng;
+    seedRng(&rng, config.seed);
+
+    // class centers
+    double* centers = malloc(sizeof(double) * config.numClasses * config.numFeatures);
+    assert(centers != NULL);
+    for (int i=0; i<config.numClasses * config.numFeatures; i++){
+        centers[i] = config.separability * rngNormal(&rng);
+    }
+
+    // chunk buffers
+    float* features = malloc(sizeof(float) * GEN_CHUNK_ROWS * config.numFeatures);
+    int32_t* labels = malloc(sizeof(int32_t) * GEN_CHUNK_ROWS);
+    assert(features != NULL && labels != NULL);
+
+    // quantization parameters and error accumulators
+    float* scale = malloc(sizeof(float) * config.numFeatures);
+    float* offset = malloc(sizeof(float) * config.numFeatures);
+    void* codes = malloc(sizeof(int16_t) * config.numFeatures);
+    float* restored = malloc(sizeof(float) * config.numFeatures);
+    assert(scale != NULL && offset != NULL && codes != NULL && restored != NULL);
+    double maxError = 0, sumSquaredError = 0;
+
+    DatasetWriter* writer = NULL;
+    int quantized = config.binPath != NULL && config.dtype != DTYPE_FLOAT32;
+    if (quantized){
+
+        // first pass over the same rows for the column ranges, scale and offset hold the min and max until the end
+        Rng passRng = rng;
+        for (long long row=0; row<config.numRows; row += GEN_CHUNK_ROWS){
+
+            int chunkRows = config.numRows - row < GEN_CHUNK_ROWS ? (int)(config.numRows - row) : GEN_CHUNK_ROWS;
+            generateChunk(&config, &passRng, centers, features, labels, chunkRows);
+
+            for (int r=0; r<chunkRows; r++){
+                for (int j=0; j<config.numFeatures; j++){
+
+                    float x = features[(size_t)r * config.numFeatures + j];
+                    scale[j] = row + r == 0 || x < scale[j] ? x : scale[j];
+                    offset[j] = row + r == 0 || x > offset[j] ? x : offset[j];
+                }
+            }
+        }
+
+        for (int j=0; j<config.numFeatures; j++){
+            quantParamsFromRange(scale[j], offset[j], config.dtype, scale + j, offset + j);
+        }
+        writer = newQuantizedDatasetWriter(config.binPath, config.numRows, config.numFeatures, config.numClasses, config.dtype, scale, offset);
+
+    }else if (config.binPath != NULL){
+        writer = newDatasetWriter(config.binPath, config.numRows, config.numFeatures, config.numClasses);
+    }
+
+    FILE* csvFile = NULL;
+    if (config.csvPath != NULL){
+
+        csvFile = fopen(config.csvPath, "w");
+        assert(csvFile != NULL);
+
+        for (int j=0; j<config.numFeatures; j++){
+            fprintf(csvFile, "f%d,", j);
+        }
+        fprintf(csvFile, "label\n");
+    }
+
+    // generate and write chunk by chunk
+    for (long long row=0; row<config.numRows; row += GEN_CHUNK_ROWS){
+
+        int chunkRows = config.numRows - row < GEN_CHUNK_ROWS ? (int)(config.numRows - row) : GEN_CHUNK_ROWS;
+
+        generateChunk(&config, &rng, centers, features, labels, chunkRows);
+
+        if (quantized){
+
+            for (int r=0; r<chunkRows; r++){
+
+                const float* x = features + (size_t)r * config.numFeatures;
+                quantizeRow(x, config.numFeatures, config.dtype, scale, offset, codes);
+                dequantizeRow(codes, config.numFeatures, config.dtype, scale, offset, restored);
+
+                for (int j=0; j<config.numFeatures; j++){
+
+                    double error = fabs((double)restored[j] - x[j]);
+                    maxError = error > maxError ? error : maxError;
+                    sumSquaredError += error * error;
+                }
+            }
+        }
+
+        if (writer != NULL){
+            writeDatasetRows(writer, features, labels, chunkRows);
+        }
+        if (csvFile != NULL){
+            writeCsvChunk(csvFile, &config, features, labels, chunkRows);
+        }
+    }
+
+    if (quantized){
+        printf("quantized %s: %zu bytes per feature, max abs error %g, rms error %g\n", 
+            config.dtype == DTYPE_UINT8 ? "u8" : "i16", 
+            dtypeSize(config.dtype), 
+            maxError, 
+            sqrt(sumSquaredError / ((double)config.numRows * config.numFeatures))
+        );
+    }
+
+    // cleanup
+    if (writer != NULL){
+        closeDatasetWriter(&writer);
+    }
+    free(scale);
+    free(offset);
+    free(codes);
+    free(restored);
+    if (csvFile != NULL){
+        fclose(csvFile);
+    }
+    free(centers);
+    free(features);
+    free(labels);
+
+    return 0;
+}
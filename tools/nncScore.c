@@ -0,0 +1,437 @@
+#include "lib.h"
+
+// nncScore.c
+
+/**
+ * @note nnc_score scores feature rows with a saved model and writes one prediction per row, so scoring needs no code
+ * changes or recompiling. The model is a model file from saveMLP() or a training checkpoint.
+ * @dev usage: nnc_score --model path [--input path] [--format csv|f32] [--output class|probs] [--threads N]
+ * @dev rows are read from --input or stdin, as CSV lines of at least inputSize numbers (extra columns such as a label
+ * are ignored, a non numeric first line is taken as a header) or as raw native endian float32 rows. Predictions go to
+ * stdout as the argmax class or the comma separated softmax probabilities of each row, in input order.
+ * @dev scoring is a pipeline of a parse thread, the compute threads of an InferencePool and a writer thread, passing
+ * SCORE_SLOTS chunks of SCORE_CHUNK_ROWS rows around a ring. Memory use is fixed by the chunk size, not the input size.
+*/
+
+#define SCORE_SLOTS 4
+#define SCORE_CHUNK_ROWS 4096
+
+// input formats
+#define SCORE_CSV 0
+#define SCORE_F32 1
+
+// chunk states, a chunk goes around FREE -> PARSED -> SCORED -> FREE
+#define SCORE_FREE 0
+#define SCORE_PARSED 1
+#define SCORE_SCORED 2
+
+/**
+ * @note ScoreConfig holds the command line options of nnc_score
+*/
+typedef struct {
+    const char* modelPath;
+    const char* inputPath;
+    int format;
+    int writeProbs;
+    int numThreads;
+} ScoreConfig;
+
+/**
+ * @note ScoreChunk is one slot of the pipeline ring
+*/
+typedef struct {
+    float* features;
+    int32_t* labels;
+    double* probs;
+    int numRows;
+    int state;
+} ScoreChunk;
+
+/**
+ * @note ScorePipeline is the state shared by the pipeline stages
+ * @dev chunk seq is in slot seq % SCORE_SLOTS and every stage handles chunks in sequence order, so the writer emits
+ * rows in input order without reordering. A stage waits on cond for its next chunk to reach its input state.
+ * @param numChunks number of chunks parsed, final once parseDone is set
+ * @param error set by the parse thread on malformed input, scoring stops after the rows before it
+*/
+typedef struct {
+    ScoreConfig* config;
+    InferenceModel* model;
+    FILE* input;
+
+    ScoreChunk chunks[SCORE_SLOTS];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    int64_t numChunks;
+    int parseDone;
+    int error;
+
+    // csv line state, owned by the parse thread
+    char* line;
+    size_t lineCapacity;
+    long long lineNumber;
+} ScorePipeline;
+
+// ---------------------------------------------------------------------------------------------------------------------- Model
+
+/**
+ * @note openScoreModel() opens a model file for inference in place, or snapshots the mlp of a training checkpoint
+ * @return the InferenceModel, or NULL if the file is neither
+*/
+InferenceModel* openScoreModel(const char* path){
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL){
+        fprintf(stderr, "Error: could not open %s\n", path);
+        return NULL;
+    }
+
+    char magic[4] = {0};
+    size_t numRead = fread(magic, 1, 4, file);
+    fclose(file);
+
+    if (numRead == 4 && memcmp(magic, TRAIN_MAGIC, 4) == 0){
+
+        TrainState state;
+        MLP* mlp = loadTrainCheckpoint(path, &state);
+        if (mlp == NULL){
+            return NULL;
+        }
+
+        InferenceModel* model = newInferenceModel(mlp);
+        freeMLP(&mlp);
+        return model;
+    }
+
+    return openInferenceModel(path);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Parse Stage
+
+/**
+ * @note parseCsvLine() parses the first inputSize numbers of a csv line into a row
+ * @return 1 on success, 0 if the line has too few or non numeric fields
+*/
+int parseCsvLine(const char* line, const char* end, int inputSize, float* row){
+
+    const char* p = line;
+
+    for (int j=0; j<inputSize; j++){
+
+        const char* next;
+        row[j] = (float)parseDecimal(p, end, &next);
+        if (next == p){
+            return 0;
+        }
+
+        // blanks may surround a number on both sides
+        while (next < end && (*next == ' ' || *next == '\t')){
+            next++;
+        }
+        if (next < end && *next != ','){
+            return 0;
+        }
+        if (j + 1 < inputSize){
+
+            if (next >= end){
+                return 0;
+            }
+            next++;
+        }
+        p = next;
+    }
+
+    return 1;
+}
+
+/**
+ * @note readCsvChunk() reads up to SCORE_CHUNK_ROWS csv rows into a chunk, skipping blank lines and a header
+ * @return number of rows read, fewer than SCORE_CHUNK_ROWS at the end of the input or at a malformed line, which sets
+ * pipeline->error
+*/
+int readCsvChunk(ScorePipeline* pipeline, ScoreChunk* chunk){
+
+    int inputSize = pipeline->model->inputSize;
+    int numRows = 0;
+
+    while (numRows < SCORE_CHUNK_ROWS){
+
+        ssize_t len = getline(&pipeline->line, &pipeline->lineCapacity, pipeline->input);
+        if (len < 0){
+            break;
+        }
+        pipeline->lineNumber++;
+
+        const char* line = pipeline->line;
+        const char* end = line + len;
+        while (end > line && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ')){
+            end--;
+        }
+        if (end == line){
+            continue;
+        }
+
+        // a header starts with something that is not a number
+        if (pipeline->lineNumber == 1 && !(line[0] == '-' || line[0] == '+' || line[0] == '.' || (unsigned)(line[0] - '0') < 10)){
+            continue;
+        }
+
+        if (!parseCsvLine(line, end, inputSize, chunk->features + (size_t)numRows * inputSize)){
+            fprintf(stderr, "Error: line %lld does not hold %d numeric features\n", pipeline->lineNumber, inputSize);
+            pipeline->error = 1;
+            break;
+        }
+        numRows++;
+    }
+
+    return numRows;
+}
+
+/**
+ * @note readF32Chunk() reads up to SCORE_CHUNK_ROWS raw float32 rows into a chunk
+ * @return number of rows read, fewer than SCORE_CHUNK_ROWS at the end of the input. An input ending inside a row sets 
+ * pipeline->error.
+*/
+int readF32Chunk(ScorePipeline* pipeline, ScoreChunk* chunk){
+
+    int inputSize = pipeline->model->inputSize;
+    size_t numValues = fread(chunk->features, sizeof(float), (size_t)SCORE_CHUNK_ROWS * inputSize, pipeline->input);
+
+    if (numValues % inputSize != 0){
+        fprintf(stderr, "Error: input ends inside a row of %d float32 features\n", inputSize);
+        pipeline->error = 1;
+    }
+
+    return (int)(numValues / inputSize);
+}
+
+/**
+ * @note parseThread() is the pthread body of the parse stage, it fills free chunks in sequence until the input ends
+*/
+void* parseThread(void* arg){
+
+    ScorePipeline* pipeline = (ScorePipeline*)arg;
+
+    for (int64_t seq=0; ; seq++){
+
+        ScoreChunk* chunk = &pipeline->chunks[seq % SCORE_SLOTS];
+
+        pthread_mutex_lock(&pipeline->lock);
+        while (chunk->state != SCORE_FREE){
+            pthread_cond_wait(&pipeline->cond, &pipeline->lock);
+        }
+        pthread_mutex_unlock(&pipeline->lock);
+
+        int numRows = pipeline->config->format == SCORE_CSV ? readCsvChunk(pipeline, chunk) : readF32Chunk(pipeline, chunk);
+
+        // a short chunk is the last one, the rows before a malformed one are still scored
+        int last = numRows < SCORE_CHUNK_ROWS;
+
+        pthread_mutex_lock(&pipeline->lock);
+
+        if (numRows > 0){
+            chunk->numRows = numRows;
+            chunk->state = SCORE_PARSED;
+            pipeline->numChunks = seq + 1;
+        }
+        pipeline->parseDone = last;
+        pthread_cond_broadcast(&pipeline->cond);
+
+        pthread_mutex_unlock(&pipeline->lock);
+
+        if (last){
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Write Stage
+
+/**
+ * @note writeChunk() writes the predictions of a scored chunk to stdout
+*/
+void writeChunk(ScorePipeline* pipeline, ScoreChunk* chunk){
+
+    int outputSize = pipeline->model->outputSize;
+
+    for (int row=0; row<chunk->numRows; row++){
+
+        if (!pipeline->config->writeProbs){
+            printf("%d\n", chunk->labels[row]);
+            continue;
+        }
+
+        const double* probs = chunk->probs + (size_t)row * outputSize;
+        for (int i=0; i<outputSize; i++){
+            printf(i + 1 < outputSize ? "%.6g," : "%.6g\n", probs[i]);
+        }
+    }
+}
+
+/**
+ * @note writeThread() is the pthread body of the write stage, it writes scored chunks in sequence and frees them
+*/
+void* writeThread(void* arg){
+
+    ScorePipeline* pipeline = (ScorePipeline*)arg;
+
+    for (int64_t seq=0; ; seq++){
+
+        ScoreChunk* chunk = &pipeline->chunks[seq % SCORE_SLOTS];
+
+        pthread_mutex_lock(&pipeline->lock);
+        while (chunk->state != SCORE_SCORED && !(pipeline->parseDone && seq >= pipeline->numChunks)){
+            pthread_cond_wait(&pipeline->cond, &pipeline->lock);
+        }
+        int finished = chunk->state != SCORE_SCORED;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        if (finished){
+            break;
+        }
+
+        writeChunk(pipeline, chunk);
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->state = SCORE_FREE;
+        pthread_cond_broadcast(&pipeline->cond);
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+
+    fflush(stdout);
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------- Main
+
+/**
+ * @note runScorePipeline() starts the parse and write stages and scores chunks on the calling thread with the pool
+ * until the input is exhausted
+ * @return number of rows scored
+*/
+long long runScorePipeline(ScorePipeline* pipeline, InferencePool* pool){
+
+    pthread_t parser, writer;
+    int status = pthread_create(&parser, NULL, parseThread, pipeline);
+    assert(status == 0);
+    status = pthread_create(&writer, NULL, writeThread, pipeline);
+    assert(status == 0);
+
+    long long numRows = 0;
+
+    for (int64_t seq=0; ; seq++){
+
+        ScoreChunk* chunk = &pipeline->chunks[seq % SCORE_SLOTS];
+
+        pthread_mutex_lock(&pipeline->lock);
+        while (chunk->state != SCORE_PARSED && !(pipeline->parseDone && seq >= pipeline->numChunks)){
+            pthread_cond_wait(&pipeline->cond, &pipeline->lock);
+        }
+        int finished = chunk->state != SCORE_PARSED;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        if (finished){
+            break;
+        }
+
+        predictBatch(pool, pipeline->model, chunk->features, chunk->numRows, chunk->labels,
+            pipeline->config->writeProbs ? chunk->probs : NULL);
+        numRows += chunk->numRows;
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->state = SCORE_SCORED;
+        pthread_cond_broadcast(&pipeline->cond);
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+
+    pthread_join(parser, NULL);
+    pthread_join(writer, NULL);
+
+    return numRows;
+}
+
+int main(int argc, char** argv){
+
+    ScoreConfig config = {0};
+    config.format = SCORE_CSV;
+
+    int valid = 1;
+    for (int i=1; i + 1 < argc; i += 2){
+
+        if (strcmp(argv[i], "--model") == 0){
+            config.modelPath = argv[i + 1];
+        }else if (strcmp(argv[i], "--input") == 0){
+            config.inputPath = argv[i + 1];
+        }else if (strcmp(argv[i], "--format") == 0){
+            config.format = strcmp(argv[i + 1], "f32") == 0 ? SCORE_F32 : SCORE_CSV;
+            valid &= strcmp(argv[i + 1], "f32") == 0 || strcmp(argv[i + 1], "csv") == 0;
+        }else if (strcmp(argv[i], "--output") == 0){
+            config.writeProbs = strcmp(argv[i + 1], "probs") == 0;
+            valid &= strcmp(argv[i + 1], "probs") == 0 || strcmp(argv[i + 1], "class") == 0;
+        }else if (strcmp(argv[i], "--threads") == 0){
+            config.numThreads = atoi(argv[i + 1]);
+        }else{
+            valid = 0;
+        }
+    }
+
+    if (!valid || argc % 2 == 0 || config.modelPath == NULL || config.numThreads < 0){
+
+        fprintf(stderr, "usage: %s --model path [--input path] [--format csv|f32] [--output class|probs] [--threads N]\n", argv[0]);
+        return 1;
+    }
+
+    InferenceModel* model = openScoreModel(config.modelPath);
+    if (model == NULL){
+        return 1;
+    }
+
+    FILE* input = config.inputPath != NULL ? fopen(config.inputPath, config.format == SCORE_F32 ? "rb" : "r") : stdin;
+    if (input == NULL){
+        fprintf(stderr, "Error: could not open %s\n", config.inputPath);
+        freeInferenceModel(&model);
+        return 1;
+    }
+
+    ScorePipeline pipeline;
+    memset(&pipeline, 0, sizeof(ScorePipeline));
+    pipeline.config = &config;
+    pipeline.model = model;
+    pipeline.input = input;
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.cond, NULL);
+
+    for (int i=0; i<SCORE_SLOTS; i++){
+
+        ScoreChunk* chunk = &pipeline.chunks[i];
+        chunk->features = (float*)malloc(sizeof(float) * SCORE_CHUNK_ROWS * model->inputSize);
+        chunk->labels = (int32_t*)malloc(sizeof(int32_t) * SCORE_CHUNK_ROWS);
+        chunk->probs = (double*)malloc(sizeof(double) * SCORE_CHUNK_ROWS * model->outputSize);
+        assert(chunk->features != NULL && chunk->labels != NULL && chunk->probs != NULL);
+    }
+
+    InferencePool* pool = newInferencePool(config.numThreads);
+    long long numRows = runScorePipeline(&pipeline, pool);
+
+    fprintf(stderr, "scored %lld rows\n", numRows);
+
+    // cleanup
+    freeInferencePool(&pool);
+    for (int i=0; i<SCORE_SLOTS; i++){
+        free(pipeline.chunks[i].features);
+        free(pipeline.chunks[i].labels);
+        free(pipeline.chunks[i].probs);
+    }
+    free(pipeline.line);
+    pthread_mutex_destroy(&pipeline.lock);
+    pthread_cond_destroy(&pipeline.cond);
+    if (input != stdin){
+        fclose(input);
+    }
+    freeInferenceModel(&model);
+
+    return pipeline.error ? 1 : 0;
+}